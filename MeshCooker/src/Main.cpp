@@ -0,0 +1,318 @@
+#include "Utils/MappedFile.h"
+#include "Utils/MeshFile.h"
+#include "Utils/MeshOptimizer.h"
+#include "Utils/MeshSimplifier.h"
+#include "Utils/VertexLayout.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+	struct CookedMesh {
+	public:
+		std::vector<Utils::VertexAttributes> m_Vertices;
+		std::vector<std::uint32_t> m_Indices;
+		std::vector<Utils::MeshFileSubmesh> m_Submeshes; // 'm_LODCount' levels of detail of the same submeshes, full detail first
+		std::uint32_t m_LODCount  = 1;
+		float m_BoundingBox[2][3] = {};
+		float m_BoundingSphere[4] = {};
+	};
+
+	// Position and texture coordinate indices of a face corner, -1 where the corner has none
+	using CornerKey = std::array<std::int64_t, 2>;
+
+	struct CornerKeyHash {
+	public:
+		std::size_t operator()(const CornerKey& key) const {
+			std::uint64_t hash = 14695981039346656037ULL;
+			for (auto index : key) {
+				hash ^= static_cast<std::uint64_t>(index);
+				hash *= 1099511628211ULL;
+			}
+			return static_cast<std::size_t>(hash);
+		}
+	};
+
+	std::string_view NextToken(std::string_view& line) {
+		std::size_t start = line.find_first_not_of(" \t");
+		if (start == std::string_view::npos) {
+			line = {};
+			return {};
+		}
+		std::size_t end        = line.find_first_of(" \t", start);
+		std::string_view token = line.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+		line                   = end == std::string_view::npos ? std::string_view {} : line.substr(end);
+		return token;
+	}
+
+	float ParseFloat(std::string_view token) {
+		std::string text(token);
+		return std::strtof(text.c_str(), nullptr);
+	}
+
+	// OBJ indices are 1 based, negative ones count back from the newest element. Returns -1 if the index is missing or out of range
+	std::int64_t ResolveIndex(std::string_view token, std::size_t count) {
+		if (token.empty())
+			return -1;
+
+		std::string text(token);
+		std::int64_t index = std::strtoll(text.c_str(), nullptr, 10);
+		if (index < 0)
+			index += static_cast<std::int64_t>(count);
+		else
+			index -= 1;
+		return index >= 0 && index < static_cast<std::int64_t>(count) ? index : -1;
+	}
+
+	// Overdraw reordering may raise the ACMR of a cluster by this factor when that lets it split the cluster in two
+	constexpr float OverdrawThreshold = 1.05f;
+
+	void PrintStatistics(std::string_view pass, const CookedMesh& mesh) {
+		auto statistics = Utils::MeshOptimizer::AnalyzeVertexCache(mesh.m_Indices.data(), mesh.m_Indices.size(), static_cast<std::uint32_t>(mesh.m_Vertices.size()));
+		std::cout << pass << ": ACMR " << statistics.m_ACMR << ", ATVR " << statistics.m_ATVR << " with a " << Utils::MeshOptimizer::s_FIFOCacheSize << " entry FIFO cache\n";
+	}
+
+	// Reorders the triangles of every submesh for the vertex cache and then overdraw, submeshes keep their index ranges. The vertices are then renumbered,
+	// and unreferenced ones dropped, in the order the indices first use them
+	void OptimizeMesh(CookedMesh& mesh) {
+		auto vertexCount = static_cast<std::uint32_t>(mesh.m_Vertices.size());
+		for (auto& submesh : mesh.m_Submeshes) {
+			std::uint32_t* indices = mesh.m_Indices.data() + submesh.m_FirstIndex;
+			Utils::MeshOptimizer::OptimizeVertexCache(indices, submesh.m_IndexCount, vertexCount);
+			Utils::MeshOptimizer::OptimizeOverdraw(indices, submesh.m_IndexCount, mesh.m_Vertices[0].m_Position, sizeof(Utils::VertexAttributes), vertexCount, OverdrawThreshold);
+		}
+
+		std::vector<std::uint32_t> remap;
+		std::uint32_t referencedCount = Utils::MeshOptimizer::OptimizeVertexFetch(mesh.m_Indices.data(), mesh.m_Indices.size(), vertexCount, remap);
+
+		std::vector<Utils::VertexAttributes> vertices(referencedCount);
+		for (std::uint32_t i = 0; i < vertexCount; ++i)
+			if (remap[i] != ~0U)
+				vertices[remap[i]] = mesh.m_Vertices[i];
+		mesh.m_Vertices = std::move(vertices);
+	}
+
+	// Every level of detail aims for this fraction of the triangles of the one before, until a level is no longer worth its indices
+	constexpr std::uint32_t MaxLODCount           = 8;
+	constexpr float LODReduction                  = 0.5f;
+	constexpr float LODMinimumReduction           = 0.8f;
+	constexpr std::size_t LODMinimumTriangleCount = 16;
+
+	// Simplifies every submesh from full detail again for every level, so the error of a level is measured against the original surface.
+	// The levels are appended to the indices and the submesh table, and optimized for the vertex cache like the full detail level
+	void GenerateLODs(CookedMesh& mesh) {
+		auto vertexCount          = static_cast<std::uint32_t>(mesh.m_Vertices.size());
+		std::size_t submeshCount  = mesh.m_Submeshes.size();
+		std::size_t previousCount = mesh.m_Indices.size();
+		float ratio               = 1.0f;
+		while (mesh.m_LODCount < MaxLODCount && previousCount / 3 > LODMinimumTriangleCount) {
+			ratio *= LODReduction;
+
+			std::vector<std::uint32_t> levelIndices;
+			std::vector<Utils::MeshFileSubmesh> levelSubmeshes;
+			for (std::size_t i = 0; i < submeshCount; ++i) {
+				auto& submesh           = mesh.m_Submeshes[i];
+				std::size_t targetCount = static_cast<std::size_t>(static_cast<float>(submesh.m_IndexCount / 3) * ratio) * 3;
+
+				std::vector<std::uint32_t> simplified(submesh.m_IndexCount);
+				float error;
+				std::size_t count = Utils::MeshSimplifier::Simplify(simplified.data(), mesh.m_Indices.data() + submesh.m_FirstIndex, submesh.m_IndexCount, mesh.m_Vertices[0].m_Position, sizeof(Utils::VertexAttributes), vertexCount, targetCount, error);
+				Utils::MeshOptimizer::OptimizeVertexCache(simplified.data(), count, vertexCount);
+
+				levelSubmeshes.push_back({ static_cast<std::uint32_t>(mesh.m_Indices.size() + levelIndices.size()), static_cast<std::uint32_t>(count), error });
+				levelIndices.insert(levelIndices.end(), simplified.begin(), simplified.begin() + static_cast<std::ptrdiff_t>(count));
+			}
+
+			if (static_cast<float>(levelIndices.size()) > static_cast<float>(previousCount) * LODMinimumReduction)
+				break;
+
+			mesh.m_Indices.insert(mesh.m_Indices.end(), levelIndices.begin(), levelIndices.end());
+			mesh.m_Submeshes.insert(mesh.m_Submeshes.end(), levelSubmeshes.begin(), levelSubmeshes.end());
+			previousCount = levelIndices.size();
+			++mesh.m_LODCount;
+		}
+	}
+
+	// Reads positions, texture coordinates and faces, polygons become triangle fans. Every object, group or material starts a new submesh
+	bool CookOBJ(const Utils::MappedFile& file, CookedMesh& mesh) {
+		std::vector<std::array<float, 3>> positions;
+		std::vector<std::array<float, 2>> uvs;
+		std::unordered_map<CornerKey, std::uint32_t, CornerKeyHash> vertexLookup;
+
+		auto beginSubmesh = [&mesh]() {
+			if (mesh.m_Submeshes.empty() || mesh.m_Submeshes.back().m_IndexCount > 0)
+				mesh.m_Submeshes.push_back({ static_cast<std::uint32_t>(mesh.m_Indices.size()), 0 });
+		};
+		beginSubmesh();
+
+		std::string_view text  = { reinterpret_cast<const char*>(file.getData()), file.getSize() };
+		std::size_t lineNumber = 0;
+		while (!text.empty()) {
+			std::size_t end       = text.find('\n');
+			std::string_view line = text.substr(0, end);
+			text                  = end == std::string_view::npos ? std::string_view {} : text.substr(end + 1);
+			++lineNumber;
+
+			if (!line.empty() && line.back() == '\r')
+				line.remove_suffix(1);
+
+			std::string_view keyword = NextToken(line);
+			if (keyword == "v") {
+				auto& position = positions.emplace_back();
+				for (auto& component : position)
+					component = ParseFloat(NextToken(line));
+			} else if (keyword == "vt") {
+				auto& uv = uvs.emplace_back();
+				uv[0]    = ParseFloat(NextToken(line));
+				uv[1]    = 1.0f - ParseFloat(NextToken(line)); // OBJ puts the texture origin at the bottom, Vulkan at the top
+			} else if (keyword == "o" || keyword == "g" || keyword == "usemtl") {
+				beginSubmesh();
+			} else if (keyword == "f") {
+				std::vector<std::uint32_t> polygon;
+				for (std::string_view corner = NextToken(line); !corner.empty(); corner = NextToken(line)) {
+					std::size_t slash     = corner.find('/');
+					std::int64_t position = ResolveIndex(corner.substr(0, slash), positions.size());
+					std::int64_t uv       = -1;
+					if (slash != std::string_view::npos) {
+						std::string_view rest = corner.substr(slash + 1);
+						uv                    = ResolveIndex(rest.substr(0, rest.find('/')), uvs.size());
+					}
+					if (position < 0) {
+						std::cerr << "Invalid face on line " << lineNumber << "\n";
+						return false;
+					}
+
+					auto [itr, inserted] = vertexLookup.try_emplace({ position, uv }, static_cast<std::uint32_t>(mesh.m_Vertices.size()));
+					if (inserted) {
+						auto& vertex = mesh.m_Vertices.emplace_back();
+						std::copy_n(positions[static_cast<std::size_t>(position)].data(), 3, vertex.m_Position);
+						if (uv >= 0)
+							std::copy_n(uvs[static_cast<std::size_t>(uv)].data(), 2, vertex.m_UV);
+					}
+					polygon.push_back(itr->second);
+				}
+
+				for (std::size_t i = 2; i < polygon.size(); ++i) {
+					mesh.m_Indices.push_back(polygon[0]);
+					mesh.m_Indices.push_back(polygon[i - 1]);
+					mesh.m_Indices.push_back(polygon[i]);
+					mesh.m_Submeshes.back().m_IndexCount += 3;
+				}
+			}
+		}
+
+		if (mesh.m_Submeshes.back().m_IndexCount == 0)
+			mesh.m_Submeshes.pop_back();
+		if (mesh.m_Indices.empty()) {
+			std::cerr << "The mesh has no faces\n";
+			return false;
+		}
+
+		// The bounding sphere is centered on the bounding box, close enough for culling and far cheaper than a minimal sphere.
+		// The box is also what quantized positions are stored relative to
+		float(&min)[3] = mesh.m_BoundingBox[0];
+		float(&max)[3] = mesh.m_BoundingBox[1];
+		std::fill_n(min, 3, INFINITY);
+		std::fill_n(max, 3, -INFINITY);
+		for (auto& vertex : mesh.m_Vertices) {
+			for (std::size_t i = 0; i < 3; ++i) {
+				min[i] = std::min(min[i], vertex.m_Position[i]);
+				max[i] = std::max(max[i], vertex.m_Position[i]);
+			}
+		}
+
+		float radius = 0.0f;
+		for (std::size_t i = 0; i < 3; ++i)
+			mesh.m_BoundingSphere[i] = (min[i] + max[i]) * 0.5f;
+		for (auto& vertex : mesh.m_Vertices) {
+			float dx = vertex.m_Position[0] - mesh.m_BoundingSphere[0];
+			float dy = vertex.m_Position[1] - mesh.m_BoundingSphere[1];
+			float dz = vertex.m_Position[2] - mesh.m_BoundingSphere[2];
+			radius   = std::max(radius, std::sqrt(dx * dx + dy * dy + dz * dz));
+		}
+		mesh.m_BoundingSphere[3] = radius;
+		return true;
+	}
+} // namespace
+
+int main(int argc, char** argv) {
+	bool quantize = false;
+	bool optimize = true;
+	bool lods     = true;
+	std::vector<std::string_view> paths;
+	for (int i = 1; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		if (arg == "--quantize")
+			quantize = true;
+		else if (arg == "--no-optimize")
+			optimize = false;
+		else if (arg == "--no-lods")
+			lods = false;
+		else
+			paths.push_back(arg);
+	}
+
+	if (paths.size() != 2) {
+		std::cerr << "Usage: MeshCooker [--quantize] [--no-optimize] [--no-lods] <input.obj> <output.mesh>\n";
+		return EXIT_FAILURE;
+	}
+
+	std::string inputPath  = std::string(paths[0]);
+	std::string outputPath = std::string(paths[1]);
+
+	Utils::MappedFile input = { inputPath };
+	if (!input.isOpen()) {
+		std::cerr << "Failed to open '" << inputPath << "'\n";
+		return EXIT_FAILURE;
+	}
+
+	CookedMesh mesh;
+	if (!CookOBJ(input, mesh))
+		return EXIT_FAILURE;
+
+	if (optimize) {
+		PrintStatistics("Source order", mesh);
+		OptimizeMesh(mesh);
+		PrintStatistics("Optimized", mesh);
+	}
+
+	if (lods) {
+		GenerateLODs(mesh);
+		for (std::uint32_t lod = 0; lod < mesh.m_LODCount; ++lod) {
+			std::size_t indexCount = 0;
+			float error            = 0.0f;
+			for (std::size_t i = 0; i < mesh.m_Submeshes.size() / mesh.m_LODCount; ++i) {
+				auto& submesh = mesh.m_Submeshes[lod * (mesh.m_Submeshes.size() / mesh.m_LODCount) + i];
+				indexCount += submesh.m_IndexCount;
+				error = std::max(error, submesh.m_Error);
+			}
+			std::cout << "LOD " << lod << ": " << indexCount / 3 << " triangles, error " << error << "\n";
+		}
+	}
+
+	// Quantized positions are stored relative to the bounding box, which the loader folds back into the model matrix
+	Utils::VertexLayout layout             = quantize ? Utils::VertexLayout::Quantized() : Utils::VertexLayout::Standard();
+	Utils::VertexQuantization quantization = quantize ? Utils::VertexQuantization::FromBounds(mesh.m_BoundingBox[0], mesh.m_BoundingBox[1]) : Utils::VertexQuantization {};
+
+	std::vector<std::uint8_t> vertices(static_cast<std::size_t>(layout.getStride()) * mesh.m_Vertices.size());
+	for (std::size_t i = 0; i < mesh.m_Vertices.size(); ++i)
+		layout.encode(mesh.m_Vertices[i], quantization, vertices.data() + i * layout.getStride());
+
+	if (!Utils::MeshFile::Write(outputPath, layout, quantization, vertices.data(), static_cast<std::uint32_t>(mesh.m_Vertices.size()), mesh.m_Indices, mesh.m_Submeshes, mesh.m_LODCount, mesh.m_BoundingSphere)) {
+		std::cerr << "Failed to write '" << outputPath << "'\n";
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "Cooked " << mesh.m_Vertices.size() << " vertices of " << layout.getStride() << " bytes, " << mesh.m_Indices.size() / 3 << " triangles in " << mesh.m_Submeshes.size() / mesh.m_LODCount << " submeshes and " << mesh.m_LODCount << " levels of detail into '" << outputPath << "'\n";
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vulkan.hpp>
+
+#include <cstdint>
+
+#include <vector>
+
+namespace Graphics {
+	// Submits compute work to the dedicated compute queue when the device has one, so it overlaps with graphics work instead of serializing with it.
+	// Every submission signals a semaphore the graphics submission of the same frame waits on, and the graphics submission signals one that the compute
+	// submission 's_GraphicsLatency' submissions later waits on. Compute work writing what graphics reads therefore has to alternate between that many copies.
+	// Without a dedicated compute family the work is recorded into the graphics command buffer and no semaphores are involved.
+	// Not thread safe, all calls must come from the same thread.
+	struct AsyncCompute {
+	public:
+		static constexpr std::uint32_t s_GraphicsLatency = 2;
+
+	public:
+		AsyncCompute(vk::Device device, vk::Queue computeQueue, std::uint32_t computeFamilyIndex, std::uint32_t graphicsFamilyIndex, std::uint32_t framesInFlight);
+		~AsyncCompute();
+
+		void create();
+		void destroy();
+
+		// Returns the command buffer the compute work of 'frame' is recorded into, 'graphicsCommandBuffer' without a dedicated compute queue.
+		// The command buffer of a frame slot is reused once the graphics submission of that slot has finished, which waited for it
+		vk::CommandBuffer begin(std::uint32_t frame, vk::CommandBuffer graphicsCommandBuffer);
+		// Submits the work recorded since 'begin'. Appends the semaphore the graphics submission has to wait on before 'graphicsStage', and the one it has to signal
+		void submit(vk::PipelineStageFlags graphicsStage, std::vector<vk::Semaphore>& graphicsWaitSemaphores, std::vector<vk::PipelineStageFlags>& graphicsWaitStages, std::vector<vk::Semaphore>& graphicsSignalSemaphores);
+
+		bool isAsync() const { return m_ComputeFamilyIndex != m_GraphicsFamilyIndex; }
+		// Families resources used by both queues are shared between, with 'vk::SharingMode::eConcurrent' when there are two so they need no ownership transfers
+		auto& getQueueFamilies() const { return m_QueueFamilies; }
+		auto getSubmitCount() const { return m_SubmitCount; }
+		bool isCreated() const { return m_Created; }
+
+	private:
+		struct Frame {
+		public:
+			vk::CommandPool m_CommandPool     = nullptr;
+			vk::CommandBuffer m_CommandBuffer = nullptr;
+			vk::Semaphore m_ComputeFinished   = nullptr;
+		};
+
+	private:
+		vk::Device m_Device;
+		vk::Queue m_ComputeQueue;
+		std::uint32_t m_ComputeFamilyIndex;
+		std::uint32_t m_GraphicsFamilyIndex;
+		std::uint32_t m_FramesInFlight;
+		std::vector<std::uint32_t> m_QueueFamilies;
+		bool m_Created = false;
+
+		std::vector<Frame> m_Frames;
+		std::vector<vk::Semaphore> m_GraphicsFinished; // Indexed by submission modulo 's_GraphicsLatency'
+		std::uint32_t m_CurrentFrame = 0;
+		std::uint64_t m_SubmitCount  = 0;
+	};
+} // namespace Graphics
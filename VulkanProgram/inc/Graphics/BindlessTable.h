@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vulkan.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Graphics {
+	// One descriptor set with a large array of sampled images at binding 0 and an array of samplers at binding 1, shaders pick both by index.
+	// Both bindings are update-after-bind and partially bound, so images can be added while frames that bind the set are still in flight.
+	// Requires 'DeviceCapabilities::m_DescriptorIndexing', which 'DeviceFeatureChain' enables.
+	struct BindlessTable {
+	public:
+		static constexpr std::uint32_t s_InvalidIndex = ~0U;
+
+		// Descriptors of the other sets a pipeline layout may combine with the table, kept free when clamping the capacity to the device limits
+		static constexpr std::uint32_t s_ReservedDescriptors = 16;
+
+	public:
+		BindlessTable(vk::Device device, vk::PhysicalDevice physicalDevice, std::uint32_t imageCapacity, std::uint32_t samplerCapacity, vk::ShaderStageFlags stages);
+		~BindlessTable();
+
+		void create();
+		void destroy();
+
+		// Writes 'imageView' into a free slot and returns its index, throws if the table is full
+		std::uint32_t addImage(vk::ImageView imageView, vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+		// Frees the slot of 'index', no frame in flight may still sample it
+		void removeImage(std::uint32_t index);
+		// Writes 'sampler' into the next sampler slot and returns its index, throws if the table is full
+		std::uint32_t addSampler(vk::Sampler sampler);
+
+		auto getLayout() const { return m_Layout; }
+		auto getDescriptorSet() const { return m_DescriptorSet; }
+		auto getImageCapacity() const { return m_ImageCapacity; }
+		std::uint32_t getImageCount() const { return m_ImageCount - static_cast<std::uint32_t>(m_FreeImages.size()); }
+		auto getSamplerCount() const { return m_SamplerCount; }
+		bool isCreated() const { return m_Layout; }
+
+	private:
+		vk::Device m_Device;
+		vk::PhysicalDevice m_PhysicalDevice;
+		std::uint32_t m_ImageCapacity;
+		std::uint32_t m_SamplerCapacity;
+		vk::ShaderStageFlags m_Stages;
+
+		vk::DescriptorSetLayout m_Layout = nullptr;
+		vk::DescriptorPool m_Pool        = nullptr;
+		vk::DescriptorSet m_DescriptorSet;
+
+		std::uint32_t m_ImageCount   = 0; // Slots handed out, including freed ones
+		std::uint32_t m_SamplerCount = 0;
+		std::vector<std::uint32_t> m_FreeImages;
+	};
+} // namespace Graphics
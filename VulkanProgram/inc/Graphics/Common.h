@@ -2,6 +2,8 @@
 
 #include <vulkan.hpp>
 
+#include <cstdint>
+
 #include <vector>
 
 namespace Graphics {
@@ -31,23 +33,74 @@ namespace Graphics {
 		};
 	};
 
+	struct HandleBase;
+
+	// Edge from a child to one of its parents. Owned by the child and threaded into an intrusive list of the parent's children, so linking and unlinking is O(1)
+	struct HandleLink {
+	public:
+		HandleBase* m_Parent    = nullptr;
+		HandleBase* m_Child     = nullptr;
+		HandleLink* m_PrevChild = nullptr;
+		HandleLink* m_NextChild = nullptr;
+	};
+
+	// Node in the graph of handles, a handle must be destroyed before its parents and created after them.
+	// Creating and destroying whole subtrees walks the graph once into a topological order instead of recursing per handle. Not thread safe.
 	struct HandleBase {
 	public:
 		HandleBase(const std::vector<HandleBase*>& parents = {});
+		HandleBase(const HandleBase&) = delete;
 		virtual ~HandleBase();
 
-		virtual bool create()  = 0;
-		virtual void destroy() = 0;
+		HandleBase& operator=(const HandleBase&) = delete;
+
+		// Creates the handle, if it already exists it is recreated along with every descendant that had to be destroyed for it
+		virtual bool create();
+		// Creates the handle and every descendant that doesn't exist yet, parents before children
+		bool createTree();
+		// Destroys every created descendant and then the handle itself, children before parents
+		virtual void destroy();
 
 		virtual bool isCreated() const     = 0;
 		virtual bool isDestroyable() const = 0;
 
-		auto& getParents() const { return m_Parents; }
-		auto& getChildren() const { return m_Children; }
+		// Adds 'parent' as a parent of this handle, O(1) in the number of children of 'parent'
+		void attach(HandleBase& parent);
+		// Removes 'parent' as a parent of this handle, O(1) in the number of children of 'parent'
+		void detach(HandleBase& parent);
+
+		auto getParentCount() const { return m_ParentLinks.size(); }
+		auto getParent(std::size_t index) const { return m_ParentLinks[index].m_Parent; }
+		auto getChildCount() const { return m_ChildCount; }
+		// Calls 'function' with every child, 'function' may detach the child it is given
+		template <class Function>
+		void forEachChild(Function&& function) const {
+			for (HandleLink* link = m_FirstChild; link;) {
+				HandleLink* next = link->m_NextChild;
+				function(link->m_Child);
+				link = next;
+			}
+		}
 
-	protected:
-		std::vector<HandleBase*> m_Parents;
-		std::vector<HandleBase*> m_Children;
+	private:
+		virtual void createSelf()  = 0;
+		virtual void destroySelf() = 0;
+
+		// Appends this handle and its descendants so every handle comes after all of its children, handles reachable through several parents appear once
+		void collectSubtree(std::vector<HandleBase*>& order, bool createdOnly);
+		bool areParentsCreated() const;
+
+		// Points the neighbours of 'link' to its current address, after it was moved
+		static void Relink(HandleLink& link);
+		static void Unlink(HandleLink& link);
+
+	private:
+		static std::uint64_t s_VisitMark;
+
+		std::vector<HandleLink> m_ParentLinks;
+		HandleLink* m_FirstChild  = nullptr;
+		std::size_t m_ChildCount  = 0;
+		std::uint64_t m_VisitMark = 0; // Last traversal that reached this handle, replaces a visited set
 	};
 
 	template <class HandleType, bool Destroyable = true>
@@ -56,9 +109,6 @@ namespace Graphics {
 		using HandleT = HandleType;
 
 	public:
-		virtual bool create() override;
-		virtual void destroy() override;
-
 		virtual bool isCreated() const override { return m_Handle; }
 		virtual bool isDestroyable() const override { return Destroyable; }
 		HandleT& getHandle() const { return m_Handle; }
@@ -67,54 +117,12 @@ namespace Graphics {
 		virtual void createImpl()  = 0;
 		virtual bool destroyImpl() = 0;
 
+		virtual void createSelf() override { createImpl(); }
+		virtual void destroySelf() override {
+			if (Destroyable && m_Handle && destroyImpl()) m_Handle = nullptr;
+		}
+
 	protected:
 		HandleT m_Handle = nullptr;
-
-	private:
-		std::vector<HandleBase*> m_DestroyedChildren;
-		bool m_Recreate = false;
 	};
-
-	/* Implementation */
-
-	template <class HandleType, bool Destroyable>
-	bool Handle<HandleType, Destroyable>::create() {
-		bool pCreated = m_Handle;
-		if (pCreated) {
-			m_Recreate = true;
-			destroy();
-		}
-
-		createImpl();
-		if (pCreated && m_Handle) {
-			for (auto& child : m_DestroyedChildren) child->create();
-			m_DestroyedChildren.clear();
-		}
-		m_Recreate = false;
-		return m_Handle;
-	}
-
-	template <class HandleType, bool Destroyable>
-	void Handle<HandleType, Destroyable>::destroy() {
-		if (m_Recreate)
-			m_DestroyedChildren.clear();
-
-		auto itr = m_Children.begin();
-		while (itr != m_Children.end()) {
-			auto m_Child = *itr;
-
-			if (m_Child->isCreated()) {
-				m_Child->destroy();
-
-				if (m_Recreate && m_Child->isDestroyable())
-					m_DestroyedChildren.push_back(m_Child);
-
-				continue;
-			}
-
-			++itr;
-		}
-
-		if (Destroyable && m_Handle && destroyImpl()) m_Handle = nullptr;
-	}
 } // namespace Graphics
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Graphics/ShaderLibrary.h"
+
+#include <vulkan.hpp>
+
+#include <cstdint>
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace Graphics {
+	// Everything that identifies a compute pipeline. The workgroup size is handed to the shader as specialization constants 0, 1 and 2,
+	// so shaders declare it with 'layout(local_size_x_id = 0, local_size_y_id = 1, local_size_z_id = 2) in;' and one shader serves every size
+	struct ComputePipelineDesc {
+	public:
+		std::string m_Shader;
+		std::array<std::uint32_t, 3> m_LocalSize = { 64, 1, 1 };
+
+		std::vector<vk::DescriptorSetLayout> m_SetLayouts;
+		std::uint32_t m_PushConstantSize = 0; // Bytes of push constants at offset 0, 0 for none
+	};
+
+	// A compute pipeline with a layout of its own, compiled synchronously on 'create' since compute pipelines are small and few.
+	// The dispatch calls take thread counts or workgroup counts, or read the workgroup counts from a buffer the GPU wrote
+	struct ComputePipeline {
+	public:
+		ComputePipeline(vk::Device device, vk::PipelineCache pipelineCache, ShaderLibrary& shaderLibrary);
+		~ComputePipeline();
+
+		void create(const ComputePipelineDesc& desc);
+		void destroy();
+
+		// Binds the pipeline and 'descriptorSets' starting at set 0
+		void bind(vk::CommandBuffer commandBuffer, const std::vector<vk::DescriptorSet>& descriptorSets, const std::vector<std::uint32_t>& dynamicOffsets = {}) const;
+		void pushConstants(vk::CommandBuffer commandBuffer, const void* data, std::uint32_t size) const;
+		template <class T>
+		void pushConstants(vk::CommandBuffer commandBuffer, const T& constants) const {
+			pushConstants(commandBuffer, &constants, sizeof(T));
+		}
+
+		void dispatch(vk::CommandBuffer commandBuffer, std::uint32_t groupCountX, std::uint32_t groupCountY = 1, std::uint32_t groupCountZ = 1) const;
+		// Dispatches enough workgroups to cover every thread, shaders have to skip the threads past the end themselves
+		void dispatchThreads(vk::CommandBuffer commandBuffer, std::uint32_t threadCountX, std::uint32_t threadCountY = 1, std::uint32_t threadCountZ = 1) const;
+		// Reads a 'vk::DispatchIndirectCommand' from 'buffer' at 'offset', which needs 'vk::BufferUsageFlagBits::eIndirectBuffer'
+		void dispatchIndirect(vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::DeviceSize offset) const;
+
+		auto getHandle() const { return m_Pipeline; }
+		auto getLayout() const { return m_Layout; }
+		auto& getDesc() const { return m_Desc; }
+		bool isCreated() const { return m_Pipeline; }
+
+	private:
+		vk::Device m_Device;
+		vk::PipelineCache m_PipelineCache;
+		ShaderLibrary& m_ShaderLibrary;
+
+		ComputePipelineDesc m_Desc;
+		vk::PipelineLayout m_Layout = nullptr;
+		vk::Pipeline m_Pipeline     = nullptr;
+	};
+} // namespace Graphics
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Graphics/FramePacer.h"
+
+#include <vulkan.hpp>
+
+#include <vk_mem_alloc.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace Graphics {
+	// Destroys GPU resources once the GPU has finished every frame that could still use them, so releasing something never idles the device.
+	// Released resources are tagged with the serial of the newest begun frame and destroyed in bulk by 'collect' once the frame pacer reports that serial as completed.
+	// Not thread safe, all calls must come from the thread driving the frame pacer.
+	struct DeletionQueue {
+	public:
+		DeletionQueue(vk::Device device, VmaAllocator allocator, const FramePacer& framePacer);
+		~DeletionQueue();
+
+		// Queues 'handle' for destruction, a null handle is ignored
+		template <class HandleType>
+		void release(HandleType handle) {
+			push(HandleType::objectType, ToRaw(handle), nullptr);
+		}
+		// Queues 'buffer' and its memory for destruction
+		void release(vk::Buffer buffer, VmaAllocation allocation) { push(vk::ObjectType::eBuffer, ToRaw(buffer), allocation); }
+		// Queues 'image' and its memory for destruction
+		void release(vk::Image image, VmaAllocation allocation) { push(vk::ObjectType::eImage, ToRaw(image), allocation); }
+		// Runs 'callback' once the current frames have completed, for anything that isn't a single handle
+		void defer(std::function<void()> callback);
+
+		// Destroys everything released before the newest completed frame began, call once per frame after the frame pacer began the frame
+		void collect();
+		// Destroys everything regardless of frames in flight, the device must be idle
+		void flush();
+
+		auto getPendingCount() const { return m_Entries.size() + m_Callbacks.size(); }
+		// Number of resources destroyed so far
+		auto getDestroyedCount() const { return m_DestroyedCount; }
+
+	private:
+		struct Entry {
+		public:
+			vk::ObjectType m_Type;
+			std::uint64_t m_Handle;
+			VmaAllocation m_Allocation;
+			std::uint64_t m_Serial;
+		};
+
+		struct Callback {
+		public:
+			std::function<void()> m_Callback;
+			std::uint64_t m_Serial;
+		};
+
+	private:
+		// Non dispatchable handles are either pointers or 64 bit integers depending on the platform, so they are stored as their bits
+		template <class HandleType>
+		static std::uint64_t ToRaw(HandleType handle) {
+			auto handle_      = static_cast<typename HandleType::CType>(handle);
+			std::uint64_t raw = 0;
+			static_assert(sizeof(handle_) <= sizeof(raw));
+			std::memcpy(&raw, &handle_, sizeof(handle_));
+			return raw;
+		}
+
+		void push(vk::ObjectType type, std::uint64_t handle, VmaAllocation allocation);
+		// Destroys every entry and callback up to and including 'serial'
+		void destroyUpTo(std::uint64_t serial);
+		void destroyEntry(const Entry& entry);
+
+	private:
+		vk::Device m_Device;
+		VmaAllocator m_Allocator;
+		const FramePacer& m_FramePacer;
+
+		std::deque<Entry> m_Entries; // Ordered by serial, since the frame serial only grows
+		std::deque<Callback> m_Callbacks;
+		std::uint64_t m_DestroyedCount = 0;
+	};
+} // namespace Graphics
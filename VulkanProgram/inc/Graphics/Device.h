@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Common.h"
+#include "Instance.h"
+
+#include <cstdint>
+
+#include <initializer_list>
+#include <string_view>
+#include <vector>
+
+namespace Graphics {
+	// What a physical device can do beyond Vulkan 1.0, every flag is only set if the instance and device versions allow using it
+	struct DeviceCapabilities {
+	public:
+		Version m_APIVersion;                    // Lower of the instance and device versions
+		vk::DeviceSize m_DeviceLocalMemory = 0; // Size of the largest device local heap
+		bool m_DedicatedTransferQueue      = false;
+		bool m_DedicatedComputeQueue       = false;
+		bool m_TimelineSemaphores          = false;
+		bool m_DescriptorIndexing          = false; // The subset 'BindlessTable' needs, enabled by 'DeviceFeatureChain'
+		bool m_MemoryBudget                = false;
+		bool m_DynamicRendering            = false;
+		bool m_DrawIndirectCount           = false;
+		bool m_MultiDrawIndirect           = false;
+		bool m_DrawIndirectFirstInstance   = false; // Indirect draws can start at an instance other than 0
+		bool m_PipelineStatistics          = false;
+		bool m_InheritedQueries            = false;
+	};
+
+	// Queue family picked for each kind of work, the compute and transfer families fall back to the graphics family if there is no dedicated one
+	struct DeviceQueueFamilies {
+	public:
+		std::uint32_t m_Graphics = ~0U;
+		std::uint32_t m_Compute  = ~0U;
+		std::uint32_t m_Transfer = ~0U;
+
+		bool hasGraphics() const { return m_Graphics != ~0U; }
+	};
+
+	// Extensions and the feature chain that enable every capability in 'capabilities', the chain points into this struct so it must not be moved while in use
+	struct DeviceFeatureChain {
+	public:
+		DeviceFeatureChain(const DeviceCapabilities& capabilities);
+		DeviceFeatureChain(const DeviceFeatureChain&) = delete;
+
+		DeviceFeatureChain& operator=(const DeviceFeatureChain&) = delete;
+
+		// Features handed to 'vk::DeviceCreateInfo', nullptr if 'getNext' is used instead
+		const vk::PhysicalDeviceFeatures* getFeatures() const { return m_UseFeatures2 ? nullptr : &m_Features2.features; }
+		// Head of the chain for 'vk::DeviceCreateInfo::pNext'
+		const void* getNext() const { return m_UseFeatures2 ? &m_Features2 : nullptr; }
+		auto& getExtensions() const { return m_Extensions; }
+
+	public:
+		vk::PhysicalDeviceFeatures2 m_Features2;
+		vk::PhysicalDeviceVulkan12Features m_Vulkan12Features;
+		vk::PhysicalDeviceDescriptorIndexingFeatures m_IndexingFeatures;
+		vk::PhysicalDeviceTimelineSemaphoreFeatures m_TimelineFeatures;
+		vk::PhysicalDeviceDynamicRenderingFeaturesKHR m_DynamicRenderingFeatures;
+		std::vector<const char*> m_Extensions;
+
+	private:
+		bool m_UseFeatures2 = false;
+	};
+
+	struct Device : public Handle<vk::Device> {
+	public:
+		static DeviceCapabilities GetCapabilities(vk::PhysicalDevice physicalDevice, std::uint32_t instanceVersion);
+		// Picks the queue families, the graphics family must be able to present to 'surface' unless it is nullptr
+		static DeviceQueueFamilies GetQueueFamilies(vk::PhysicalDevice physicalDevice, vk::SurfaceKHR surface);
+		static bool HasExtension(vk::PhysicalDevice physicalDevice, std::string_view name);
+		// Higher is better, 0 if the device can't be used at all. Device type comes first, then capabilities and then device local memory
+		static std::uint64_t Score(vk::PhysicalDevice physicalDevice, std::uint32_t instanceVersion, vk::SurfaceKHR surface, const std::vector<const char*>& requiredExtensions = {});
+		// Returns the best scored physical device, or nullptr if none is usable
+		static vk::PhysicalDevice PickPhysicalDevice(vk::Instance instance, std::uint32_t instanceVersion, vk::SurfaceKHR surface, const std::vector<const char*>& requiredExtensions = {});
+		// Creates one queue of every distinct family and enables every capability through 'DeviceFeatureChain', the chain's extensions are added to 'extensions'
+		static vk::Device CreateLogicalDevice(vk::PhysicalDevice physicalDevice, const DeviceCapabilities& capabilities, std::initializer_list<std::uint32_t> queueFamilies, std::vector<const char*>& extensions);
+
+	public:
+		Device(Instance& instance, vk::SurfaceKHR surface = nullptr);
+		~Device();
+
+		// Requested extensions are enabled if the picked device has them, devices lacking a required one are never picked
+		void requestExtension(std::string_view name, bool required = true);
+
+		bool isExtensionEnabled(std::string_view name) const;
+
+		auto getPhysicalDevice() const { return m_PhysicalDevice; }
+		auto& getCapabilities() const { return m_Capabilities; }
+		auto& getQueueFamilies() const { return m_QueueFamilies; }
+		auto& getEnabledExtensions() const { return m_EnabledExtensions; }
+		auto getGraphicsQueue() const { return m_GraphicsQueue; }
+		auto getComputeQueue() const { return m_ComputeQueue; }
+		auto getTransferQueue() const { return m_TransferQueue; }
+
+	private:
+		virtual void createImpl() override;
+		virtual bool destroyImpl() override;
+
+	protected:
+		Instance& m_Instance;
+		vk::SurfaceKHR m_Surface;
+
+		std::vector<const char*> m_RequiredExtensions; // Interned
+		std::vector<const char*> m_OptionalExtensions; // Interned
+		std::vector<const char*> m_EnabledExtensions;
+
+		vk::PhysicalDevice m_PhysicalDevice;
+		DeviceCapabilities m_Capabilities;
+		DeviceQueueFamilies m_QueueFamilies;
+		vk::Queue m_GraphicsQueue;
+		vk::Queue m_ComputeQueue;
+		vk::Queue m_TransferQueue;
+	};
+} // namespace Graphics
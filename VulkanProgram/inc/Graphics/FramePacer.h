@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vulkan.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+#include <vector>
+
+namespace Graphics {
+	struct FrameTimings {
+	public:
+		double m_CPUTime  = 0.0; // Milliseconds spent recording and submitting the frame
+		double m_GPUTime  = 0.0; // Milliseconds the GPU spent executing the frame, measured with timestamp queries
+		double m_WaitTime = 0.0; // Milliseconds the CPU was blocked waiting for the frame slot to be released by the GPU
+	};
+
+	// Owns the per frame in flight synchronization objects and lets the CPU record frame N + 1 while the GPU executes frame N.
+	// The GPU time of a frame slot is read back the next time that slot is begun, at which point its fence has already signaled, so it never stalls.
+	struct FramePacer {
+	public:
+		FramePacer(vk::Device device, vk::PhysicalDevice physicalDevice, std::uint32_t queueFamilyIndex, std::uint32_t framesInFlight);
+		~FramePacer();
+
+		void create();
+		void destroy();
+
+		// Waits until the GPU has finished with the current frame slot, returns the slot index
+		std::uint32_t beginFrame();
+		// Writes the frame begin timestamp, must be called outside of a render pass and before any other command
+		void beginTimestamps(vk::CommandBuffer commandBuffer);
+		// Writes the frame end timestamp, must be called outside of a render pass and after every other command
+		void endTimestamps(vk::CommandBuffer commandBuffer);
+		// Resets the in flight fence right before it's handed to the queue submit, so a skipped frame never leaves an unsignaled fence behind
+		vk::Fence prepareSubmit();
+		// Marks the frame as submitted and advances to the next frame slot
+		void endFrame();
+		// Advances to the next frame slot without having submitted anything
+		void skipFrame();
+
+		auto getFramesInFlight() const { return m_FramesInFlight; }
+		auto getCurrentFrame() const { return m_CurrentFrame; }
+		// Monotonic counter of begun frames, useful to tag resources with the frame that last used them
+		auto getFrameSerial() const { return m_FrameSerial; }
+		// Serial of the newest frame the GPU is known to have finished
+		auto getCompletedFrameSerial() const { return m_CompletedFrameSerial; }
+
+		auto getInFlightFence() const { return m_InFlightFences[m_CurrentFrame]; }
+		auto getImageAvailableSemaphore() const { return m_ImageAvailableSemaphores[m_CurrentFrame]; }
+		auto getRenderFinishedSemaphore() const { return m_RenderFinishedSemaphores[m_CurrentFrame]; }
+
+		// Timings of the most recent frame, the GPU time lags behind by the number of frames in flight
+		auto& getLastTimings() const { return m_LastTimings; }
+		bool hasGPUTimings() const { return m_TimestampQueryPool; }
+		bool isCreated() const { return !m_InFlightFences.empty(); }
+
+	private:
+		void readTimestamps(std::uint32_t frame);
+
+	private:
+		vk::Device m_Device;
+		vk::PhysicalDevice m_PhysicalDevice;
+		std::uint32_t m_QueueFamilyIndex;
+		std::uint32_t m_FramesInFlight;
+
+		std::vector<vk::Semaphore> m_ImageAvailableSemaphores;
+		std::vector<vk::Semaphore> m_RenderFinishedSemaphores;
+		std::vector<vk::Fence> m_InFlightFences;
+		std::vector<std::uint64_t> m_FrameSerials;
+
+		vk::QueryPool m_TimestampQueryPool = nullptr;
+		std::vector<bool> m_TimestampsWritten;
+		double m_TimestampPeriod      = 0.0;
+		std::uint64_t m_TimestampMask = ~0ULL;
+
+		std::uint32_t m_CurrentFrame         = 0;
+		std::uint64_t m_FrameSerial          = 0;
+		std::uint64_t m_CompletedFrameSerial = 0;
+
+		std::chrono::steady_clock::time_point m_FrameStart;
+		FrameTimings m_LastTimings;
+	};
+} // namespace Graphics
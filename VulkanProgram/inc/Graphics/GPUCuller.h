@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Graphics/ComputePipeline.h"
+#include "Graphics/ShaderLibrary.h"
+#include "Graphics/UploadManager.h"
+#include "Utils/Math.h"
+
+#include <vulkan.hpp>
+
+#include <vk_mem_alloc.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Graphics {
+	// Matches 'Object' in cull.comp and indirect.vert, laid out for std430
+	struct CullObject {
+	public:
+		Utils::Mat4 m_Model;
+		float m_BoundingSphere[4]; // Object space center and radius
+
+		std::uint32_t m_FirstLOD    = 0; // Range of the levels of detail in the LOD list, full detail first
+		std::uint32_t m_LODCount    = 0;
+		std::int32_t m_VertexOffset = 0;
+		std::uint32_t m_Padding     = 0;
+	};
+
+	// Matches 'LOD' in cull.comp, objects drawing the same mesh share their levels of detail
+	struct CullLOD {
+	public:
+		std::uint32_t m_FirstIndex = 0;
+		std::uint32_t m_IndexCount = 0;
+		float m_Error              = 0.0f; // Object space error, in the units the object's model matrix transforms
+		std::uint32_t m_Padding    = 0;
+	};
+
+	// How the culled draws are issued, depending on what the device supports
+	enum class IndirectDrawMode {
+		Count,  // One 'drawIndexedIndirectCount' over the compacted visible draws, 'Multi' if there are more objects than one call can draw
+		Multi,  // 'drawIndexedIndirect' over every object in batches of up to 'maxDrawIndirectCount', culled ones have an instance count of 0
+		Single  // One 'drawIndexedIndirect' per object, for devices without 'multiDrawIndirect'
+	};
+
+	// Culls object bounding spheres against the camera frustum in a compute pass and writes the indirect draws of the visible ones.
+	// Every visible object draws the coarsest level of detail whose error projects to at most the threshold in pixels, picked the same way as 'selectLOD' in Main.cpp.
+	// The graphics pass draws every object with a single indirect call, so the CPU cost per frame doesn't depend on the object count.
+	// Every frame in flight has its own draw buffers, the object buffer is shared and bound at binding 0 for the vertex shader as well.
+	// The object index is passed as the first instance, so the device needs 'drawIndirectFirstInstance'.
+	struct GPUCuller {
+	public:
+		GPUCuller(vk::Device device, VmaAllocator allocator, UploadManager& uploadManager, ShaderLibrary& shaderLibrary, vk::PipelineCache pipelineCache, std::uint32_t framesInFlight, IndirectDrawMode mode, std::uint32_t maxDrawCount);
+		~GPUCuller();
+
+		void create();
+		void destroy();
+
+		// Replaces the objects and the levels of detail they index and uploads them, no frame in flight may still use the previous ones
+		void setObjects(const std::vector<CullObject>& objects, const std::vector<CullLOD>& lods);
+
+		// Records the culling dispatch for 'frame' into 'commandBuffer', which must be outside of a render pass
+		void cull(vk::CommandBuffer commandBuffer, std::uint32_t frame, const Utils::Mat4& projView, float viewportHeight, float lodThreshold);
+		// Records the indirect draws of 'frame', the graphics pipeline, index and vertex buffers must already be bound
+		void draw(vk::CommandBuffer commandBuffer, std::uint32_t frame);
+
+		auto getLayout() const { return m_DescriptorSetLayout; }
+		auto getDescriptorSet(std::uint32_t frame) const { return m_Frames[frame].m_DescriptorSet; }
+		auto getObjectCount() const { return m_ObjectCount; }
+		auto getMode() const { return m_Mode; }
+		bool isCreated() const { return m_Pipeline.isCreated(); }
+
+	private:
+		struct Frame {
+		public:
+			vk::Buffer m_CommandBuffer                = nullptr;
+			VmaAllocation m_CommandBufferAllocation   = nullptr;
+			vk::Buffer m_DrawCountBuffer              = nullptr;
+			VmaAllocation m_DrawCountBufferAllocation = nullptr;
+			vk::DescriptorSet m_DescriptorSet;
+		};
+
+		// Matches 'CullConstants' in cull.comp, fills the 128 bytes of push constants every device has.
+		// The level of detail only needs the w row of 'projView' and its vertical scale in pixels, not the whole matrix
+		struct CullConstants {
+		public:
+			float m_Planes[6][4];
+			float m_DepthRow[4];
+			std::uint32_t m_ObjectCount;
+			std::uint32_t m_Compact;
+			float m_PixelScale; // Pixels per unit at a w of 1
+			float m_LODThreshold;
+		};
+
+	private:
+		// Whether the culling compacts the visible draws for 'drawIndexedIndirectCount'
+		bool isCompacted() const { return m_Mode == IndirectDrawMode::Count && m_ObjectCount <= m_MaxDrawCount; }
+
+		vk::Buffer createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, VmaAllocation& allocation);
+		void destroyBuffers();
+
+	private:
+		vk::Device m_Device;
+		VmaAllocator m_Allocator;
+		UploadManager& m_UploadManager;
+		std::uint32_t m_FramesInFlight;
+		IndirectDrawMode m_Mode;
+		std::uint32_t m_MaxDrawCount; // 'maxDrawIndirectCount' of the device
+
+		vk::DescriptorSetLayout m_DescriptorSetLayout = nullptr;
+		vk::DescriptorPool m_DescriptorPool           = nullptr;
+		ComputePipeline m_Pipeline;
+
+		vk::Buffer m_ObjectBuffer              = nullptr;
+		VmaAllocation m_ObjectBufferAllocation = nullptr;
+		vk::Buffer m_LODBuffer                 = nullptr;
+		VmaAllocation m_LODBufferAllocation    = nullptr;
+		std::uint32_t m_ObjectCount            = 0;
+		std::vector<Frame> m_Frames;
+	};
+} // namespace Graphics
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <vulkan.hpp>
+
+#include <array>
+#include <cstdint>
+
+#include <deque>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Graphics {
+	// Rolling statistics of one named scope in milliseconds, taken over the last samples the scope was measured in
+	struct GPUScopeStats {
+	public:
+		std::string m_Name;
+		std::uint32_t m_Depth = 0; // Nesting depth the scope was last recorded at
+		double m_Last         = 0.0;
+		double m_Min          = 0.0;
+		double m_Avg          = 0.0;
+		double m_Max          = 0.0;
+	};
+
+	// Counters of a whole frame, in the order Vulkan writes them for the queried statistics
+	struct GPUPipelineStatistics {
+	public:
+		std::uint64_t m_InputAssemblyVertices     = 0;
+		std::uint64_t m_InputAssemblyPrimitives   = 0;
+		std::uint64_t m_VertexShaderInvocations   = 0;
+		std::uint64_t m_ClippingInvocations       = 0;
+		std::uint64_t m_ClippingPrimitives        = 0;
+		std::uint64_t m_FragmentShaderInvocations = 0;
+		std::uint64_t m_ComputeShaderInvocations  = 0;
+	};
+
+	// Measures named scopes of every frame with timestamp queries, and the whole frame with a pipeline statistics query where the device supports it.
+	// Every frame in flight has its own range of queries, which is read back the next time that frame slot is begun, so reading results never stalls.
+	// Not thread safe, scopes must be recorded into primary command buffers from the thread that begins the frame.
+	struct GPUProfiler {
+	public:
+		static constexpr std::uint32_t s_InvalidScope = ~0U;
+		static constexpr std::uint32_t s_MaxScopes    = 64;      // Per frame, scopes past this are not measured
+		static constexpr std::size_t s_HistorySize    = 120;     // Samples the rolling statistics are taken over
+		static constexpr std::size_t s_MaxTraceEvents = 1 << 16; // Measured scopes kept for exporting, the oldest are dropped first
+
+	public:
+		// 'pipelineStatistics' requires the 'pipelineStatisticsQuery' feature to be enabled on the device
+		GPUProfiler(vk::Device device, vk::PhysicalDevice physicalDevice, std::uint32_t queueFamilyIndex, std::uint32_t framesInFlight, bool pipelineStatistics);
+		~GPUProfiler();
+
+		void create();
+		void destroy();
+
+		// Reads back the last frame recorded for 'frame' and resets its queries, the fence of that frame must have signaled.
+		// Must be called outside of a render pass before any scope of the frame
+		void beginFrame(vk::CommandBuffer commandBuffer, std::uint32_t frame);
+		// Ends the pipeline statistics query, must be called outside of a render pass after the last scope of the frame
+		void endFrame(vk::CommandBuffer commandBuffer);
+
+		// Writes the begin timestamp of a scope, returns 's_InvalidScope' if the frame is out of scopes or timestamps aren't supported
+		std::uint32_t beginScope(vk::CommandBuffer commandBuffer, std::string_view name);
+		// Writes the end timestamp of 'scope', scopes must be ended in the reverse order they were begun
+		void endScope(vk::CommandBuffer commandBuffer, std::uint32_t scope);
+
+		// Reads back every frame still waiting for its results, the device must be idle
+		void resolve();
+
+		// Draws the statistics into an ImGui window, must be called between 'ImGui::NewFrame' and 'ImGui::Render'
+		void drawOverlay() const;
+
+		// Writes every kept measurement as one row per scope
+		bool writeCSV(const std::filesystem::path& path) const;
+		// Writes every kept measurement in the Chrome trace event format, which 'chrome://tracing' and Perfetto can open
+		bool writeJSON(const std::filesystem::path& path) const;
+
+		// Statistics the query counts, secondary command buffers executed while it's active have to inherit them
+		vk::QueryPipelineStatisticFlags getPipelineStatisticFlags() const;
+		auto& getScopeStats() const { return m_Stats; }
+		auto& getPipelineStatistics() const { return m_LastPipelineStatistics; }
+		bool hasTimestamps() const { return m_TimestampQueryPool; }
+		bool hasPipelineStatistics() const { return m_StatisticsQueryPool; }
+		bool isCreated() const { return m_Created; }
+
+	private:
+		struct Scope {
+		public:
+			std::uint32_t m_Name;
+			std::uint32_t m_Depth;
+		};
+
+		struct Frame {
+		public:
+			std::vector<Scope> m_Scopes; // Scope i owns the queries 2 * i and 2 * i + 1 of the frame's range
+			std::uint64_t m_Serial   = 0;
+			bool m_Recorded          = false;
+			bool m_StatisticsWritten = false;
+		};
+
+		struct History {
+		public:
+			std::array<double, s_HistorySize> m_Samples;
+			std::size_t m_Count = 0;
+			std::size_t m_Next  = 0;
+		};
+
+		struct TraceEvent {
+		public:
+			std::uint64_t m_Frame;
+			std::uint32_t m_Name;
+			std::uint32_t m_Depth;
+			double m_Start; // Milliseconds since the first measured timestamp
+			double m_Duration;
+		};
+
+	private:
+		void readResults(std::uint32_t frame);
+		void addSample(std::uint32_t name, std::uint32_t depth, double time);
+		std::uint32_t getNameId(std::string_view name);
+
+	private:
+		vk::Device m_Device;
+		vk::PhysicalDevice m_PhysicalDevice;
+		std::uint32_t m_QueueFamilyIndex;
+		std::uint32_t m_FramesInFlight;
+		bool m_PipelineStatistics;
+		bool m_Created = false;
+
+		vk::QueryPool m_TimestampQueryPool  = nullptr;
+		vk::QueryPool m_StatisticsQueryPool = nullptr;
+		double m_TimestampPeriod            = 0.0;
+		std::uint64_t m_TimestampMask       = ~0ULL;
+		std::uint64_t m_Epoch               = 0;
+		bool m_HasEpoch                     = false;
+
+		std::vector<Frame> m_Frames;
+		std::uint32_t m_CurrentFrame = 0;
+		std::uint32_t m_OpenScopes   = 0;
+		std::uint64_t m_FrameSerial  = 0;
+
+		std::unordered_map<std::string, std::uint32_t> m_NameIds;
+		std::vector<GPUScopeStats> m_Stats; // Indexed by name id, in the order the names were first seen
+		std::vector<History> m_Histories;
+		std::deque<TraceEvent> m_Trace;
+		GPUPipelineStatistics m_LastPipelineStatistics;
+	};
+
+	// Measures the commands recorded into 'commandBuffer' during its lifetime as one scope
+	struct GPUProfileScope {
+	public:
+		GPUProfileScope(GPUProfiler& profiler, vk::CommandBuffer commandBuffer, std::string_view name)
+		    : m_Profiler(profiler), m_CommandBuffer(commandBuffer), m_Scope(profiler.beginScope(commandBuffer, name)) { }
+		GPUProfileScope(const GPUProfileScope&) = delete;
+		~GPUProfileScope() { m_Profiler.endScope(m_CommandBuffer, m_Scope); }
+
+		GPUProfileScope& operator=(const GPUProfileScope&) = delete;
+
+	private:
+		GPUProfiler& m_Profiler;
+		vk::CommandBuffer m_CommandBuffer;
+		std::uint32_t m_Scope;
+	};
+} // namespace Graphics
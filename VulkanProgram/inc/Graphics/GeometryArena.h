@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Graphics/DeletionQueue.h"
+
+#include <vulkan.hpp>
+
+#include <vk_mem_alloc.h>
+
+#include <cstdint>
+
+#include <vector>
+
+namespace Graphics {
+	// Identifies an allocation of a geometry arena, stays valid when defragmenting moves the allocation
+	using GeometryAllocation = std::uint32_t;
+
+	constexpr GeometryAllocation InvalidGeometryAllocation = ~0U;
+
+	// Where an allocation currently lives, in elements so 'm_First' can be used as 'vertexOffset' or 'firstIndex' directly
+	struct GeometryRange {
+	public:
+		std::uint32_t m_Page  = ~0U;
+		std::uint32_t m_First = 0;
+		std::uint32_t m_Count = 0;
+
+		bool isValid() const { return m_Page != ~0U; }
+	};
+
+	struct GeometryArenaStatistics {
+	public:
+		std::uint32_t m_PageCount              = 0;
+		std::uint32_t m_AllocationCount        = 0;
+		std::uint32_t m_FreeRangeCount         = 0;
+		vk::DeviceSize m_CapacityBytes         = 0;
+		vk::DeviceSize m_UsedBytes             = 0;
+		vk::DeviceSize m_LargestFreeRangeBytes = 0;
+		// 0 when all free space is one range, approaching 1 the more it is scattered over small ranges
+		float m_Fragmentation = 0.0f;
+	};
+
+	// Sub-allocates fixed size elements, vertices of one layout or indices of one type, out of a few large device local buffers.
+	// Every buffer is a page whose free space is tracked by a VMA virtual block counting elements, not bytes, so meshes sharing a page are drawn with one binding.
+	// Not thread safe, all calls must come from the thread recording the frames.
+	struct GeometryArena {
+	public:
+		GeometryArena(vk::Device device, VmaAllocator allocator, DeletionQueue& deletionQueue, vk::BufferUsageFlags usage, vk::DeviceSize elementSize, std::uint32_t pageElementCount);
+		~GeometryArena();
+
+		void create();
+		void destroy();
+
+		// Allocates 'count' consecutive elements, a new page is added if no page has room. Allocations larger than a page get a page of their own
+		GeometryAllocation allocate(std::uint32_t count);
+		// The elements can be reused right away, the caller must ensure no frame in flight still reads them
+		void free(GeometryAllocation allocation);
+
+		// Moves every allocation into as few new pages as possible, recording the copies into 'commandBuffer', which must be outside of a render pass.
+		// Uploads into the arena must have been acquired by an earlier submission to the queue of 'commandBuffer'. The old pages are released to the deletion queue.
+		// Ranges, and the buffers they're in, change, so anything holding on to them has to fetch them again. Returns false if the arena is empty
+		bool defragment(vk::CommandBuffer commandBuffer);
+
+		GeometryRange getRange(GeometryAllocation allocation) const;
+		vk::Buffer getBuffer(std::uint32_t page) const { return m_Pages[page].m_Buffer; }
+		vk::DeviceSize getByteOffset(const GeometryRange& range) const { return range.m_First * m_ElementSize; }
+		GeometryArenaStatistics getStatistics() const;
+
+		auto getPageCount() const { return static_cast<std::uint32_t>(m_Pages.size()); }
+		auto getElementSize() const { return m_ElementSize; }
+		// Increases every time defragmenting moves allocations
+		auto getGeneration() const { return m_Generation; }
+		bool isCreated() const { return m_Created; }
+
+	private:
+		struct Page {
+		public:
+			vk::Buffer m_Buffer;
+			VmaAllocation m_Allocation = nullptr;
+			VmaVirtualBlock m_Block    = nullptr;
+			std::uint32_t m_Capacity   = 0;
+		};
+
+		struct Slot {
+		public:
+			VmaVirtualAllocation m_Allocation = nullptr;
+			GeometryRange m_Range;
+		};
+
+	private:
+		Page createPage(std::uint32_t capacity);
+		// Tries to place 'count' elements in one of 'pages', adding a page if none has room
+		GeometryRange place(std::vector<Page>& pages, std::uint32_t count, VmaVirtualAllocation& allocation);
+
+	private:
+		vk::Device m_Device;
+		VmaAllocator m_Allocator;
+		DeletionQueue& m_DeletionQueue;
+		vk::BufferUsageFlags m_Usage;
+		vk::DeviceSize m_ElementSize;
+		std::uint32_t m_PageElementCount;
+
+		std::vector<Page> m_Pages;
+		std::vector<Slot> m_Slots;
+		std::vector<GeometryAllocation> m_FreeSlots;
+		std::uint64_t m_Generation = 0;
+		bool m_Created             = false;
+	};
+} // namespace Graphics
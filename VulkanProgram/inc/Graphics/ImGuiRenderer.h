@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Graphics/PipelineCompiler.h"
+#include "Graphics/UploadManager.h"
+
+#include <vulkan.hpp>
+
+#include <vk_mem_alloc.h>
+
+#include <cstdint>
+
+#include <vector>
+
+struct ImDrawData;
+
+namespace Graphics {
+	// Renders ImGui draw data with its own pipeline, font texture and vertex and index buffers per frame in flight.
+	// Only the ImGui core is built, so this takes the place of its Vulkan backend. Not thread safe, but 'record' may run on any one recording thread.
+	struct ImGuiRenderer {
+	public:
+		ImGuiRenderer(vk::Device device, VmaAllocator allocator, UploadManager& uploadManager, PipelineCompiler& pipelineCompiler, std::uint32_t framesInFlight);
+		~ImGuiRenderer();
+
+		// Uploads the font atlas of the current ImGui context and requests the pipeline for 'renderPass', the upload manager must be flushed afterwards
+		void create(vk::RenderPass renderPass, std::uint32_t subpass = 0);
+		void destroy();
+
+		// Records 'drawData' into 'commandBuffer' inside the render pass, nothing is drawn until the pipeline is ready
+		void record(vk::CommandBuffer commandBuffer, std::uint32_t frame, const ImDrawData* drawData);
+
+		bool isCreated() const { return m_PipelineLayout; }
+
+	private:
+		struct Buffer {
+		public:
+			vk::Buffer m_Buffer        = nullptr;
+			VmaAllocation m_Allocation = nullptr;
+			vk::DeviceSize m_Size      = 0;
+			void* m_Data               = nullptr;
+		};
+
+		struct Frame {
+		public:
+			Buffer m_VertexBuffer;
+			Buffer m_IndexBuffer;
+		};
+
+		// Matches 'PushConstants' in imgui.vert, maps ImGui's display coordinates to clip space
+		struct PushConstants {
+		public:
+			float m_Scale[2];
+			float m_Translate[2];
+		};
+
+	private:
+		// Grows 'buffer' to at least 'size' bytes, the frame that last used it must have finished
+		void reserve(Buffer& buffer, vk::DeviceSize size, vk::BufferUsageFlags usage);
+		void destroyBuffer(Buffer& buffer);
+
+	private:
+		vk::Device m_Device;
+		VmaAllocator m_Allocator;
+		UploadManager& m_UploadManager;
+		PipelineCompiler& m_PipelineCompiler;
+		std::uint32_t m_FramesInFlight;
+
+		vk::Image m_FontImage               = nullptr;
+		VmaAllocation m_FontImageAllocation = nullptr;
+		vk::ImageView m_FontImageView       = nullptr;
+		vk::Sampler m_FontSampler           = nullptr;
+		vk::DescriptorSetLayout m_SetLayout = nullptr;
+		vk::DescriptorPool m_DescriptorPool = nullptr;
+		vk::DescriptorSet m_DescriptorSet   = nullptr;
+		vk::PipelineLayout m_PipelineLayout = nullptr;
+		PipelineCompiler::Handle m_Pipeline = PipelineCompiler::s_InvalidHandle;
+
+		std::vector<Frame> m_Frames;
+	};
+} // namespace Graphics
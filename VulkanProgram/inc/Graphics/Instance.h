@@ -4,7 +4,11 @@
 
 #include <cstdint>
 
+#include <filesystem>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace Graphics {
 	struct InstanceLayer {
@@ -12,13 +16,36 @@ namespace Graphics {
 		InstanceLayer(std::string_view name, Version version, bool required = true);
 
 	public:
-		std::string m_Name;
+		const char* m_Name; // Interned, so names compare by pointer and can be handed to Vulkan as they are
 		Version m_Version;
 		bool m_Required = true;
 	};
 
 	using InstanceExtension = InstanceLayer;
 
+	// Layers or extensions indexed by their interned name
+	struct InstanceLayerTable {
+	public:
+		// Returns the entry named 'name', which must be interned, or nullptr
+		InstanceLayer* findInterned(const char* name);
+		const InstanceLayer* findInterned(const char* name) const;
+		// Returns the entry named 'name', or nullptr
+		const InstanceLayer* find(std::string_view name) const;
+
+		// Adds 'layer', replacing the entry with the same name
+		void insert(const InstanceLayer& layer);
+		void reserve(std::size_t count);
+		void clear();
+
+		auto& getLayers() const { return m_Layers; }
+		auto size() const { return m_Layers.size(); }
+		bool empty() const { return m_Layers.empty(); }
+
+	private:
+		std::vector<InstanceLayer> m_Layers;
+		std::unordered_map<const char*, std::size_t> m_Indices;
+	};
+
 	struct Instance : public Handle<vk::Instance> {
 	public:
 		static Version GetVulkanVersion();
@@ -27,10 +54,25 @@ namespace Graphics {
 		static bool HasLayer(std::string_view name, Version lowestVersion = {});
 		static bool HasExtension(std::string_view name, Version lowestVersion = {});
 
+		// Seeds the available layers and extensions from a snapshot written by 'SaveEnumerationSnapshot', skipping the loader's enumeration.
+		// The snapshot is ignored if the Vulkan version or the loader's environment variables changed since it was written
+		static bool LoadEnumerationSnapshot(const std::filesystem::path& path);
+		// Writes the available layers and extensions, enumerating them first if needed
+		static bool SaveEnumerationSnapshot(const std::filesystem::path& path);
+		// True while the available layers and extensions came from a snapshot instead of the loader
+		static bool IsEnumerationFromSnapshot() { return s_EnumerationFromSnapshot; }
+
+	private:
+		// Hash of everything that changes what the loader enumerates that can be checked without enumerating
+		static std::uint64_t GetEnumerationKey();
+
 	private:
 		static Version s_CachedVersion;
-		static std::vector<InstanceLayer> s_CachedAvailableLayers;
-		static std::vector<InstanceLayer> s_CachedAvailableExtensions;
+		static InstanceLayerTable s_CachedAvailableLayers;
+		static InstanceLayerTable s_CachedAvailableExtensions;
+		static bool s_LayersEnumerated;
+		static bool s_ExtensionsEnumerated;
+		static bool s_EnumerationFromSnapshot;
 
 	public:
 		Instance(std::string_view appName, Version appVersion, std::string_view engineName, Version engineVersion, Version minAPIVersion = {}, Version maxAPIVersion = { ~0U });
@@ -46,9 +88,11 @@ namespace Graphics {
 		auto getAppVersion() const { return m_AppVersion; }
 		auto& getEngineName() const { return m_EngineName; }
 		auto getEngineVersion() const { return m_EngineVersion; }
+		// Version the instance was created with, devices can't use anything newer
+		auto getAPIVersion() const { return m_APIVersion; }
 
-		auto& getEnabledLayers() const { return m_EnabledLayers; }
-		auto& getEnabledExtensions() const { return m_EnabledExtensions; }
+		auto& getEnabledLayers() const { return m_EnabledLayers.getLayers(); }
+		auto& getEnabledExtensions() const { return m_EnabledExtensions.getLayers(); }
 		auto& getMissingLayers() const { return m_MissingLayers; }
 		auto& getMissingExtensions() const { return m_MissingExtensions; }
 
@@ -59,6 +103,9 @@ namespace Graphics {
 		virtual void createImpl() override;
 		virtual bool destroyImpl() override;
 
+		// Matches the requested layers and extensions against the available ones, returns false if a required one is missing
+		bool negotiate();
+
 	protected:
 		std::string m_AppName;
 		Version m_AppVersion;
@@ -66,12 +113,17 @@ namespace Graphics {
 		Version m_EngineVersion;
 		Version m_MinAPIVersion;
 		Version m_MaxAPIVersion;
+		Version m_APIVersion;
 
-		std::vector<InstanceLayer> m_Layers;
-		std::vector<InstanceExtension> m_Extensions;
-		std::vector<InstanceLayer> m_EnabledLayers;
-		std::vector<InstanceExtension> m_EnabledExtensions;
+		InstanceLayerTable m_Layers;
+		InstanceLayerTable m_Extensions;
+		InstanceLayerTable m_EnabledLayers;
+		InstanceLayerTable m_EnabledExtensions;
 		std::vector<InstanceLayer> m_MissingLayers;
 		std::vector<InstanceExtension> m_MissingExtensions;
+
+		// Names handed to 'vk::InstanceCreateInfo', kept so recreating the instance reuses their storage
+		std::vector<const char*> m_EnabledLayerNames;
+		std::vector<const char*> m_EnabledExtensionNames;
 	};
-} // namespace Graphics
\ No newline at end of file
+} // namespace Graphics
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vulkan.hpp>
+
+#include <vk_mem_alloc.h>
+
+#include <cstdint>
+
+#include <vector>
+
+namespace Graphics {
+	// Color and depth images rendered to instead of swapchain images when there is no window to present to.
+	// One target is created per frame in flight, so recording a frame never has to wait for the GPU to finish rendering the previous one.
+	struct OffscreenTarget {
+	public:
+		OffscreenTarget(vk::Device device, VmaAllocator allocator);
+		~OffscreenTarget();
+
+		// The render pass must leave the color attachment in eTransferSrcOptimal layout for 'readColor' to work
+		void create(vk::Extent2D extent, vk::Format colorFormat, vk::Format depthFormat, vk::RenderPass renderPass, std::uint32_t count);
+		void destroy();
+
+		// Copies the color image of a target into tightly packed 4 byte texels, blocks until the copy is done.
+		// Nothing may be rendering to the target while this runs.
+		std::vector<std::uint8_t> readColor(std::uint32_t index, vk::Queue queue, vk::CommandPool commandPool) const;
+
+		auto getExtent() const { return m_Extent; }
+		auto getColorFormat() const { return m_ColorFormat; }
+		auto getDepthFormat() const { return m_DepthFormat; }
+		auto getCount() const { return static_cast<std::uint32_t>(m_Targets.size()); }
+		auto getFramebuffer(std::uint32_t index) const { return m_Targets[index].m_Framebuffer; }
+		auto getColorImage(std::uint32_t index) const { return m_Targets[index].m_ColorImage; }
+		bool isCreated() const { return !m_Targets.empty(); }
+
+	private:
+		struct Target {
+		public:
+			vk::Image m_ColorImage               = nullptr;
+			VmaAllocation m_ColorImageAllocation = nullptr;
+			vk::ImageView m_ColorImageView       = nullptr;
+			vk::Image m_DepthImage               = nullptr;
+			VmaAllocation m_DepthImageAllocation = nullptr;
+			vk::ImageView m_DepthImageView       = nullptr;
+			vk::Framebuffer m_Framebuffer        = nullptr;
+		};
+
+	private:
+		vk::Device m_Device;
+		VmaAllocator m_Allocator;
+
+		vk::Extent2D m_Extent    = {};
+		vk::Format m_ColorFormat = vk::Format::eUndefined;
+		vk::Format m_DepthFormat = vk::Format::eUndefined;
+		std::vector<Target> m_Targets;
+	};
+} // namespace Graphics
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Graphics/AsyncCompute.h"
+#include "Graphics/ComputePipeline.h"
+#include "Graphics/PipelineCompiler.h"
+#include "Utils/Math.h"
+
+#include <vulkan.hpp>
+
+#include <vk_mem_alloc.h>
+
+#include <cstdint>
+
+#include <vector>
+
+namespace Graphics {
+	// Matches 'Particle' in particles.comp, read as two vertex attributes by particle.vert
+	struct Particle {
+	public:
+		float m_Position[4]; // w is the remaining lifetime in seconds
+		float m_Velocity[4];
+	};
+
+	// Simulates a fountain of particles in a compute shader and draws them as points, the CPU never touches a particle.
+	// Every step reads the state of the previous step and writes the next one into another of 'AsyncCompute::s_GraphicsLatency' buffers,
+	// so the step can run on the compute queue while graphics still draws the previous state. 'simulate' has to be called once for every 'AsyncCompute::submit'
+	struct ParticleSystem {
+	public:
+		ParticleSystem(vk::Device device, VmaAllocator allocator, ShaderLibrary& shaderLibrary, vk::PipelineCache pipelineCache, PipelineCompiler& pipelineCompiler, AsyncCompute& asyncCompute, std::uint32_t particleCount);
+		~ParticleSystem();
+
+		// Creates the particle buffers and the simulation pipeline, and requests the draw pipeline for 'renderPass'. The particles spawn during the first step
+		void create(vk::RenderPass renderPass, std::uint32_t subpass = 0);
+		void destroy();
+
+		// Records one simulation step into 'commandBuffer' from 'AsyncCompute::begin', outside of a render pass
+		void simulate(vk::CommandBuffer commandBuffer, float deltaTime);
+		// Records the draw of the newest state inside the render pass, nothing is drawn until the pipeline is ready or before the first step
+		void draw(vk::CommandBuffer commandBuffer, vk::Extent2D extent, const Utils::Mat4& projView);
+
+		auto getParticleCount() const { return m_ParticleCount; }
+		bool isCreated() const { return m_Simulation.isCreated(); }
+
+	private:
+		struct Buffer {
+		public:
+			vk::Buffer m_Buffer        = nullptr;
+			VmaAllocation m_Allocation = nullptr;
+		};
+
+		// Matches 'SimulationConstants' in particles.comp
+		struct SimulationConstants {
+		public:
+			float m_DeltaTime;
+			float m_Time;
+			std::uint32_t m_ParticleCount;
+			std::uint32_t m_Spawn; // Ignores the previous state and spawns every particle
+		};
+
+	private:
+		vk::Device m_Device;
+		VmaAllocator m_Allocator;
+		PipelineCompiler& m_PipelineCompiler;
+		AsyncCompute& m_AsyncCompute;
+		std::uint32_t m_ParticleCount;
+
+		std::vector<Buffer> m_Buffers;
+		vk::DescriptorSetLayout m_SetLayout = nullptr;
+		vk::DescriptorPool m_DescriptorPool = nullptr;
+		std::vector<vk::DescriptorSet> m_DescriptorSets; // Set i reads buffer i and writes the next one
+		ComputePipeline m_Simulation;
+
+		vk::PipelineLayout m_DrawLayout         = nullptr;
+		PipelineCompiler::Handle m_DrawPipeline = PipelineCompiler::s_InvalidHandle;
+
+		std::uint64_t m_StepCount = 0;
+		float m_Time              = 0.0f;
+	};
+} // namespace Graphics
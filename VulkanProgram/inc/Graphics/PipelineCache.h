@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vulkan.hpp>
+
+#include <cstdint>
+
+#include <filesystem>
+#include <vector>
+
+namespace Graphics {
+	// Mirrors 'VkPipelineCacheHeaderVersionOne', defined here as older Vulkan-Hpp versions don't expose it
+	struct PipelineCacheHeader {
+	public:
+		std::uint32_t m_HeaderSize;
+		std::uint32_t m_HeaderVersion;
+		std::uint32_t m_VendorID;
+		std::uint32_t m_DeviceID;
+		std::uint8_t m_PipelineCacheUUID[VK_UUID_SIZE];
+	};
+
+	struct PipelineCache {
+	public:
+		PipelineCache(vk::Device device, vk::PhysicalDevice physicalDevice, std::filesystem::path path);
+		~PipelineCache();
+
+		// Creates the pipeline cache, seeding it with the blob on disk if the blob was written by this exact device and driver
+		void create();
+		void destroy();
+		// Writes the current cache blob to disk, going through a temporary file so a crash never leaves a torn cache behind
+		bool save() const;
+
+		auto getHandle() const { return m_Handle; }
+		auto& getPath() const { return m_Path; }
+		// Warm means the cache was seeded from a valid blob on disk
+		bool isWarm() const { return m_Warm; }
+		bool isCreated() const { return m_Handle; }
+
+	private:
+		bool isBlobCompatible(const std::vector<std::uint8_t>& blob) const;
+
+	private:
+		vk::Device m_Device;
+		vk::PhysicalDevice m_PhysicalDevice;
+		std::filesystem::path m_Path;
+
+		vk::PipelineCache m_Handle = nullptr;
+		bool m_Warm                = false;
+	};
+} // namespace Graphics
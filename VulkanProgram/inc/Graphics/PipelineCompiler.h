@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Graphics/ShaderLibrary.h"
+#include "Utils/ThreadPool.h"
+
+#include <vulkan.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Graphics {
+	// Everything that identifies a graphics pipeline. Viewport, scissor and line width are always dynamic
+	struct GraphicsPipelineDesc {
+	public:
+		bool operator==(const GraphicsPipelineDesc& other) const = default;
+
+	public:
+		std::string m_VertexShader;
+		std::string m_FragmentShader;
+
+		std::vector<vk::VertexInputBindingDescription> m_VertexBindings;
+		std::vector<vk::VertexInputAttributeDescription> m_VertexAttributes;
+		vk::PrimitiveTopology m_Topology = vk::PrimitiveTopology::eTriangleList;
+
+		vk::PolygonMode m_PolygonMode = vk::PolygonMode::eFill;
+		vk::CullModeFlags m_CullMode  = vk::CullModeFlagBits::eBack;
+		vk::FrontFace m_FrontFace     = vk::FrontFace::eClockwise;
+
+		bool m_DepthTest               = true;
+		bool m_DepthWrite              = true;
+		vk::CompareOp m_DepthCompareOp = vk::CompareOp::eLess;
+		bool m_BlendEnable             = false;
+
+		vk::PipelineLayout m_Layout = nullptr;
+		vk::RenderPass m_RenderPass = nullptr;
+		std::uint32_t m_Subpass     = 0;
+	};
+
+	enum class PipelineState {
+		Compiling,
+		Ready,
+		Failed
+	};
+
+	// Compiles graphics pipelines on worker threads. 'request' returns a handle right away, the pipeline behind it becomes available once a worker has compiled it.
+	// Every compile goes through the same pipeline cache, which Vulkan allows to be used from multiple threads at once.
+	// Not thread safe, all calls must come from the same thread.
+	struct PipelineCompiler {
+	public:
+		using Handle = std::uint32_t;
+
+		static constexpr Handle s_InvalidHandle = ~0U;
+
+	public:
+		PipelineCompiler(vk::Device device, vk::PipelineCache pipelineCache, ShaderLibrary& shaderLibrary, Utils::ThreadPool& compilePool);
+		~PipelineCompiler();
+
+		void create();
+		void destroy();
+
+		// Returns the handle of the pipeline described by 'desc', identical descriptions share one pipeline and only compile once
+		Handle request(const GraphicsPipelineDesc& desc);
+		// Blocks until every requested pipeline has finished compiling
+		void waitIdle();
+
+		// Returns the pipeline once it's ready, otherwise the pipeline of 'fallback' if that one is ready, or a null handle
+		vk::Pipeline getPipeline(Handle handle, Handle fallback = s_InvalidHandle) const;
+		PipelineState getState(Handle handle) const { return m_Entries[handle].m_State.load(std::memory_order_acquire); }
+		bool isReady(Handle handle) const { return getState(handle) == PipelineState::Ready; }
+		// Milliseconds the worker spent compiling, only valid once the pipeline is ready
+		double getCompileTime(Handle handle) const { return m_Entries[handle].m_CompileTime; }
+		bool isCreated() const { return m_Created; }
+
+	private:
+		struct Entry {
+		public:
+			GraphicsPipelineDesc m_Desc;
+			std::atomic<PipelineState> m_State = PipelineState::Compiling;
+			vk::Pipeline m_Pipeline            = nullptr;
+			double m_CompileTime               = 0.0;
+		};
+
+	private:
+		static std::uint64_t Hash(const GraphicsPipelineDesc& desc);
+
+		void compile(Entry& entry, vk::ShaderModule vertexShader, vk::ShaderModule fragmentShader);
+
+	private:
+		vk::Device m_Device;
+		vk::PipelineCache m_PipelineCache;
+		ShaderLibrary& m_ShaderLibrary;
+		Utils::ThreadPool& m_CompilePool;
+		bool m_Created = false;
+
+		// A deque never moves its elements, so workers can hold on to their entry while new ones are added
+		std::deque<Entry> m_Entries;
+		std::unordered_map<std::uint64_t, Handle> m_HandlesByHash;
+
+		std::mutex m_PendingMutex;
+		std::condition_variable m_PendingCondition;
+		std::uint32_t m_PendingCompiles = 0;
+	};
+} // namespace Graphics
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Graphics/UniformRing.h"
+#include "Utils/Math.h"
+
+#include <vulkan.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Graphics {
+	// Matches 'InstanceConstants' in shader.vert, one instanced draw reads its models from one of these
+	struct InstanceConstants {
+	public:
+		static constexpr std::uint32_t s_MaxInstances = 255; // Keeps the block at 16 KiB, the smallest 'maxUniformBufferRange' a device may have
+
+	public:
+		Utils::Mat4 m_ProjView;
+		Utils::Mat4 m_Models[s_MaxInstances];
+	};
+
+	// Matches 'DrawConstants' in bindless.frag
+	struct DrawConstants {
+	public:
+		std::uint32_t m_TextureIndex = 0;
+		std::uint32_t m_SamplerIndex = 0;
+	};
+
+	// Everything one draw needs. Packets sharing all state but the model are merged into one instanced draw
+	struct RenderPacket {
+	public:
+		std::uint64_t m_SortKey = 0;
+
+		vk::Pipeline m_Pipeline;
+		vk::PipelineLayout m_Layout;
+		vk::DescriptorSet m_DescriptorSet; // Bound at set 0, binding 0 must be the dynamic uniform buffer holding 'InstanceConstants'
+		bool m_HasDrawConstants = false;   // Pushes 'm_DrawConstants' to the fragment stage, the layout must have a range for them
+		DrawConstants m_DrawConstants;
+
+		vk::Buffer m_VertexBuffer;
+		vk::Buffer m_IndexBuffer;
+		vk::DeviceSize m_IndexBufferOffset = 0;
+		std::uint32_t m_IndexCount         = 0;
+		std::uint32_t m_FirstIndex         = 0;
+		std::int32_t m_VertexOffset        = 0;
+
+		Utils::Mat4 m_Model = Utils::Mat4::Identity();
+	};
+
+	// Collects draw packets, sorts them by their 64 bit key and merges runs with identical state into instanced draws.
+	// Recording only binds state that differs from the previous draw, so state changes grow with pipelines, materials and meshes, not with objects.
+	// Not thread safe while building, 'record' may be called from several threads for disjoint ranges of draws.
+	struct RenderQueue {
+	public:
+		// Key layout from the most to the least significant bits: 12 bits pipeline, 16 bits material, 16 bits mesh, 20 bits depth.
+		// 'depth' is clamped to [0, 1], so packets with the same state end up next to each other sorted front to back
+		static std::uint64_t MakeSortKey(std::uint32_t pipeline, std::uint32_t material, std::uint32_t mesh, float depth);
+
+	public:
+		void clear();
+		void push(const RenderPacket& packet) { m_Packets.push_back(packet); }
+		// Sorts the packets and builds the instanced draws, must be called after the last push and before recording
+		void build();
+
+		// Records the draws in [begin, end), every draw allocates its instance constants from 'uniformRing'
+		void record(vk::CommandBuffer commandBuffer, std::size_t begin, std::size_t end, UniformRing& uniformRing, const Utils::Mat4& projView) const;
+
+		auto getPacketCount() const { return m_Packets.size(); }
+		auto getDrawCount() const { return m_Draws.size(); }
+
+	private:
+		struct SortEntry {
+		public:
+			std::uint64_t m_Key;
+			std::uint32_t m_Packet;
+		};
+
+		struct Draw {
+		public:
+			std::uint32_t m_FirstEntry;
+			std::uint32_t m_InstanceCount;
+		};
+
+	private:
+		static bool HasSameDrawConstants(const RenderPacket& lhs, const RenderPacket& rhs);
+		static bool HasSameState(const RenderPacket& lhs, const RenderPacket& rhs);
+
+		void sort();
+
+	private:
+		std::vector<RenderPacket> m_Packets;
+		std::vector<SortEntry> m_Entries;
+		std::vector<SortEntry> m_ScratchEntries;
+		std::vector<Draw> m_Draws;
+	};
+} // namespace Graphics
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Utils/MappedFile.h"
+
+#include <vulkan.hpp>
+
+#include <cstdint>
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Graphics {
+	// Layout of a shader archive: the header, 'm_EntryCount' entries, then the names and the 4 byte aligned SPIR-V blobs the entries point to
+	struct ShaderArchiveHeader {
+	public:
+		std::uint32_t m_Magic;
+		std::uint32_t m_Version;
+		std::uint32_t m_EntryCount;
+		std::uint32_t m_Reserved;
+	};
+
+	struct ShaderArchiveEntry {
+	public:
+		std::uint64_t m_NameOffset;
+		std::uint64_t m_NameSize;
+		std::uint64_t m_CodeOffset;
+		std::uint64_t m_CodeSize;
+	};
+
+	// Creates shader modules straight from memory mapped SPIR-V, either out of a single archive or from loose files in the shader directory.
+	// Modules are deduplicated by the hash of their code and owned by the library, so pipelines can share them.
+	struct ShaderLibrary {
+	public:
+		static constexpr std::uint32_t s_ArchiveMagic   = 0x41565053; // 'SPVA'
+		static constexpr std::uint32_t s_ArchiveVersion = 1;
+
+		// Packs 'files' into an archive at 'path', every entry is named after the file name. Returns false if a file can't be read or isn't SPIR-V
+		static bool WriteArchive(const std::filesystem::path& path, const std::vector<std::filesystem::path>& files);
+
+	public:
+		ShaderLibrary(vk::Device device, std::filesystem::path directory);
+		~ShaderLibrary();
+
+		void create();
+		void destroy();
+
+		// Maps the archive at 'path', its entries take precedence over loose files that are not newer than the archive. Returns false if there's no valid archive
+		bool loadArchive(const std::filesystem::path& path);
+		// Returns the module for 'name', looking it up in the archive first and the shader directory second, throws if neither has valid SPIR-V.
+		// A loose file written after the archive wins, so a stale archive never hides freshly compiled shaders
+		vk::ShaderModule getModule(std::string_view name);
+
+		auto getModuleCount() const { return m_ModulesByHash.size() + m_OrphanModules.size(); }
+		bool hasArchive() const { return m_Archive.isOpen(); }
+		bool isCreated() const { return m_Created; }
+
+	private:
+		struct Module {
+		public:
+			vk::ShaderModule m_Handle;
+			std::size_t m_CodeSize;
+		};
+
+	private:
+		static bool IsSPIRV(const std::uint8_t* code, std::size_t size);
+		static std::uint64_t Hash(const std::uint8_t* code, std::size_t size);
+
+		vk::ShaderModule createModule(const std::uint8_t* code, std::size_t size);
+
+	private:
+		vk::Device m_Device;
+		std::filesystem::path m_Directory;
+		bool m_Created = false;
+
+		Utils::MappedFile m_Archive;
+		std::filesystem::file_time_type m_ArchiveWriteTime;
+		std::unordered_map<std::string_view, std::pair<const std::uint8_t*, std::size_t>> m_ArchiveEntries; // Both point into the mapped archive
+
+		std::unordered_map<std::string, vk::ShaderModule> m_ModulesByName;
+		std::unordered_map<std::uint64_t, Module> m_ModulesByHash;
+		std::vector<vk::ShaderModule> m_OrphanModules; // Modules whose hash collided with different code
+	};
+} // namespace Graphics
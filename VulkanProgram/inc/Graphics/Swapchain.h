@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Graphics/DeletionQueue.h"
+
+#include <vulkan.hpp>
+
+#include <vk_mem_alloc.h>
+
+#include <cstdint>
+
+#include <vector>
+
+namespace Graphics {
+	// The swapchain together with its image views, depth images and framebuffers, recreatable as one unit.
+	// Recreating passes the current swapchain as 'oldSwapchain' and releases its resources to the deletion queue, so a resize never idles the device.
+	struct Swapchain {
+	public:
+		Swapchain(vk::Device device, vk::PhysicalDevice physicalDevice, VmaAllocator allocator, DeletionQueue& deletionQueue, vk::SurfaceKHR surface, std::uint32_t queueFamilyIndex);
+		~Swapchain();
+
+		// Creates the swapchain with the size of the surface, or 'extent' if the surface leaves it up to the swapchain. Returns false if the surface has no area
+		bool create(vk::SurfaceFormatKHR surfaceFormat, vk::PresentModeKHR presentMode, vk::Format depthFormat, vk::RenderPass renderPass, vk::Extent2D extent);
+		// Replaces the swapchain with one created from it, the old resources are destroyed once the frames already submitted to them have completed.
+		// Returns false and keeps the current swapchain if the surface has no area, e.g. while the window is minimized
+		bool recreate(vk::Extent2D extent);
+		// Destroys the swapchain immediately, nothing may still use it
+		void destroy();
+
+		// Acquires the next image, returns the result instead of throwing so out of date swapchains can be handled
+		vk::Result acquire(vk::Semaphore signalSemaphore, std::uint32_t& imageIndex);
+		// Presents 'imageIndex' after 'waitSemaphore', returns the result instead of throwing so out of date swapchains can be handled
+		vk::Result present(vk::Queue queue, vk::Semaphore waitSemaphore, std::uint32_t imageIndex);
+
+		auto getHandle() const { return m_Current.m_Swapchain; }
+		auto getExtent() const { return m_Extent; }
+		auto getFormat() const { return m_SurfaceFormat.format; }
+		auto getImageCount() const { return static_cast<std::uint32_t>(m_Current.m_Images.size()); }
+		auto getFramebuffer(std::uint32_t index) const { return m_Current.m_Framebuffers[index]; }
+		bool isCreated() const { return m_Current.m_Swapchain; }
+
+	private:
+		struct Generation {
+		public:
+			vk::SwapchainKHR m_Swapchain = nullptr;
+			std::vector<vk::Image> m_Images;
+			std::vector<vk::ImageView> m_ImageViews;
+			std::vector<vk::Image> m_DepthImages;
+			std::vector<VmaAllocation> m_DepthImageAllocations;
+			std::vector<vk::ImageView> m_DepthImageViews;
+			std::vector<vk::Framebuffer> m_Framebuffers;
+		};
+
+	private:
+		// Returns the extent the swapchain has to use, or a zero extent if the surface currently has no area
+		vk::Extent2D chooseExtent(const vk::SurfaceCapabilitiesKHR& capabilities, vk::Extent2D extent) const;
+		void createGeneration(Generation& generation, vk::Extent2D extent, vk::SwapchainKHR oldSwapchain);
+		void destroyGeneration(Generation& generation);
+		void releaseGeneration(Generation& generation);
+
+	private:
+		vk::Device m_Device;
+		vk::PhysicalDevice m_PhysicalDevice;
+		VmaAllocator m_Allocator;
+		DeletionQueue& m_DeletionQueue;
+		vk::SurfaceKHR m_Surface;
+		std::uint32_t m_QueueFamilyIndex;
+
+		vk::SurfaceFormatKHR m_SurfaceFormat = {};
+		vk::PresentModeKHR m_PresentMode     = vk::PresentModeKHR::eFifo;
+		vk::Format m_DepthFormat             = vk::Format::eUndefined;
+		vk::RenderPass m_RenderPass          = nullptr;
+		vk::Extent2D m_Extent                = {};
+
+		Generation m_Current;
+	};
+} // namespace Graphics
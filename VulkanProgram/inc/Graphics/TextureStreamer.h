@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Graphics/UploadManager.h"
+#include "Utils/ThreadPool.h"
+
+#include <vulkan.hpp>
+
+#include <vk_mem_alloc.h>
+
+#include <cstdint>
+
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+namespace Graphics {
+	enum class TextureState {
+		Decoding,
+		Uploading,
+		Transferring,
+		Resident,
+		Failed
+	};
+
+	// Loads textures as a pipeline: files are decoded and mipmapped on worker threads, the mips are streamed through the upload manager under a per update byte budget,
+	// and the texture becomes resident once the graphics queue has acquired its last upload. Not thread safe, all calls must come from the same thread.
+	struct TextureStreamer {
+	public:
+		TextureStreamer(vk::Device device, VmaAllocator allocator, UploadManager& uploadManager, Utils::ThreadPool& decodePool, vk::DeviceSize uploadBudget);
+		~TextureStreamer();
+
+		void create();
+		void destroy();
+
+		// Queues 'path' for decoding, returns the id of the texture
+		std::uint32_t request(std::filesystem::path path);
+		// Creates images for decoded textures, uploads mips until the budget is spent and promotes finished textures to resident
+		void update();
+
+		// Returns the view of a resident texture, or a null handle while it is still streaming
+		vk::ImageView getImageView(std::uint32_t id) const { return m_Textures[id].m_State == TextureState::Resident ? m_Textures[id].m_ImageView : nullptr; }
+		auto getState(std::uint32_t id) const { return m_Textures[id].m_State; }
+		auto getTextureCount() const { return static_cast<std::uint32_t>(m_Textures.size()); }
+		auto getResidentCount() const { return m_ResidentCount; }
+		// Textures which are not yet resident or failed
+		std::uint32_t getPendingCount() const { return static_cast<std::uint32_t>(m_Textures.size()) - m_ResidentCount - m_FailedCount; }
+		bool isCreated() const { return m_Created; }
+
+	private:
+		struct DecodedTexture {
+		public:
+			std::uint32_t m_Id;
+			std::uint32_t m_Width;
+			std::uint32_t m_Height;
+			std::vector<std::uint8_t> m_Pixels; // Every mip level tightly packed after each other, largest first
+			std::vector<vk::DeviceSize> m_MipOffsets;
+		};
+
+		struct Texture {
+		public:
+			std::filesystem::path m_Path;
+			TextureState m_State = TextureState::Decoding;
+
+			vk::Image m_Image               = nullptr;
+			VmaAllocation m_ImageAllocation = nullptr;
+			vk::ImageView m_ImageView       = nullptr;
+
+			DecodedTexture m_Decoded;
+			std::uint32_t m_NextMip  = 0;
+			std::uint64_t m_BatchId  = 0;
+			std::uint32_t m_MipCount = 0;
+		};
+
+	private:
+		static void Decode(DecodedTexture& decoded, const std::filesystem::path& path);
+
+		void createImage(Texture& texture);
+
+	private:
+		vk::Device m_Device;
+		VmaAllocator m_Allocator;
+		UploadManager& m_UploadManager;
+		Utils::ThreadPool& m_DecodePool;
+		vk::DeviceSize m_UploadBudget;
+
+		std::vector<Texture> m_Textures;
+		std::vector<std::uint32_t> m_UploadQueue; // Textures with an image that still have mips to upload, uploaded in order
+		std::vector<std::uint32_t> m_Transferring;
+		std::uint32_t m_ResidentCount = 0;
+		std::uint32_t m_FailedCount   = 0;
+		bool m_Created                = false;
+
+		// Shared with the decode jobs
+		std::mutex m_DecodedMutex;
+		std::condition_variable m_DecodedCondition;
+		std::vector<DecodedTexture> m_Decoded;
+		std::uint32_t m_PendingDecodes = 0;
+	};
+} // namespace Graphics
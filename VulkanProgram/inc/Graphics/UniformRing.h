@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vulkan.hpp>
+
+#include <vk_mem_alloc.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace Graphics {
+	struct UniformAllocation {
+	public:
+		void* m_Data           = nullptr;
+		std::uint32_t m_Offset = 0; // Dynamic offset into the ring buffer
+	};
+
+	// Linear allocator for transient shader constants, backed by one persistently mapped buffer split into a region per frame in flight.
+	// Allocating is a single atomic bump, so recording threads can allocate concurrently. Everything is bound through one 'eUniformBufferDynamic' descriptor.
+	// 'bindingRange' is the range of that descriptor, the buffer is padded so it stays within the buffer at any offset handed out.
+	struct UniformRing {
+	public:
+		UniformRing(vk::PhysicalDevice physicalDevice, VmaAllocator allocator, vk::DeviceSize frameSize, std::uint32_t framesInFlight, vk::DeviceSize bindingRange = 0);
+		~UniformRing();
+
+		void create();
+		void destroy();
+
+		// Starts allocating from the region of 'frame', the GPU must have finished the last frame that used it
+		void beginFrame(std::uint32_t frame);
+		// Makes the allocations of the current frame visible to the GPU, must be called after recording and before the frame is submitted
+		void flush();
+
+		// Returns 'size' bytes aligned to the device's uniform buffer offset alignment, throws if the frame region is exhausted
+		UniformAllocation allocate(vk::DeviceSize size);
+		// Copies 'value' into a new allocation and returns its dynamic offset
+		template <class T>
+		std::uint32_t push(const T& value) {
+			auto allocation = allocate(sizeof(T));
+			std::memcpy(allocation.m_Data, &value, sizeof(T));
+			return allocation.m_Offset;
+		}
+
+		vk::DeviceSize getAlignedSize(vk::DeviceSize size) const { return (size + m_Alignment - 1) / m_Alignment * m_Alignment; }
+		auto getBuffer() const { return m_Buffer; }
+		auto getFrameSize() const { return m_FrameSize; }
+		// Bytes allocated in the current frame region so far
+		vk::DeviceSize getFrameUsage() const { return std::min<vk::DeviceSize>(m_Head.load(std::memory_order_relaxed), m_FrameSize); }
+		bool isCreated() const { return m_Buffer; }
+
+	private:
+		vk::PhysicalDevice m_PhysicalDevice;
+		VmaAllocator m_Allocator;
+		vk::DeviceSize m_FrameSize;
+		std::uint32_t m_FramesInFlight;
+		vk::DeviceSize m_BindingRange;
+
+		vk::Buffer m_Buffer              = nullptr;
+		VmaAllocation m_BufferAllocation = nullptr;
+		std::uint8_t* m_Data             = nullptr;
+		vk::DeviceSize m_Alignment       = 256;
+
+		std::uint32_t m_CurrentFrame       = 0;
+		std::atomic<vk::DeviceSize> m_Head = 0;
+	};
+} // namespace Graphics
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <vulkan.hpp>
+
+#include <vk_mem_alloc.h>
+
+#include <cstdint>
+
+#include <deque>
+#include <vector>
+
+namespace Graphics {
+	// Streams buffer and image data to the GPU through a persistently mapped staging ring on the transfer queue.
+	// Uploads are batched into one submission per 'flush', which signals a semaphore the next graphics submission waits on.
+	// When the transfer queue family differs from the graphics one, ownership is released on the transfer queue and acquired again in 'acquire'.
+	// Not thread safe, all calls must come from the same thread.
+	struct UploadManager {
+	public:
+		UploadManager(vk::Device device, VmaAllocator allocator, vk::Queue transferQueue, std::uint32_t transferFamilyIndex, std::uint32_t graphicsFamilyIndex, vk::DeviceSize stagingSize);
+		~UploadManager();
+
+		void create();
+		void destroy();
+
+		// Copies 'size' bytes from 'data' into the staging ring and records a copy into 'buffer', uploads larger than the ring are split
+		void uploadBuffer(vk::Buffer buffer, vk::DeviceSize offset, const void* data, vk::DeviceSize size, vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess);
+		// Copies one subresource worth of tightly packed texels into 'image', which ends up in 'finalLayout'. 2D subresources larger than the ring are split into slabs of rows
+		void uploadImage(vk::Image image, vk::ImageSubresourceLayers subresource, vk::Extent3D extent, const void* data, vk::DeviceSize size, vk::ImageLayout finalLayout, vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess);
+
+		// Submits every upload recorded since the last flush in one submission, returns the id of that batch
+		std::uint64_t flush();
+		// Records the acquire side of the ownership transfers of every flushed batch into 'commandBuffer', which must be outside of a render pass.
+		// Appends the semaphores the submission of 'commandBuffer' has to wait on, 'frameSerial' identifies the frame that submits it.
+		void acquire(vk::CommandBuffer commandBuffer, std::uint64_t frameSerial, std::vector<vk::Semaphore>& waitSemaphores, std::vector<vk::PipelineStageFlags>& waitStages);
+		// Reclaims staging memory of finished transfers and recycles batches whose acquiring frame has finished
+		void collect(std::uint64_t completedFrameSerial);
+
+		// Uploads of a batch can be used by any command recorded after the 'acquire' call that picked the batch up
+		bool isAvailable(std::uint64_t batchId) const { return batchId <= m_LastAcquiredBatchId; }
+		bool hasPendingUploads() const { return m_Recording; }
+		auto getUploadedBytes() const { return m_UploadedBytes; }
+		auto getStagingSize() const { return m_StagingSize; }
+		bool isDedicatedTransferQueue() const { return m_TransferFamilyIndex != m_GraphicsFamilyIndex; }
+		bool isCreated() const { return m_CommandPool; }
+
+	private:
+		struct Batch {
+		public:
+			vk::CommandBuffer m_CommandBuffer = nullptr;
+			vk::Fence m_Fence                 = nullptr;
+			vk::Semaphore m_Semaphore         = nullptr;
+
+			std::uint64_t m_Id                 = 0;
+			std::uint64_t m_RingEnd            = 0;
+			std::uint64_t m_AcquireFrameSerial = 0;
+			bool m_TransferComplete            = false;
+			bool m_Acquired                    = false;
+
+			vk::PipelineStageFlags m_DstStages;
+			std::vector<vk::BufferMemoryBarrier> m_AcquireBufferBarriers;
+			std::vector<vk::ImageMemoryBarrier> m_AcquireImageBarriers;
+		};
+
+	private:
+		// Starts recording a batch if none is, and adds 'dstStage' to the stages the graphics submission waits at for it.
+		// Allocating staging memory can flush the batch, so every command is recorded right after calling this
+		void beginBatch(vk::PipelineStageFlags dstStage);
+		// Returns the offset into the staging ring, blocks on the oldest transfer if the ring is full
+		vk::DeviceSize allocateStaging(vk::DeviceSize size, vk::DeviceSize alignment);
+		void retireTransfers(bool wait);
+
+	private:
+		vk::Device m_Device;
+		VmaAllocator m_Allocator;
+		vk::Queue m_TransferQueue;
+		std::uint32_t m_TransferFamilyIndex;
+		std::uint32_t m_GraphicsFamilyIndex;
+		vk::DeviceSize m_StagingSize;
+
+		vk::Buffer m_StagingBuffer              = nullptr;
+		VmaAllocation m_StagingBufferAllocation = nullptr;
+		std::uint8_t* m_StagingData             = nullptr;
+		vk::CommandPool m_CommandPool           = nullptr;
+
+		// Monotonic ring positions, the actual offset is the position modulo the staging size
+		std::uint64_t m_RingHead = 0;
+		std::uint64_t m_RingTail = 0;
+
+		Batch m_CurrentBatch;
+		bool m_Recording = false;
+		std::deque<Batch> m_InFlightBatches;
+		std::vector<Batch> m_FreeBatches;
+
+		std::uint64_t m_NextBatchId         = 1;
+		std::uint64_t m_LastAcquiredBatchId = 0;
+		std::uint64_t m_UploadedBytes       = 0;
+	};
+} // namespace Graphics
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Graphics/PipelineCompiler.h"
+#include "Utils/VertexLayout.h"
+
+#include <vulkan.hpp>
+
+#include <cstdint>
+
+#include <initializer_list>
+
+namespace Graphics {
+	// Builds the vertex input of a pipeline from a vertex layout, every attribute is read at the location of its semantic.
+	// Quantized encodings are expanded by the vertex input, so one vertex shader reads every layout as long as positions are dequantized by its model matrix
+	struct VertexInput {
+	public:
+		static vk::Format GetFormat(Utils::VertexEncoding encoding);
+		// Reads 'layout' from 'binding' into the inputs in 'semantics', which have to be the ones the vertex shader of 'desc' declares. Throws if the layout lacks one of them
+		static void Apply(GraphicsPipelineDesc& desc, const Utils::VertexLayout& layout, std::uint32_t binding, std::initializer_list<Utils::VertexSemantic> semantics);
+	};
+} // namespace Graphics
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Utils {
+	struct ProfileEvent {
+	public:
+		const char* m_Name;    // Must outlive the profiler, zones are named with string literals
+		std::uint64_t m_Start; // Nanoseconds since the profiler was first used
+		std::uint64_t m_End;
+	};
+
+	// Zones of one thread. The first 's_FirstCapacity' zones are kept for good, so startup survives long runs, after that a ring keeps the most recent 's_Capacity'.
+	// Only the owning thread writes, so pushing is a plain store and one release of the head
+	struct ProfileThreadBuffer {
+	public:
+		static constexpr std::size_t s_FirstCapacity = 1024;
+		static constexpr std::size_t s_Capacity      = 16384;
+
+	public:
+		ProfileThreadBuffer(std::uint32_t threadId) : m_ThreadId(threadId) { }
+
+		void push(const ProfileEvent& event) {
+			std::uint64_t head = m_Head.load(std::memory_order_relaxed);
+			if (head < s_FirstCapacity)
+				m_FirstEvents[head] = event;
+			else
+				m_Events[(head - s_FirstCapacity) % s_Capacity] = event;
+			m_Head.store(head + 1, std::memory_order_release);
+		}
+
+		// Zones overwritten in the ring so far
+		std::uint64_t getDroppedCount() const {
+			std::uint64_t head = m_Head.load(std::memory_order_acquire);
+			return head > s_FirstCapacity + s_Capacity ? head - s_FirstCapacity - s_Capacity : 0;
+		}
+
+	public:
+		std::uint32_t m_ThreadId;
+		std::string m_Name;
+		std::array<ProfileEvent, s_FirstCapacity> m_FirstEvents;
+		std::array<ProfileEvent, s_Capacity> m_Events;
+		std::atomic<std::uint64_t> m_Head = 0;
+	};
+
+	// Collects timed zones from every thread into per thread rings and exports them as a Chrome trace.
+	// Recording never locks, a thread only takes the registry lock the first time it records anything.
+	struct CPUProfiler {
+	public:
+		static CPUProfiler& Get();
+		// Nanoseconds since the profiler was first used
+		static std::uint64_t Now();
+
+	public:
+		void record(const char* name, std::uint64_t start, std::uint64_t end) { getThreadBuffer().push({ name, start, end }); }
+		// Names the calling thread in the trace
+		void setThreadName(std::string name) { getThreadBuffer().m_Name = std::move(name); }
+
+		// Writes the zones kept by every thread in the Chrome trace event format, threads should not be recording while this runs
+		bool writeTrace(const std::filesystem::path& path);
+		// Zones of every thread that were overwritten before they could be written
+		std::uint64_t getDroppedCount();
+
+	private:
+		CPUProfiler() = default;
+
+		ProfileThreadBuffer& getThreadBuffer();
+
+	private:
+		std::mutex m_Mutex;
+		std::vector<std::unique_ptr<ProfileThreadBuffer>> m_Buffers; // Never shrinks, so threads can keep a pointer to their own buffer
+	};
+
+	// Records the time between its construction and destruction as one zone
+	struct ProfileZone {
+	public:
+		ProfileZone(const char* name) : m_Name(name), m_Start(CPUProfiler::Now()) { }
+		ProfileZone(const ProfileZone&) = delete;
+		~ProfileZone() { CPUProfiler::Get().record(m_Name, m_Start, CPUProfiler::Now()); }
+
+		ProfileZone& operator=(const ProfileZone&) = delete;
+
+	private:
+		const char* m_Name;
+		std::uint64_t m_Start;
+	};
+} // namespace Utils
+
+// Zones compile to nothing in Dist builds
+#ifdef _DIST
+	#define PROFILE_ZONE(name)
+	#define PROFILE_THREAD(name)
+#else
+	#define PROFILE_CONCAT_IMPL(a, b) a##b
+	#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+	// Times the rest of the enclosing scope, 'name' must be a string literal
+	#define PROFILE_ZONE(name) ::Utils::ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+	#define PROFILE_THREAD(name) ::Utils::CPUProfiler::Get().setThreadName(name)
+#endif
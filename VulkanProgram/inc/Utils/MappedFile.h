@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <filesystem>
+
+namespace Utils {
+	// Read only memory mapping of a whole file. The mapping starts on a page boundary, so the data is aligned for any scalar type
+	struct MappedFile {
+	public:
+		MappedFile() = default;
+		MappedFile(const std::filesystem::path& path);
+		MappedFile(const MappedFile&) = delete;
+		MappedFile(MappedFile&& move) noexcept;
+		~MappedFile();
+
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&& move) noexcept;
+
+		// Maps 'path', closing the previous mapping first. Returns false if the file doesn't exist, is empty or can't be mapped
+		bool open(const std::filesystem::path& path);
+		void close();
+
+		auto getData() const { return m_Data; }
+		auto getSize() const { return m_Size; }
+		bool isOpen() const { return m_Data; }
+
+	private:
+		const std::uint8_t* m_Data = nullptr;
+		std::size_t m_Size         = 0;
+
+#if _WIN32
+		void* m_FileHandle    = nullptr;
+		void* m_MappingHandle = nullptr;
+#endif
+	};
+} // namespace Utils
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cmath>
+
+namespace Utils {
+	// Column major 4x4 matrix, matching the memory layout of a GLSL 'mat4' in a std140 block
+	struct Mat4 {
+	public:
+		static Mat4 Identity() {
+			return { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } };
+		}
+
+		static Mat4 ScaleTranslation(const float scale[3], const float translation[3]) {
+			return { { scale[0], 0.0f, 0.0f, 0.0f, 0.0f, scale[1], 0.0f, 0.0f, 0.0f, 0.0f, scale[2], 0.0f, translation[0], translation[1], translation[2], 1.0f } };
+		}
+
+		// Right handed perspective projection looking down -z into Vulkan clip space, with y pointing down and depth in [0, 1]
+		static Mat4 Perspective(float fovY, float aspect, float nearZ, float farZ) {
+			float f = 1.0f / std::tan(fovY * 0.5f);
+			return { { f / aspect, 0.0f, 0.0f, 0.0f, 0.0f, -f, 0.0f, 0.0f, 0.0f, 0.0f, farZ / (nearZ - farZ), -1.0f, 0.0f, 0.0f, nearZ * farZ / (nearZ - farZ), 0.0f } };
+		}
+
+		// Right handed view matrix of a camera at 'eye' looking at 'target'
+		static Mat4 LookAt(const float eye[3], const float target[3], const float up[3]) {
+			float f[3] = { target[0] - eye[0], target[1] - eye[1], target[2] - eye[2] };
+			Normalize(f);
+			float s[3] = { f[1] * up[2] - f[2] * up[1], f[2] * up[0] - f[0] * up[2], f[0] * up[1] - f[1] * up[0] };
+			Normalize(s);
+			float u[3] = { s[1] * f[2] - s[2] * f[1], s[2] * f[0] - s[0] * f[2], s[0] * f[1] - s[1] * f[0] };
+			return { { s[0], u[0], -f[0], 0.0f, s[1], u[1], -f[1], 0.0f, s[2], u[2], -f[2], 0.0f, -Dot(s, eye), -Dot(u, eye), Dot(f, eye), 1.0f } };
+		}
+
+		friend Mat4 operator*(const Mat4& lhs, const Mat4& rhs) {
+			Mat4 result;
+			for (int column = 0; column < 4; ++column) {
+				for (int row = 0; row < 4; ++row) {
+					float sum = 0.0f;
+					for (int i = 0; i < 4; ++i)
+						sum += lhs.m_Values[i * 4 + row] * rhs.m_Values[column * 4 + i];
+					result.m_Values[column * 4 + row] = sum;
+				}
+			}
+			return result;
+		}
+
+	public:
+		float m_Values[16];
+
+	private:
+		static float Dot(const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+		static void Normalize(float v[3]) {
+			float length = std::sqrt(Dot(v, v));
+			if (length > 0.0f)
+				for (int i = 0; i < 3; ++i) v[i] /= length;
+		}
+	};
+} // namespace Utils
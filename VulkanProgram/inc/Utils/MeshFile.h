@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Utils/MappedFile.h"
+#include "Utils/VertexLayout.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <filesystem>
+#include <vector>
+
+namespace Utils {
+	// Layout of a mesh file: the header, the submesh table, then the vertices and the 32 bit indices, every section starts 's_SectionAlignment' aligned.
+	// The vertices are stored exactly as the GPU reads them. Every level of detail is a set of submeshes indexing the same vertices, the submesh table holds
+	// 'm_LODCount' levels of 'm_SubmeshCount' submeshes each, full detail first, and the submeshes of a level are consecutive in the index section
+	struct MeshFileHeader {
+	public:
+		std::uint32_t m_Magic;
+		std::uint32_t m_Version;
+		std::uint32_t m_VertexLayout; // 'VertexLayout::pack()'
+		std::uint32_t m_VertexStride;
+		std::uint32_t m_VertexCount;
+		std::uint32_t m_IndexCount;
+		std::uint32_t m_SubmeshCount;
+		std::uint32_t m_LODCount;
+		std::uint64_t m_SubmeshOffset;
+		std::uint64_t m_VertexOffset;
+		std::uint64_t m_IndexOffset;
+		float m_BoundingSphere[4]; // Center and radius, so the loader never has to look at the vertices
+		VertexQuantization m_Quantization;
+	};
+
+	// Indices of a submesh are relative to the first vertex of the mesh
+	struct MeshFileSubmesh {
+	public:
+		std::uint32_t m_FirstIndex;
+		std::uint32_t m_IndexCount;
+		float m_Error = 0.0f; // Largest distance from the full detail surface in model units, 0 at full detail
+	};
+
+	// Memory mapped mesh file, the vertex and index sections can be handed to the upload path as they are without parsing or copying.
+	// Only the header and the submesh table are validated, the file is expected to come from the mesh cooker.
+	struct MeshFile {
+	public:
+		static constexpr std::uint32_t s_Magic            = 0x4853454D; // 'MESH'
+		static constexpr std::uint32_t s_Version          = 3;
+		static constexpr std::uint64_t s_SectionAlignment = 256;
+
+		// Writes a mesh file atomically, 'vertices' holds 'vertexCount' vertices encoded with 'layout' and 'quantization'.
+		// 'submeshes' holds 'lodCount' levels of detail with the same number of submeshes each, full detail first
+		static bool Write(const std::filesystem::path& path, const VertexLayout& layout, const VertexQuantization& quantization, const void* vertices, std::uint32_t vertexCount, const std::vector<std::uint32_t>& indices, const std::vector<MeshFileSubmesh>& submeshes, std::uint32_t lodCount, const float boundingSphere[4]);
+
+	public:
+		MeshFile() = default;
+		MeshFile(const std::filesystem::path& path);
+		MeshFile(const MeshFile&) = delete;
+
+		MeshFile& operator=(const MeshFile&) = delete;
+
+		// Maps 'path', returns false if it isn't a mesh file of this version or any section lies outside of it
+		bool open(const std::filesystem::path& path);
+		void close();
+
+		auto& getHeader() const { return *m_Header; }
+		// Submeshes of level of detail 'lod', 0 being full detail
+		auto getSubmeshes(std::uint32_t lod = 0) const { return m_Submeshes + static_cast<std::size_t>(lod) * m_Header->m_SubmeshCount; }
+		auto getSubmeshCount() const { return m_Header->m_SubmeshCount; }
+		auto getLODCount() const { return m_Header->m_LODCount; }
+		// Every submesh of level 'lod' as one range, with the largest error among them
+		MeshFileSubmesh getLOD(std::uint32_t lod) const;
+		auto getVertexLayout() const { return VertexLayout::Unpack(m_Header->m_VertexLayout); }
+		const std::uint8_t* getVertexData() const { return m_File.getData() + m_Header->m_VertexOffset; }
+		std::size_t getVertexDataSize() const { return static_cast<std::size_t>(m_Header->m_VertexCount) * m_Header->m_VertexStride; }
+		const std::uint8_t* getIndexData() const { return m_File.getData() + m_Header->m_IndexOffset; }
+		std::size_t getIndexDataSize() const { return static_cast<std::size_t>(m_Header->m_IndexCount) * sizeof(std::uint32_t); }
+		bool isOpen() const { return m_Header; }
+
+	private:
+		MappedFile m_File;
+		const MeshFileHeader* m_Header     = nullptr; // Points into the mapping, which is page aligned
+		const MeshFileSubmesh* m_Submeshes = nullptr;
+	};
+} // namespace Utils
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+namespace Utils {
+	// Post-transform vertex cache behaviour of an index buffer, simulated with a FIFO cache
+	struct VertexCacheStatistics {
+	public:
+		std::uint32_t m_Misses = 0;
+		float m_ACMR           = 0.0f; // Average cache miss ratio, transformed vertices per triangle, 0.5 at best and 3 at worst
+		float m_ATVR           = 0.0f; // Average transformed vertex ratio, transformed vertices per referenced vertex, 1 at best
+	};
+
+	// Reorders triangle lists and their vertices so the GPU transforms and fetches fewer vertices and shades fewer hidden pixels.
+	// The passes are meant to run offline in this order: vertex cache, overdraw, then vertex fetch. The first two only move whole triangles, so they can run per submesh
+	struct MeshOptimizer {
+	public:
+		// Size of the FIFO cache statistics and cluster boundaries are simulated with, close to what current GPUs reuse between triangles
+		static constexpr std::uint32_t s_FIFOCacheSize = 16;
+		// Size of the LRU cache the vertex cache pass optimizes for, larger than the hardware so the order stays good for any smaller cache
+		static constexpr std::uint32_t s_LRUCacheSize = 32;
+
+		static VertexCacheStatistics AnalyzeVertexCache(const std::uint32_t* indices, std::size_t indexCount, std::uint32_t vertexCount, std::uint32_t cacheSize = s_FIFOCacheSize);
+
+		// Reorders the triangles for post-transform vertex cache locality with Tom Forsyth's linear-speed algorithm
+		static void OptimizeVertexCache(std::uint32_t* indices, std::size_t indexCount, std::uint32_t vertexCount);
+		// Splits the triangles into clusters where the vertex cache restarts anyway, or where splitting keeps the cluster's ACMR within 'threshold' times of what it was.
+		// The clusters are then sorted so the ones facing away from the center of the mesh draw first, occluding the rest. Expects a vertex cache optimized order.
+		// 'positions' points to the first position, three floats every 'positionStride' bytes
+		static void OptimizeOverdraw(std::uint32_t* indices, std::size_t indexCount, const float* positions, std::size_t positionStride, std::uint32_t vertexCount, float threshold);
+		// Renumbers the vertices in the order the indices first reference them, so vertex fetch walks memory linearly. Rewrites 'indices' and fills 'remap' with the
+		// new index of every old vertex, ~0U for vertices no index references. Returns the number of referenced vertices
+		static std::uint32_t OptimizeVertexFetch(std::uint32_t* indices, std::size_t indexCount, std::uint32_t vertexCount, std::vector<std::uint32_t>& remap);
+	};
+} // namespace Utils
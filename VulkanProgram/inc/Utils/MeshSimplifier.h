@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Utils {
+	// Simplifies triangle lists by collapsing edges ordered by their quadric error, after Garland and Heckbert.
+	// Vertices are only ever collapsed onto other existing vertices, so every level of detail indexes the same vertices and only needs an index buffer of its own.
+	// Vertices sharing a position with another vertex, such as on texture seams, never move so the seams don't tear, and border vertices only move along the border
+	struct MeshSimplifier {
+	public:
+		// Border edges weigh this much more than the surface, so open meshes keep their outline
+		static constexpr double s_BorderWeight = 10.0;
+
+		// Writes at most 'indexCount' indices to 'destination' that aim for 'targetIndexCount', stopping early if nothing more can be collapsed.
+		// 'positions' points to the first position, three floats every 'positionStride' bytes. Returns the index count and sets 'error' to the largest distance,
+		// in position units, between the result and the original surface as estimated by the quadrics
+		static std::size_t Simplify(std::uint32_t* destination, const std::uint32_t* indices, std::size_t indexCount, const float* positions, std::size_t positionStride, std::uint32_t vertexCount, std::size_t targetIndexCount, float& error);
+	};
+} // namespace Utils
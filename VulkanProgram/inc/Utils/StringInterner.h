@@ -0,0 +1,30 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Utils {
+	// Stores every distinct string once and hands out a stable, null terminated pointer to it, so interned strings compare and hash by pointer.
+	// Thread safe, interned strings live until the program exits.
+	struct StringInterner {
+	public:
+		static StringInterner& Get();
+
+	public:
+		// Returns the interned copy of 'string', adding it if it's new
+		const char* intern(std::string_view string);
+		// Returns the interned copy of 'string', or nullptr if it was never interned, in which case nothing can be keyed by it
+		const char* find(std::string_view string) const;
+
+	private:
+		StringInterner() = default;
+
+	private:
+		mutable std::mutex m_Mutex;
+		std::deque<std::string> m_Strings; // Never moves its strings when growing, so their data stays where it is
+		std::unordered_map<std::string_view, const char*> m_Lookup;
+	};
+} // namespace Utils
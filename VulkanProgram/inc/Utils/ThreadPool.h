@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Utils {
+	struct ThreadPool {
+	public:
+		static std::size_t GetHardwareThreadCount();
+
+	public:
+		// Workers are named 'name' followed by their index in CPU traces
+		ThreadPool(std::size_t workerCount, std::string name = "Worker");
+		~ThreadPool();
+
+		// Queues a job to run on any worker thread
+		void submit(std::function<void()> job);
+		// Runs 'job' for every index in [0, count) spread over the workers and the calling thread, returns once every index has finished.
+		// The calling thread keeps taking indices itself, so this never deadlocks even if every worker is busy with other jobs.
+		void parallelFor(std::size_t count, const std::function<void(std::size_t)>& job);
+
+		auto getWorkerCount() const { return m_Workers.size(); }
+
+	private:
+		void workerMain(std::size_t index);
+
+	private:
+		std::string m_Name;
+		std::vector<std::thread> m_Workers;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		std::deque<std::function<void()>> m_Jobs;
+		bool m_Stop = false;
+	};
+} // namespace Utils
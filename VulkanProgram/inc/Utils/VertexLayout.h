@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Utils/Math.h"
+
+#include <cstdint>
+
+namespace Utils {
+	// What an attribute means, doubles as the shader input location
+	enum class VertexSemantic : std::uint32_t {
+		Position = 0,
+		UV       = 1,
+		Count
+	};
+
+	// How an attribute is stored. Every encoding is one the vertex input expands to floats, so shaders read vec2 to vec4 whatever the encoding
+	enum class VertexEncoding : std::uint32_t {
+		None = 0,
+		Float32x2,
+		Float32x3,
+		Float32x4,
+		Float16x2,
+		Unorm16x4 // Position in the bounding box of the mesh, the fourth component is always 1
+	};
+
+	// Maps the stored position back to model space, 'position * m_Scale + m_Offset'. Identity for unquantized positions
+	struct VertexQuantization {
+	public:
+		static VertexQuantization FromBounds(const float min[3], const float max[3]);
+
+	public:
+		// Folded into the model matrix, so the vertex shader never sees quantized positions
+		Mat4 getMatrix() const { return Mat4::ScaleTranslation(m_Scale, m_Offset); }
+
+	public:
+		float m_Offset[3] = { 0.0f, 0.0f, 0.0f };
+		float m_Scale[3]  = { 1.0f, 1.0f, 1.0f };
+	};
+
+	// A vertex before it is encoded
+	struct VertexAttributes {
+	public:
+		float m_Position[3] = {};
+		float m_UV[2]       = {};
+	};
+
+	// Encoding of every attribute of an interleaved vertex, attributes are stored in semantic order and all of them are 4 byte aligned.
+	// The one description the mesh cooker encodes with, the mesh file stores and the pipeline vertex input is built from
+	struct VertexLayout {
+	public:
+		// 32 bit floats, what the built-in geometry uses, 24 bytes
+		static VertexLayout Standard();
+		// 16 bit positions in the bounding box and half float texture coordinates, 12 bytes
+		static VertexLayout Quantized();
+		// Returns a layout without a position if 'packed' isn't a valid layout
+		static VertexLayout Unpack(std::uint32_t packed);
+		static std::uint32_t GetEncodingSize(VertexEncoding encoding);
+
+	public:
+		std::uint32_t pack() const;
+
+		// Writes 'attributes' to 'destination', which must hold 'getStride()' bytes
+		void encode(const VertexAttributes& attributes, const VertexQuantization& quantization, void* destination) const;
+
+		VertexEncoding getEncoding(VertexSemantic semantic) const { return m_Encodings[static_cast<std::uint32_t>(semantic)]; }
+		std::uint32_t getOffset(VertexSemantic semantic) const;
+		std::uint32_t getStride() const;
+		bool hasAttribute(VertexSemantic semantic) const { return getEncoding(semantic) != VertexEncoding::None; }
+		bool isValid() const;
+
+		bool operator==(const VertexLayout& other) const = default;
+
+	public:
+		VertexEncoding m_Encodings[static_cast<std::uint32_t>(VertexSemantic::Count)] = {};
+	};
+} // namespace Utils
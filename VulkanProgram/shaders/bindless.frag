@@ -0,0 +1,18 @@
+#version 460
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec2 inUV;
+
+layout(location = 0) out vec4 outColor;
+
+layout(set = 1, binding = 0) uniform texture2D textures[];
+layout(set = 1, binding = 1) uniform sampler samplers[];
+
+layout(push_constant) uniform DrawConstants {
+	uint textureIndex;
+	uint samplerIndex;
+} draw;
+
+void main() {
+	outColor = texture(sampler2D(textures[draw.textureIndex], samplers[draw.samplerIndex]), inUV);
+}
\ No newline at end of file
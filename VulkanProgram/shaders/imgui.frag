@@ -0,0 +1,12 @@
+#version 460
+
+layout(location = 0) in vec2 inUV;
+layout(location = 1) in vec4 inColor;
+
+layout(location = 0) out vec4 outColor;
+
+layout(set = 0, binding = 0) uniform sampler2D fontSampler;
+
+void main() {
+	outColor = inColor * texture(fontSampler, inUV);
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#version 460
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec2 inUV;
+layout(location = 2) in vec4 inColor;
+
+layout(location = 0) out vec2 outUV;
+layout(location = 1) out vec4 outColor;
+
+layout(push_constant) uniform PushConstants {
+	vec2 scale;
+	vec2 translate;
+} constants;
+
+void main() {
+	gl_Position = vec4(inPosition * constants.scale + constants.translate, 0.0, 1.0);
+	outUV = inUV;
+	outColor = inColor;
+}
\ No newline at end of file
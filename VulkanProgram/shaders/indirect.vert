@@ -0,0 +1,29 @@
+#version 460
+
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inUV;
+
+layout(location = 0) out vec2 outUV;
+
+layout(set = 0, binding = 0) uniform FrameConstants {
+	mat4 projView;
+} frame;
+
+struct Object {
+	mat4 model;
+	vec4 boundingSphere;
+	uint firstLOD;
+	uint lodCount;
+	int vertexOffset;
+	uint padding;
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer Objects {
+	Object objects[];
+};
+
+void main() {
+	vec4 worldPosition = objects[gl_InstanceIndex].model * inPosition;
+	gl_Position = frame.projView * worldPosition;
+	outUV = inUV;
+}
\ No newline at end of file
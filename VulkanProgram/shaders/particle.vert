@@ -0,0 +1,19 @@
+#version 460
+
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec4 inVelocity;
+
+layout(location = 0) out vec4 outColor;
+
+layout(push_constant) uniform PushConstants {
+	mat4 projView;
+} constants;
+
+void main() {
+	gl_Position  = constants.projView * vec4(inPosition.xyz, 1.0);
+	gl_PointSize = 1.0;
+
+	// Fast particles glow hot, slow ones cool down and fade out over their last half second
+	float heat = clamp(length(inVelocity.xyz) * 0.6, 0.0, 1.0);
+	outColor   = vec4(mix(vec3(0.9, 0.2, 0.05), vec3(1.0, 0.9, 0.5), heat), clamp(inPosition.w * 2.0, 0.0, 1.0));
+}
\ No newline at end of file
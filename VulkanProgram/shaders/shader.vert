@@ -5,13 +5,13 @@ layout(location = 1) in vec2 inUV;
 
 layout(location = 0) out vec2 outUV;
 
-layout(set = 0, binding = 0) uniform UniformBufferObject {
-	mat4 model;
+layout(set = 0, binding = 0) uniform InstanceConstants {
 	mat4 projView;
-} ubo;
+	mat4 models[255];
+} instances;
 
 void main() {
-	vec4 worldPosition = /*ubo.model **/ inPosition;
-	gl_Position = /*ubo.projView **/ worldPosition;
+	vec4 worldPosition = instances.models[gl_InstanceIndex] * inPosition;
+	gl_Position = instances.projView * worldPosition;
 	outUV = inUV;
 }
\ No newline at end of file
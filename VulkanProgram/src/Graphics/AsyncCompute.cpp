@@ -0,0 +1,89 @@
+#include "Graphics/AsyncCompute.h"
+
+#include <algorithm>
+
+namespace Graphics {
+	AsyncCompute::AsyncCompute(vk::Device device, vk::Queue computeQueue, std::uint32_t computeFamilyIndex, std::uint32_t graphicsFamilyIndex, std::uint32_t framesInFlight)
+	    : m_Device(device), m_ComputeQueue(computeQueue), m_ComputeFamilyIndex(computeFamilyIndex), m_GraphicsFamilyIndex(graphicsFamilyIndex), m_FramesInFlight(std::max(framesInFlight, 1U)) {
+		m_QueueFamilies = { m_GraphicsFamilyIndex };
+		if (isAsync())
+			m_QueueFamilies.push_back(m_ComputeFamilyIndex);
+	}
+
+	AsyncCompute::~AsyncCompute() {
+		if (isCreated())
+			destroy();
+	}
+
+	void AsyncCompute::create() {
+		if (isCreated())
+			destroy();
+
+		m_Created     = true;
+		m_SubmitCount = 0;
+		if (!isAsync())
+			return;
+
+		// One pool per frame slot, it's reset when the slot comes around again
+		m_Frames.resize(m_FramesInFlight);
+		for (auto& frame : m_Frames) {
+			frame.m_CommandPool     = m_Device.createCommandPool({ vk::CommandPoolCreateFlagBits::eTransient, m_ComputeFamilyIndex });
+			frame.m_CommandBuffer   = m_Device.allocateCommandBuffers({ frame.m_CommandPool, vk::CommandBufferLevel::ePrimary, 1 })[0];
+			frame.m_ComputeFinished = m_Device.createSemaphore({ vk::SemaphoreCreateFlags {} });
+		}
+
+		m_GraphicsFinished.resize(s_GraphicsLatency);
+		for (auto& semaphore : m_GraphicsFinished)
+			semaphore = m_Device.createSemaphore({ vk::SemaphoreCreateFlags {} });
+	}
+
+	void AsyncCompute::destroy() {
+		for (auto& frame : m_Frames) {
+			m_Device.destroyCommandPool(frame.m_CommandPool);
+			m_Device.destroySemaphore(frame.m_ComputeFinished);
+		}
+		for (auto& semaphore : m_GraphicsFinished) m_Device.destroySemaphore(semaphore);
+
+		m_Frames.clear();
+		m_GraphicsFinished.clear();
+		m_Created = false;
+	}
+
+	vk::CommandBuffer AsyncCompute::begin(std::uint32_t frame, vk::CommandBuffer graphicsCommandBuffer) {
+		if (!isAsync())
+			return graphicsCommandBuffer;
+
+		m_CurrentFrame = frame % m_FramesInFlight;
+		auto& current  = m_Frames[m_CurrentFrame];
+		m_Device.resetCommandPool(current.m_CommandPool);
+		current.m_CommandBuffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+		return current.m_CommandBuffer;
+	}
+
+	void AsyncCompute::submit(vk::PipelineStageFlags graphicsStage, std::vector<vk::Semaphore>& graphicsWaitSemaphores, std::vector<vk::PipelineStageFlags>& graphicsWaitStages, std::vector<vk::Semaphore>& graphicsSignalSemaphores) {
+		if (!isAsync()) {
+			++m_SubmitCount;
+			return;
+		}
+
+		auto& current = m_Frames[m_CurrentFrame];
+		current.m_CommandBuffer.end();
+
+		// The graphics submission 's_GraphicsLatency' submissions back signaled this semaphore once it was done reading, the first submissions have nothing to wait for.
+		// Each binary semaphore is signaled and waited on exactly once per round, and the wait is always submitted before the next signal
+		vk::Semaphore graphicsFinished = m_GraphicsFinished[m_SubmitCount % s_GraphicsLatency];
+		std::vector<vk::Semaphore> waitSemaphores;
+		std::vector<vk::PipelineStageFlags> waitStages;
+		if (m_SubmitCount >= s_GraphicsLatency) {
+			waitSemaphores.push_back(graphicsFinished);
+			waitStages.push_back(vk::PipelineStageFlagBits::eComputeShader);
+		}
+
+		m_ComputeQueue.submit({ { waitSemaphores, waitStages, current.m_CommandBuffer, current.m_ComputeFinished } }, nullptr);
+
+		graphicsWaitSemaphores.push_back(current.m_ComputeFinished);
+		graphicsWaitStages.push_back(graphicsStage);
+		graphicsSignalSemaphores.push_back(graphicsFinished);
+		++m_SubmitCount;
+	}
+} // namespace Graphics
@@ -0,0 +1,91 @@
+#include "Graphics/BindlessTable.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Graphics {
+	BindlessTable::BindlessTable(vk::Device device, vk::PhysicalDevice physicalDevice, std::uint32_t imageCapacity, std::uint32_t samplerCapacity, vk::ShaderStageFlags stages)
+	    : m_Device(device), m_PhysicalDevice(physicalDevice), m_ImageCapacity(imageCapacity), m_SamplerCapacity(samplerCapacity), m_Stages(stages) { }
+
+	BindlessTable::~BindlessTable() {
+		if (isCreated())
+			destroy();
+	}
+
+	void BindlessTable::create() {
+		if (isCreated())
+			destroy();
+
+		// Update-after-bind descriptors have their own, usually much larger, limits
+		auto properties   = m_PhysicalDevice.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceDescriptorIndexingProperties>();
+		auto& limits      = properties.get<vk::PhysicalDeviceDescriptorIndexingProperties>();
+		auto imageLimit   = std::min(limits.maxPerStageDescriptorUpdateAfterBindSampledImages, limits.maxDescriptorSetUpdateAfterBindSampledImages);
+		auto samplerLimit = std::min(limits.maxPerStageDescriptorUpdateAfterBindSamplers, limits.maxDescriptorSetUpdateAfterBindSamplers);
+		m_ImageCapacity   = std::max(std::min(m_ImageCapacity, imageLimit > s_ReservedDescriptors ? imageLimit - s_ReservedDescriptors : 1U), 1U);
+		m_SamplerCapacity = std::max(std::min(m_SamplerCapacity, samplerLimit > s_ReservedDescriptors ? samplerLimit - s_ReservedDescriptors : 1U), 1U);
+
+		std::vector<vk::DescriptorSetLayoutBinding> bindings = {
+			{ 0, vk::DescriptorType::eSampledImage, m_ImageCapacity, m_Stages, nullptr },
+			{ 1, vk::DescriptorType::eSampler, m_SamplerCapacity, m_Stages, nullptr }
+		};
+		std::vector<vk::DescriptorBindingFlags> bindingFlags(bindings.size(), vk::DescriptorBindingFlagBits::eUpdateAfterBind | vk::DescriptorBindingFlagBits::ePartiallyBound);
+
+		vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo = { bindingFlags };
+		vk::DescriptorSetLayoutCreateInfo layoutCreateInfo                   = { vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool, bindings };
+		layoutCreateInfo.pNext                                               = &bindingFlagsCreateInfo;
+		m_Layout                                                             = m_Device.createDescriptorSetLayout(layoutCreateInfo);
+
+		std::vector<vk::DescriptorPoolSize> poolSizes = { { vk::DescriptorType::eSampledImage, m_ImageCapacity }, { vk::DescriptorType::eSampler, m_SamplerCapacity } };
+
+		m_Pool          = m_Device.createDescriptorPool({ vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind, 1, poolSizes });
+		m_DescriptorSet = m_Device.allocateDescriptorSets({ m_Pool, m_Layout })[0];
+
+		m_ImageCount   = 0;
+		m_SamplerCount = 0;
+		m_FreeImages.clear();
+	}
+
+	void BindlessTable::destroy() {
+		// Destroying the pool frees the set
+		m_Device.destroyDescriptorPool(m_Pool);
+		m_Device.destroyDescriptorSetLayout(m_Layout);
+
+		m_Pool          = nullptr;
+		m_Layout        = nullptr;
+		m_DescriptorSet = nullptr;
+		m_FreeImages.clear();
+	}
+
+	std::uint32_t BindlessTable::addImage(vk::ImageView imageView, vk::ImageLayout layout) {
+		std::uint32_t index;
+		if (!m_FreeImages.empty()) {
+			index = m_FreeImages.back();
+			m_FreeImages.pop_back();
+		} else if (m_ImageCount < m_ImageCapacity) {
+			index = m_ImageCount++;
+		} else {
+			throw std::runtime_error("Bindless table is out of image slots");
+		}
+
+		// Writing a slot no recorded draw uses is allowed while the set is bound, that's what update-after-bind is for
+		vk::DescriptorImageInfo imageInfo = { nullptr, imageView, layout };
+		m_Device.updateDescriptorSets({ { m_DescriptorSet, 0, index, 1, vk::DescriptorType::eSampledImage, &imageInfo, nullptr, nullptr } }, {});
+		return index;
+	}
+
+	void BindlessTable::removeImage(std::uint32_t index) {
+		// The stale descriptor stays in the slot until it's reused, partially bound slots may hold anything as long as no draw reads them
+		if (index < m_ImageCount)
+			m_FreeImages.push_back(index);
+	}
+
+	std::uint32_t BindlessTable::addSampler(vk::Sampler sampler) {
+		if (m_SamplerCount >= m_SamplerCapacity)
+			throw std::runtime_error("Bindless table is out of sampler slots");
+
+		std::uint32_t index               = m_SamplerCount++;
+		vk::DescriptorImageInfo imageInfo = { sampler, nullptr, vk::ImageLayout::eUndefined };
+		m_Device.updateDescriptorSets({ { m_DescriptorSet, 1, index, 1, vk::DescriptorType::eSampler, &imageInfo, nullptr, nullptr } }, {});
+		return index;
+	}
+} // namespace Graphics
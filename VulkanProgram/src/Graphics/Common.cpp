@@ -1,16 +1,160 @@
 #include "Graphics/Common.h"
 
 #include <algorithm>
+#include <utility>
 
 namespace Graphics {
-	HandleBase::HandleBase(const std::vector<HandleBase*>& parents)
-	    : m_Parents(parents) {
-		for (auto parent : m_Parents)
-			parent->m_Children.push_back(this);
+	std::uint64_t HandleBase::s_VisitMark = 0;
+
+	HandleBase::HandleBase(const std::vector<HandleBase*>& parents) {
+		m_ParentLinks.reserve(parents.size());
+		for (auto parent : parents)
+			attach(*parent);
 	}
 
 	HandleBase::~HandleBase() {
-		for (auto parent : m_Parents)
-			std::erase(parent->m_Children, this);
+		for (auto& link : m_ParentLinks)
+			Unlink(link);
+
+		// Children outliving this handle forget it as a parent
+		while (m_FirstChild)
+			m_FirstChild->m_Child->detach(*this);
+	}
+
+	bool HandleBase::create() {
+		if (!isCreated()) {
+			createSelf();
+			return isCreated();
+		}
+
+		// Recreate, every descendant destroyed with this handle is recreated afterwards with its parents before it
+		std::vector<HandleBase*> order;
+		collectSubtree(order, true);
+
+		std::vector<HandleBase*> destroyed;
+		for (auto handle : order) {
+			handle->destroySelf();
+			if (handle != this && !handle->isCreated())
+				destroyed.push_back(handle);
+		}
+
+		createSelf();
+		if (isCreated()) {
+			for (auto itr = destroyed.rbegin(); itr != destroyed.rend(); ++itr)
+				if ((*itr)->areParentsCreated())
+					(*itr)->createSelf();
+		}
+		return isCreated();
+	}
+
+	bool HandleBase::createTree() {
+		if (!isCreated())
+			createSelf();
+		if (!isCreated())
+			return false;
+
+		std::vector<HandleBase*> order;
+		collectSubtree(order, false);
+		for (auto itr = order.rbegin(); itr != order.rend(); ++itr) {
+			auto handle = *itr;
+			if (!handle->isCreated() && handle->areParentsCreated())
+				handle->createSelf();
+		}
+		return true;
+	}
+
+	void HandleBase::destroy() {
+		std::vector<HandleBase*> order;
+		collectSubtree(order, true);
+		for (auto handle : order)
+			handle->destroySelf();
+	}
+
+	void HandleBase::attach(HandleBase& parent) {
+		for (auto& link : m_ParentLinks)
+			if (link.m_Parent == &parent)
+				return;
+
+		// Growing moves every link, so their neighbours have to learn the new addresses
+		if (m_ParentLinks.size() == m_ParentLinks.capacity()) {
+			m_ParentLinks.reserve(std::max<std::size_t>(m_ParentLinks.capacity() * 2, 1));
+			for (auto& link : m_ParentLinks)
+				Relink(link);
+		}
+
+		auto& link       = m_ParentLinks.emplace_back();
+		link.m_Parent    = &parent;
+		link.m_Child     = this;
+		link.m_NextChild = parent.m_FirstChild;
+		if (parent.m_FirstChild)
+			parent.m_FirstChild->m_PrevChild = &link;
+		parent.m_FirstChild = &link;
+		++parent.m_ChildCount;
+	}
+
+	void HandleBase::detach(HandleBase& parent) {
+		auto itr = std::find_if(m_ParentLinks.begin(), m_ParentLinks.end(), [&parent](const HandleLink& link) { return link.m_Parent == &parent; });
+		if (itr == m_ParentLinks.end())
+			return;
+
+		// Fill the gap with the last link instead of shifting every link after it
+		Unlink(*itr);
+		if (&*itr != &m_ParentLinks.back()) {
+			*itr = m_ParentLinks.back();
+			Relink(*itr);
+		}
+		m_ParentLinks.pop_back();
+	}
+
+	void HandleBase::collectSubtree(std::vector<HandleBase*>& order, bool createdOnly) {
+		// Iterative depth first search, a handle is appended once all of its children are, so deep trees can't overflow the stack
+		std::uint64_t mark = ++s_VisitMark;
+		std::vector<std::pair<HandleBase*, HandleLink*>> stack;
+		stack.emplace_back(this, m_FirstChild);
+		m_VisitMark = mark;
+		while (!stack.empty()) {
+			auto& [handle, link] = stack.back();
+			if (!link) {
+				order.push_back(handle);
+				stack.pop_back();
+				continue;
+			}
+
+			HandleBase* child = link->m_Child;
+			link              = link->m_NextChild;
+			if (child->m_VisitMark == mark || (createdOnly && !child->isCreated()))
+				continue;
+
+			child->m_VisitMark = mark;
+			stack.emplace_back(child, child->m_FirstChild);
+		}
+	}
+
+	bool HandleBase::areParentsCreated() const {
+		for (auto& link : m_ParentLinks)
+			if (!link.m_Parent->isCreated())
+				return false;
+		return true;
+	}
+
+	void HandleBase::Relink(HandleLink& link) {
+		if (link.m_PrevChild)
+			link.m_PrevChild->m_NextChild = &link;
+		else
+			link.m_Parent->m_FirstChild = &link;
+		if (link.m_NextChild)
+			link.m_NextChild->m_PrevChild = &link;
+	}
+
+	void HandleBase::Unlink(HandleLink& link) {
+		if (link.m_PrevChild)
+			link.m_PrevChild->m_NextChild = link.m_NextChild;
+		else
+			link.m_Parent->m_FirstChild = link.m_NextChild;
+		if (link.m_NextChild)
+			link.m_NextChild->m_PrevChild = link.m_PrevChild;
+		--link.m_Parent->m_ChildCount;
+		link.m_PrevChild = nullptr;
+		link.m_NextChild = nullptr;
 	}
-} // namespace Graphics
\ No newline at end of file
+} // namespace Graphics
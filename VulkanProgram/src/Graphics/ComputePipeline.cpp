@@ -0,0 +1,69 @@
+#include "Graphics/ComputePipeline.h"
+
+#include <algorithm>
+
+namespace Graphics {
+	ComputePipeline::ComputePipeline(vk::Device device, vk::PipelineCache pipelineCache, ShaderLibrary& shaderLibrary)
+	    : m_Device(device), m_PipelineCache(pipelineCache), m_ShaderLibrary(shaderLibrary) { }
+
+	ComputePipeline::~ComputePipeline() {
+		if (isCreated())
+			destroy();
+	}
+
+	void ComputePipeline::create(const ComputePipelineDesc& desc) {
+		if (isCreated())
+			destroy();
+
+		m_Desc = desc;
+		for (auto& size : m_Desc.m_LocalSize)
+			size = std::max(size, 1U);
+
+		std::vector<vk::PushConstantRange> pushConstantRanges;
+		if (m_Desc.m_PushConstantSize > 0)
+			pushConstantRanges.push_back({ vk::ShaderStageFlagBits::eCompute, 0, m_Desc.m_PushConstantSize });
+		m_Layout = m_Device.createPipelineLayout({ {}, m_Desc.m_SetLayouts, pushConstantRanges });
+
+		std::array<vk::SpecializationMapEntry, 3> mapEntries = { {
+			{ 0, 0, sizeof(std::uint32_t) },
+			{ 1, sizeof(std::uint32_t), sizeof(std::uint32_t) },
+			{ 2, 2 * sizeof(std::uint32_t), sizeof(std::uint32_t) }
+		} };
+		vk::SpecializationInfo specializationInfo = { static_cast<std::uint32_t>(mapEntries.size()), mapEntries.data(), sizeof(m_Desc.m_LocalSize), m_Desc.m_LocalSize.data() };
+
+		vk::ComputePipelineCreateInfo createInfo = { {}, { {}, vk::ShaderStageFlagBits::eCompute, m_ShaderLibrary.getModule(m_Desc.m_Shader), "main", &specializationInfo }, m_Layout, nullptr, 0 };
+		m_Pipeline                               = m_Device.createComputePipeline(m_PipelineCache, createInfo).value;
+	}
+
+	void ComputePipeline::destroy() {
+		m_Device.destroyPipeline(m_Pipeline);
+		m_Device.destroyPipelineLayout(m_Layout);
+
+		m_Pipeline = nullptr;
+		m_Layout   = nullptr;
+	}
+
+	void ComputePipeline::bind(vk::CommandBuffer commandBuffer, const std::vector<vk::DescriptorSet>& descriptorSets, const std::vector<std::uint32_t>& dynamicOffsets) const {
+		commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_Pipeline);
+		if (!descriptorSets.empty())
+			commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_Layout, 0, descriptorSets, dynamicOffsets);
+	}
+
+	void ComputePipeline::pushConstants(vk::CommandBuffer commandBuffer, const void* data, std::uint32_t size) const {
+		commandBuffer.pushConstants(m_Layout, vk::ShaderStageFlagBits::eCompute, 0, size, data);
+	}
+
+	void ComputePipeline::dispatch(vk::CommandBuffer commandBuffer, std::uint32_t groupCountX, std::uint32_t groupCountY, std::uint32_t groupCountZ) const {
+		if (groupCountX > 0 && groupCountY > 0 && groupCountZ > 0)
+			commandBuffer.dispatch(groupCountX, groupCountY, groupCountZ);
+	}
+
+	void ComputePipeline::dispatchThreads(vk::CommandBuffer commandBuffer, std::uint32_t threadCountX, std::uint32_t threadCountY, std::uint32_t threadCountZ) const {
+		auto& localSize = m_Desc.m_LocalSize;
+		dispatch(commandBuffer, (threadCountX + localSize[0] - 1) / localSize[0], (threadCountY + localSize[1] - 1) / localSize[1], (threadCountZ + localSize[2] - 1) / localSize[2]);
+	}
+
+	void ComputePipeline::dispatchIndirect(vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::DeviceSize offset) const {
+		commandBuffer.dispatchIndirect(buffer, offset);
+	}
+} // namespace Graphics
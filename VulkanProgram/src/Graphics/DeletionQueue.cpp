@@ -0,0 +1,80 @@
+#include "Graphics/DeletionQueue.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace Graphics {
+	namespace {
+		template <class HandleType>
+		HandleType FromRaw(std::uint64_t raw) {
+			typename HandleType::CType handle_;
+			std::memcpy(&handle_, &raw, sizeof(handle_));
+			return handle_;
+		}
+	} // namespace
+
+	DeletionQueue::DeletionQueue(vk::Device device, VmaAllocator allocator, const FramePacer& framePacer)
+	    : m_Device(device), m_Allocator(allocator), m_FramePacer(framePacer) { }
+
+	DeletionQueue::~DeletionQueue() {
+		flush();
+	}
+
+	void DeletionQueue::defer(std::function<void()> callback) {
+		if (callback)
+			m_Callbacks.push_back({ std::move(callback), m_FramePacer.getFrameSerial() });
+	}
+
+	void DeletionQueue::collect() {
+		destroyUpTo(m_FramePacer.getCompletedFrameSerial());
+	}
+
+	void DeletionQueue::flush() {
+		destroyUpTo(~0ULL);
+	}
+
+	void DeletionQueue::push(vk::ObjectType type, std::uint64_t handle, VmaAllocation allocation) {
+		// Frames that began before this call may still use the handle, frames that begin after it can't
+		if (handle)
+			m_Entries.push_back({ type, handle, allocation, m_FramePacer.getFrameSerial() });
+	}
+
+	void DeletionQueue::destroyUpTo(std::uint64_t serial) {
+		// Both queues are ordered by serial, so everything that is done sits at the front
+		while (!m_Entries.empty() && m_Entries.front().m_Serial <= serial) {
+			destroyEntry(m_Entries.front());
+			m_Entries.pop_front();
+			++m_DestroyedCount;
+		}
+
+		while (!m_Callbacks.empty() && m_Callbacks.front().m_Serial <= serial) {
+			m_Callbacks.front().m_Callback();
+			m_Callbacks.pop_front();
+			++m_DestroyedCount;
+		}
+	}
+
+	void DeletionQueue::destroyEntry(const Entry& entry) {
+		switch (entry.m_Type) {
+		case vk::ObjectType::eBuffer: vmaDestroyBuffer(m_Allocator, FromRaw<vk::Buffer>(entry.m_Handle), entry.m_Allocation); break;
+		case vk::ObjectType::eImage: vmaDestroyImage(m_Allocator, FromRaw<vk::Image>(entry.m_Handle), entry.m_Allocation); break;
+		case vk::ObjectType::eBufferView: m_Device.destroyBufferView(FromRaw<vk::BufferView>(entry.m_Handle)); break;
+		case vk::ObjectType::eImageView: m_Device.destroyImageView(FromRaw<vk::ImageView>(entry.m_Handle)); break;
+		case vk::ObjectType::eSampler: m_Device.destroySampler(FromRaw<vk::Sampler>(entry.m_Handle)); break;
+		case vk::ObjectType::eFramebuffer: m_Device.destroyFramebuffer(FromRaw<vk::Framebuffer>(entry.m_Handle)); break;
+		case vk::ObjectType::eRenderPass: m_Device.destroyRenderPass(FromRaw<vk::RenderPass>(entry.m_Handle)); break;
+		case vk::ObjectType::ePipeline: m_Device.destroyPipeline(FromRaw<vk::Pipeline>(entry.m_Handle)); break;
+		case vk::ObjectType::ePipelineLayout: m_Device.destroyPipelineLayout(FromRaw<vk::PipelineLayout>(entry.m_Handle)); break;
+		case vk::ObjectType::eDescriptorSetLayout: m_Device.destroyDescriptorSetLayout(FromRaw<vk::DescriptorSetLayout>(entry.m_Handle)); break;
+		case vk::ObjectType::eDescriptorPool: m_Device.destroyDescriptorPool(FromRaw<vk::DescriptorPool>(entry.m_Handle)); break;
+		case vk::ObjectType::eQueryPool: m_Device.destroyQueryPool(FromRaw<vk::QueryPool>(entry.m_Handle)); break;
+		case vk::ObjectType::eCommandPool: m_Device.destroyCommandPool(FromRaw<vk::CommandPool>(entry.m_Handle)); break;
+		case vk::ObjectType::eSemaphore: m_Device.destroySemaphore(FromRaw<vk::Semaphore>(entry.m_Handle)); break;
+		case vk::ObjectType::eFence: m_Device.destroyFence(FromRaw<vk::Fence>(entry.m_Handle)); break;
+		case vk::ObjectType::eEvent: m_Device.destroyEvent(FromRaw<vk::Event>(entry.m_Handle)); break;
+		case vk::ObjectType::eShaderModule: m_Device.destroyShaderModule(FromRaw<vk::ShaderModule>(entry.m_Handle)); break;
+		case vk::ObjectType::eSwapchainKHR: m_Device.destroySwapchainKHR(FromRaw<vk::SwapchainKHR>(entry.m_Handle)); break;
+		default: throw std::runtime_error("DeletionQueue cannot destroy objects of type " + vk::to_string(entry.m_Type));
+		}
+	}
+} // namespace Graphics
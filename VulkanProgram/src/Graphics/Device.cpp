@@ -0,0 +1,280 @@
+#include "Graphics/Device.h"
+#include "Utils/StringInterner.h"
+
+#include <algorithm>
+
+namespace Graphics {
+	namespace {
+		bool FindExtension(const std::vector<vk::ExtensionProperties>& extensions, std::string_view name) {
+			return std::any_of(extensions.begin(), extensions.end(), [name](const vk::ExtensionProperties& extension) { return name == extension.extensionName.data(); });
+		}
+
+		bool ContainsName(const std::vector<const char*>& names, std::string_view name) {
+			return std::any_of(names.begin(), names.end(), [name](const char* other) { return name == other; });
+		}
+
+		std::uint64_t GetTypeRank(vk::PhysicalDeviceType type) {
+			switch (type) {
+			case vk::PhysicalDeviceType::eCpu: return 1;
+			case vk::PhysicalDeviceType::eOther: return 2;
+			case vk::PhysicalDeviceType::eVirtualGpu: return 3;
+			case vk::PhysicalDeviceType::eIntegratedGpu: return 4;
+			case vk::PhysicalDeviceType::eDiscreteGpu: return 5;
+			default: return 0;
+			}
+		}
+	} // namespace
+
+	DeviceFeatureChain::DeviceFeatureChain(const DeviceCapabilities& capabilities) {
+		auto& features                     = m_Features2.features;
+		features.multiDrawIndirect         = capabilities.m_MultiDrawIndirect;
+		features.drawIndirectFirstInstance = capabilities.m_DrawIndirectFirstInstance;
+		features.pipelineStatisticsQuery   = capabilities.m_PipelineStatistics;
+		features.inheritedQueries          = capabilities.m_InheritedQueries;
+
+		// Extension features can only be chained through 'vk::PhysicalDeviceFeatures2', which is core since Vulkan 1.1
+		m_UseFeatures2 = capabilities.m_APIVersion.m_Version >= VK_API_VERSION_1_1;
+		if (!m_UseFeatures2)
+			return;
+
+		void** next = &m_Features2.pNext;
+		if (capabilities.m_DescriptorIndexing)
+			features.shaderSampledImageArrayDynamicIndexing = true;
+
+		if (capabilities.m_APIVersion.m_Version >= VK_API_VERSION_1_2) {
+			// The Vulkan 1.2 features replace the structures of the promoted extensions, chaining both is invalid
+			m_Vulkan12Features.timelineSemaphore = capabilities.m_TimelineSemaphores;
+			m_Vulkan12Features.drawIndirectCount = capabilities.m_DrawIndirectCount;
+			if (capabilities.m_DescriptorIndexing) {
+				m_Vulkan12Features.runtimeDescriptorArray                       = true;
+				m_Vulkan12Features.descriptorBindingPartiallyBound              = true;
+				m_Vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = true;
+			}
+			*next = &m_Vulkan12Features;
+			next  = &m_Vulkan12Features.pNext;
+		} else {
+			if (capabilities.m_DescriptorIndexing) {
+				m_IndexingFeatures.runtimeDescriptorArray                       = true;
+				m_IndexingFeatures.descriptorBindingPartiallyBound              = true;
+				m_IndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = true;
+				m_Extensions.push_back("VK_KHR_maintenance3");
+				m_Extensions.push_back("VK_EXT_descriptor_indexing");
+				*next = &m_IndexingFeatures;
+				next  = &m_IndexingFeatures.pNext;
+			}
+			if (capabilities.m_TimelineSemaphores) {
+				m_TimelineFeatures.timelineSemaphore = true;
+				m_Extensions.push_back("VK_KHR_timeline_semaphore");
+				*next = &m_TimelineFeatures;
+				next  = &m_TimelineFeatures.pNext;
+			}
+		}
+
+		if (capabilities.m_DynamicRendering) {
+			m_DynamicRenderingFeatures.dynamicRendering = true;
+			if (capabilities.m_APIVersion.m_Version < VK_API_VERSION_1_3)
+				m_Extensions.push_back("VK_KHR_dynamic_rendering");
+			*next = &m_DynamicRenderingFeatures;
+			next  = &m_DynamicRenderingFeatures.pNext;
+		}
+
+		if (capabilities.m_MemoryBudget)
+			m_Extensions.push_back("VK_EXT_memory_budget");
+	}
+
+	DeviceCapabilities Device::GetCapabilities(vk::PhysicalDevice physicalDevice, std::uint32_t instanceVersion) {
+		DeviceCapabilities capabilities;
+		capabilities.m_APIVersion = std::min(instanceVersion, physicalDevice.getProperties().apiVersion);
+
+		auto memoryProperties = physicalDevice.getMemoryProperties();
+		for (std::uint32_t i = 0; i < memoryProperties.memoryHeapCount; ++i)
+			if (memoryProperties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal)
+				capabilities.m_DeviceLocalMemory = std::max(capabilities.m_DeviceLocalMemory, memoryProperties.memoryHeaps[i].size);
+
+		auto queueFamilies = GetQueueFamilies(physicalDevice, nullptr);
+		if (queueFamilies.hasGraphics()) {
+			capabilities.m_DedicatedTransferQueue = queueFamilies.m_Transfer != queueFamilies.m_Graphics;
+			capabilities.m_DedicatedComputeQueue  = queueFamilies.m_Compute != queueFamilies.m_Graphics;
+		}
+
+		auto features                            = physicalDevice.getFeatures();
+		capabilities.m_MultiDrawIndirect         = features.multiDrawIndirect;
+		capabilities.m_DrawIndirectFirstInstance = features.drawIndirectFirstInstance;
+		capabilities.m_PipelineStatistics        = features.pipelineStatisticsQuery;
+		capabilities.m_InheritedQueries          = features.inheritedQueries;
+
+		// Everything else is queried through 'vkGetPhysicalDeviceFeatures2', which is core since Vulkan 1.1 and has to be supported by both the instance and the device.
+		// 'DeviceFeatureChain' enables nothing beyond Vulkan 1.0 below that either
+		if (capabilities.m_APIVersion.m_Version < VK_API_VERSION_1_1)
+			return capabilities;
+
+		auto extensions             = physicalDevice.enumerateDeviceExtensionProperties();
+		capabilities.m_MemoryBudget = FindExtension(extensions, "VK_EXT_memory_budget");
+
+		bool indexing = false;
+		if (capabilities.m_APIVersion.m_Version >= VK_API_VERSION_1_2) {
+			auto featureChain                 = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+			auto& vulkan12Features            = featureChain.get<vk::PhysicalDeviceVulkan12Features>();
+			capabilities.m_TimelineSemaphores = vulkan12Features.timelineSemaphore;
+			capabilities.m_DrawIndirectCount  = vulkan12Features.drawIndirectCount;
+			indexing                          = vulkan12Features.runtimeDescriptorArray && vulkan12Features.descriptorBindingPartiallyBound && vulkan12Features.descriptorBindingSampledImageUpdateAfterBind;
+		} else {
+			if (FindExtension(extensions, "VK_KHR_maintenance3") && FindExtension(extensions, "VK_EXT_descriptor_indexing")) {
+				auto featureChain      = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceDescriptorIndexingFeatures>();
+				auto& indexingFeatures = featureChain.get<vk::PhysicalDeviceDescriptorIndexingFeatures>();
+				indexing               = indexingFeatures.runtimeDescriptorArray && indexingFeatures.descriptorBindingPartiallyBound && indexingFeatures.descriptorBindingSampledImageUpdateAfterBind;
+			}
+			if (FindExtension(extensions, "VK_KHR_timeline_semaphore")) {
+				auto featureChain                 = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceTimelineSemaphoreFeatures>();
+				capabilities.m_TimelineSemaphores = featureChain.get<vk::PhysicalDeviceTimelineSemaphoreFeatures>().timelineSemaphore;
+			}
+		}
+		capabilities.m_DescriptorIndexing = indexing && features.shaderSampledImageArrayDynamicIndexing;
+
+		// The extension needs 'VK_KHR_depth_stencil_resolve' and 'VK_KHR_create_renderpass2', which are core since Vulkan 1.2
+		if (capabilities.m_APIVersion.m_Version >= VK_API_VERSION_1_3 || (capabilities.m_APIVersion.m_Version >= VK_API_VERSION_1_2 && FindExtension(extensions, "VK_KHR_dynamic_rendering"))) {
+			auto featureChain               = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceDynamicRenderingFeaturesKHR>();
+			capabilities.m_DynamicRendering = featureChain.get<vk::PhysicalDeviceDynamicRenderingFeaturesKHR>().dynamicRendering;
+		}
+		return capabilities;
+	}
+
+	DeviceQueueFamilies Device::GetQueueFamilies(vk::PhysicalDevice physicalDevice, vk::SurfaceKHR surface) {
+		DeviceQueueFamilies families;
+		auto queueFamilies = physicalDevice.getQueueFamilyProperties();
+
+		for (std::uint32_t i = 0; i < queueFamilies.size(); ++i) {
+			if ((queueFamilies[i].queueFlags & vk::QueueFlagBits::eGraphics) && (!surface || physicalDevice.getSurfaceSupportKHR(i, surface))) {
+				families.m_Graphics = i;
+				break;
+			}
+		}
+		if (!families.hasGraphics())
+			return families;
+
+		// A compute family without graphics runs asynchronously to it, a transfer family without either is usually backed by a dedicated DMA engine
+		families.m_Compute  = families.m_Graphics;
+		families.m_Transfer = families.m_Graphics;
+		for (std::uint32_t i = 0; i < queueFamilies.size(); ++i) {
+			auto flags = queueFamilies[i].queueFlags;
+			if (flags & vk::QueueFlagBits::eGraphics)
+				continue;
+
+			if ((flags & vk::QueueFlagBits::eCompute) && families.m_Compute == families.m_Graphics)
+				families.m_Compute = i;
+			else if ((flags & vk::QueueFlagBits::eTransfer) && !(flags & vk::QueueFlagBits::eCompute) && families.m_Transfer == families.m_Graphics)
+				families.m_Transfer = i;
+		}
+		return families;
+	}
+
+	bool Device::HasExtension(vk::PhysicalDevice physicalDevice, std::string_view name) {
+		return FindExtension(physicalDevice.enumerateDeviceExtensionProperties(), name);
+	}
+
+	std::uint64_t Device::Score(vk::PhysicalDevice physicalDevice, std::uint32_t instanceVersion, vk::SurfaceKHR surface, const std::vector<const char*>& requiredExtensions) {
+		if (!GetQueueFamilies(physicalDevice, surface).hasGraphics())
+			return 0;
+
+		auto extensions = physicalDevice.enumerateDeviceExtensionProperties();
+		for (auto required : requiredExtensions)
+			if (!FindExtension(extensions, required))
+				return 0;
+
+		// Device type outweighs every capability, and every capability outweighs the up to 99 points of device local memory
+		auto capabilities   = GetCapabilities(physicalDevice, instanceVersion);
+		std::uint64_t score = GetTypeRank(physicalDevice.getProperties().deviceType) * 1000;
+		for (bool capability : { capabilities.m_DedicatedTransferQueue, capabilities.m_DedicatedComputeQueue, capabilities.m_TimelineSemaphores, capabilities.m_DescriptorIndexing, capabilities.m_MemoryBudget, capabilities.m_DynamicRendering, capabilities.m_DrawIndirectCount, capabilities.m_MultiDrawIndirect })
+			if (capability)
+				score += 100;
+		score += std::min<std::uint64_t>(capabilities.m_DeviceLocalMemory >> 30, 99);
+		return score + 1;
+	}
+
+	vk::PhysicalDevice Device::PickPhysicalDevice(vk::Instance instance, std::uint32_t instanceVersion, vk::SurfaceKHR surface, const std::vector<const char*>& requiredExtensions) {
+		vk::PhysicalDevice bestPhysicalDevice;
+		std::uint64_t bestScore = 0;
+		for (auto& physicalDevice : instance.enumeratePhysicalDevices()) {
+			std::uint64_t score = Score(physicalDevice, instanceVersion, surface, requiredExtensions);
+			if (score > bestScore) {
+				bestScore          = score;
+				bestPhysicalDevice = physicalDevice;
+			}
+		}
+		return bestPhysicalDevice;
+	}
+
+	vk::Device Device::CreateLogicalDevice(vk::PhysicalDevice physicalDevice, const DeviceCapabilities& capabilities, std::initializer_list<std::uint32_t> queueFamilies, std::vector<const char*>& extensions) {
+		// Every capability the device has is enabled, so the renderer only has to check 'getCapabilities' to take a fast path
+		DeviceFeatureChain featureChain = { capabilities };
+		for (auto name : featureChain.getExtensions())
+			if (!ContainsName(extensions, name))
+				extensions.push_back(name);
+
+		// One queue of every distinct family
+		std::vector<float> queuePriorities = { 1.0f };
+		std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
+		for (auto family : queueFamilies)
+			if (std::none_of(queueCreateInfos.begin(), queueCreateInfos.end(), [family](const vk::DeviceQueueCreateInfo& info) { return info.queueFamilyIndex == family; }))
+				queueCreateInfos.push_back({ {}, family, queuePriorities });
+
+		vk::DeviceCreateInfo createInfo = { {}, queueCreateInfos, {}, extensions, featureChain.getFeatures() };
+		createInfo.pNext                = featureChain.getNext();
+		return physicalDevice.createDevice(createInfo);
+	}
+
+	Device::Device(Instance& instance, vk::SurfaceKHR surface)
+	    : m_Instance(instance), m_Surface(surface) {
+		attach(instance);
+	}
+
+	Device::~Device() {
+		if (isCreated())
+			destroy();
+	}
+
+	void Device::requestExtension(std::string_view name, bool required) {
+		const char* internedName = Utils::StringInterner::Get().intern(name);
+
+		auto& names = required ? m_RequiredExtensions : m_OptionalExtensions;
+		if (std::find(names.begin(), names.end(), internedName) == names.end())
+			names.push_back(internedName);
+	}
+
+	bool Device::isExtensionEnabled(std::string_view name) const {
+		return ContainsName(m_EnabledExtensions, name);
+	}
+
+	void Device::createImpl() {
+		std::uint32_t instanceVersion = m_Instance.getAPIVersion();
+
+		m_PhysicalDevice = PickPhysicalDevice(m_Instance.getHandle(), instanceVersion, m_Surface, m_RequiredExtensions);
+		if (!m_PhysicalDevice)
+			return;
+
+		m_Capabilities  = GetCapabilities(m_PhysicalDevice, instanceVersion);
+		m_QueueFamilies = GetQueueFamilies(m_PhysicalDevice, m_Surface);
+
+		m_EnabledExtensions = m_RequiredExtensions;
+		if (!m_OptionalExtensions.empty()) {
+			auto extensions = m_PhysicalDevice.enumerateDeviceExtensionProperties();
+			for (auto name : m_OptionalExtensions)
+				if (FindExtension(extensions, name) && !ContainsName(m_EnabledExtensions, name))
+					m_EnabledExtensions.push_back(name);
+		}
+
+		m_Handle        = CreateLogicalDevice(m_PhysicalDevice, m_Capabilities, { m_QueueFamilies.m_Graphics, m_QueueFamilies.m_Compute, m_QueueFamilies.m_Transfer }, m_EnabledExtensions);
+		m_GraphicsQueue = m_Handle.getQueue(m_QueueFamilies.m_Graphics, 0);
+		m_ComputeQueue  = m_Handle.getQueue(m_QueueFamilies.m_Compute, 0);
+		m_TransferQueue = m_Handle.getQueue(m_QueueFamilies.m_Transfer, 0);
+	}
+
+	bool Device::destroyImpl() {
+		m_Handle.destroy();
+		m_EnabledExtensions.clear();
+		m_GraphicsQueue = nullptr;
+		m_ComputeQueue  = nullptr;
+		m_TransferQueue = nullptr;
+		return true;
+	}
+} // namespace Graphics
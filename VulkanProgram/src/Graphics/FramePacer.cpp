@@ -0,0 +1,128 @@
+#include "Graphics/FramePacer.h"
+
+#include <algorithm>
+
+namespace Graphics {
+	FramePacer::FramePacer(vk::Device device, vk::PhysicalDevice physicalDevice, std::uint32_t queueFamilyIndex, std::uint32_t framesInFlight)
+	    : m_Device(device), m_PhysicalDevice(physicalDevice), m_QueueFamilyIndex(queueFamilyIndex), m_FramesInFlight(std::max(framesInFlight, 1U)) { }
+
+	FramePacer::~FramePacer() {
+		if (isCreated())
+			destroy();
+	}
+
+	void FramePacer::create() {
+		if (isCreated())
+			destroy();
+
+		// Create two semaphores and one fence for every frame in flight
+		m_ImageAvailableSemaphores.resize(m_FramesInFlight);
+		m_RenderFinishedSemaphores.resize(m_FramesInFlight);
+		m_InFlightFences.resize(m_FramesInFlight);
+		m_FrameSerials.resize(m_FramesInFlight, 0);
+		for (std::size_t i = 0; i < m_FramesInFlight; ++i) {
+			m_ImageAvailableSemaphores[i] = m_Device.createSemaphore({ vk::SemaphoreCreateFlags {} });
+			m_RenderFinishedSemaphores[i] = m_Device.createSemaphore({ vk::SemaphoreCreateFlags {} });
+			m_InFlightFences[i]           = m_Device.createFence({ vk::FenceCreateFlagBits::eSignaled });
+		}
+
+		// Create a begin and end timestamp query for every frame in flight, if the queue supports timestamps
+		auto properties    = m_PhysicalDevice.getProperties();
+		auto queueFamilies = m_PhysicalDevice.getQueueFamilyProperties();
+		if (m_QueueFamilyIndex < queueFamilies.size()) {
+			std::uint32_t validBits = queueFamilies[m_QueueFamilyIndex].timestampValidBits;
+			if (validBits > 0 && properties.limits.timestampPeriod > 0.0f) {
+				m_TimestampPeriod    = properties.limits.timestampPeriod;
+				m_TimestampMask      = validBits >= 64 ? ~0ULL : ((1ULL << validBits) - 1);
+				m_TimestampQueryPool = m_Device.createQueryPool({ {}, vk::QueryType::eTimestamp, 2 * m_FramesInFlight, {} });
+				m_TimestampsWritten.resize(m_FramesInFlight, false);
+			}
+		}
+
+		m_CurrentFrame         = 0;
+		m_FrameSerial          = 0;
+		m_CompletedFrameSerial = 0;
+		m_LastTimings          = {};
+	}
+
+	void FramePacer::destroy() {
+		for (auto& semaphore : m_ImageAvailableSemaphores) m_Device.destroySemaphore(semaphore);
+		for (auto& semaphore : m_RenderFinishedSemaphores) m_Device.destroySemaphore(semaphore);
+		for (auto& fence : m_InFlightFences) m_Device.destroyFence(fence);
+		if (m_TimestampQueryPool)
+			m_Device.destroyQueryPool(m_TimestampQueryPool);
+
+		m_ImageAvailableSemaphores.clear();
+		m_RenderFinishedSemaphores.clear();
+		m_InFlightFences.clear();
+		m_FrameSerials.clear();
+		m_TimestampsWritten.clear();
+		m_TimestampQueryPool = nullptr;
+	}
+
+	std::uint32_t FramePacer::beginFrame() {
+		auto waitStart = std::chrono::steady_clock::now();
+
+		vk::Result result = m_Device.waitForFences({ m_InFlightFences[m_CurrentFrame] }, true, ~0ULL);
+		if (result != vk::Result::eSuccess)
+			vk::throwResultException(result, "vk::Device::waitForFences");
+
+		m_FrameStart = std::chrono::steady_clock::now();
+
+		m_CompletedFrameSerial = std::max(m_CompletedFrameSerial, m_FrameSerials[m_CurrentFrame]);
+		readTimestamps(m_CurrentFrame);
+
+		m_LastTimings.m_WaitTime       = std::chrono::duration<double, std::milli>(m_FrameStart - waitStart).count();
+		m_FrameSerials[m_CurrentFrame] = ++m_FrameSerial;
+		return m_CurrentFrame;
+	}
+
+	void FramePacer::beginTimestamps(vk::CommandBuffer commandBuffer) {
+		if (!m_TimestampQueryPool)
+			return;
+
+		commandBuffer.resetQueryPool(m_TimestampQueryPool, m_CurrentFrame * 2, 2);
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, m_TimestampQueryPool, m_CurrentFrame * 2);
+	}
+
+	void FramePacer::endTimestamps(vk::CommandBuffer commandBuffer) {
+		if (!m_TimestampQueryPool)
+			return;
+
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_TimestampQueryPool, m_CurrentFrame * 2 + 1);
+		m_TimestampsWritten[m_CurrentFrame] = true;
+	}
+
+	vk::Fence FramePacer::prepareSubmit() {
+		vk::Fence fence = m_InFlightFences[m_CurrentFrame];
+		m_Device.resetFences({ fence });
+		return fence;
+	}
+
+	void FramePacer::endFrame() {
+		m_LastTimings.m_CPUTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_FrameStart).count();
+		m_CurrentFrame          = (m_CurrentFrame + 1) % m_FramesInFlight;
+	}
+
+	void FramePacer::skipFrame() {
+		if (m_TimestampQueryPool)
+			m_TimestampsWritten[m_CurrentFrame] = false;
+		m_CurrentFrame = (m_CurrentFrame + 1) % m_FramesInFlight;
+	}
+
+	void FramePacer::readTimestamps(std::uint32_t frame) {
+		if (!m_TimestampQueryPool || !m_TimestampsWritten[frame])
+			return;
+
+		m_TimestampsWritten[frame] = false;
+
+		// The fence of this frame slot has signaled, so the results are available and this never waits
+		std::uint64_t timestamps[2] = { 0, 0 };
+		vk::Result result           = m_Device.getQueryPoolResults(m_TimestampQueryPool, frame * 2, 2, sizeof(timestamps), timestamps, sizeof(std::uint64_t), vk::QueryResultFlagBits::e64);
+		if (result != vk::Result::eSuccess)
+			return;
+
+		std::uint64_t ticks     = ((timestamps[1] & m_TimestampMask) - (timestamps[0] & m_TimestampMask)) & m_TimestampMask;
+		m_LastTimings.m_GPUTime = static_cast<double>(ticks) * m_TimestampPeriod / 1'000'000.0;
+	}
+} // namespace Graphics
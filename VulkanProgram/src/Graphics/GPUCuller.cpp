@@ -0,0 +1,196 @@
+#include "Graphics/GPUCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Graphics {
+	namespace {
+		// Frustum planes of a Vulkan clip space with depth in [0, 1], normals point inwards and are normalized so plane distances are in world units
+		void ExtractFrustumPlanes(const Utils::Mat4& projView, float (&planes)[6][4]) {
+			auto row = [&projView](std::size_t r, std::size_t c) { return projView.m_Values[c * 4 + r]; };
+			for (std::size_t c = 0; c < 4; ++c) {
+				planes[0][c] = row(3, c) + row(0, c); // Left
+				planes[1][c] = row(3, c) - row(0, c); // Right
+				planes[2][c] = row(3, c) + row(1, c); // Bottom
+				planes[3][c] = row(3, c) - row(1, c); // Top
+				planes[4][c] = row(2, c);             // Near
+				planes[5][c] = row(3, c) - row(2, c); // Far
+			}
+
+			for (auto& plane : planes) {
+				float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+				if (length > 0.0f)
+					for (auto& value : plane) value /= length;
+			}
+		}
+	} // namespace
+
+	GPUCuller::GPUCuller(vk::Device device, VmaAllocator allocator, UploadManager& uploadManager, ShaderLibrary& shaderLibrary, vk::PipelineCache pipelineCache, std::uint32_t framesInFlight, IndirectDrawMode mode, std::uint32_t maxDrawCount)
+	    : m_Device(device), m_Allocator(allocator), m_UploadManager(uploadManager), m_FramesInFlight(std::max(framesInFlight, 1U)), m_Mode(mode), m_MaxDrawCount(std::max(maxDrawCount, 1U)), m_Pipeline(device, pipelineCache, shaderLibrary) { }
+
+	GPUCuller::~GPUCuller() {
+		if (isCreated())
+			destroy();
+	}
+
+	void GPUCuller::create() {
+		if (isCreated())
+			destroy();
+
+		// Binding 0 holds the objects, 1 the indirect draws, 2 the draw count and 3 the levels of detail. The vertex shader only reads the objects
+		std::vector<vk::DescriptorSetLayoutBinding> bindings = {
+			{ 0, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute | vk::ShaderStageFlagBits::eVertex, nullptr },
+			{ 1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr },
+			{ 2, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr },
+			{ 3, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr }
+		};
+		m_DescriptorSetLayout = m_Device.createDescriptorSetLayout({ {}, bindings });
+
+		std::vector<vk::DescriptorPoolSize> poolSizes = { { vk::DescriptorType::eStorageBuffer, 4 * m_FramesInFlight } };
+		m_DescriptorPool                              = m_Device.createDescriptorPool({ {}, m_FramesInFlight, poolSizes });
+
+		// A single small compute pipeline, compiling it up front is cheaper than tracking its state
+		ComputePipelineDesc desc;
+		desc.m_Shader           = "cull.comp.spv";
+		desc.m_LocalSize        = { 64, 1, 1 };
+		desc.m_SetLayouts       = { m_DescriptorSetLayout };
+		desc.m_PushConstantSize = sizeof(CullConstants);
+		m_Pipeline.create(desc);
+
+		std::vector<vk::DescriptorSetLayout> setLayouts(m_FramesInFlight, m_DescriptorSetLayout);
+		auto descriptorSets = m_Device.allocateDescriptorSets({ m_DescriptorPool, setLayouts });
+		m_Frames.resize(m_FramesInFlight);
+		for (std::uint32_t i = 0; i < m_FramesInFlight; ++i)
+			m_Frames[i].m_DescriptorSet = descriptorSets[i];
+	}
+
+	void GPUCuller::destroy() {
+		destroyBuffers();
+		m_Frames.clear();
+
+		m_Pipeline.destroy();
+		m_Device.destroyDescriptorPool(m_DescriptorPool);
+		m_Device.destroyDescriptorSetLayout(m_DescriptorSetLayout);
+
+		m_DescriptorPool      = nullptr;
+		m_DescriptorSetLayout = nullptr;
+	}
+
+	void GPUCuller::setObjects(const std::vector<CullObject>& objects, const std::vector<CullLOD>& lods) {
+		destroyBuffers();
+		if (objects.empty() || lods.empty())
+			return;
+		m_ObjectCount = static_cast<std::uint32_t>(objects.size());
+
+		vk::DeviceSize objectsSize  = sizeof(CullObject) * objects.size();
+		vk::DeviceSize lodsSize     = sizeof(CullLOD) * lods.size();
+		vk::DeviceSize commandsSize = sizeof(vk::DrawIndexedIndirectCommand) * objects.size();
+		m_ObjectBuffer              = createBuffer(objectsSize, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst, m_ObjectBufferAllocation);
+		m_LODBuffer                 = createBuffer(lodsSize, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst, m_LODBufferAllocation);
+		m_UploadManager.uploadBuffer(m_ObjectBuffer, 0, objects.data(), objectsSize, vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eVertexShader, vk::AccessFlagBits::eShaderRead);
+		m_UploadManager.uploadBuffer(m_LODBuffer, 0, lods.data(), lodsSize, vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderRead);
+
+		vk::DescriptorBufferInfo objectsInfo = { m_ObjectBuffer, 0, objectsSize };
+		vk::DescriptorBufferInfo lodsInfo    = { m_LODBuffer, 0, lodsSize };
+		std::vector<vk::DescriptorBufferInfo> bufferInfos;
+		bufferInfos.reserve(m_Frames.size() * 2);
+		std::vector<vk::WriteDescriptorSet> writeDescriptorSets;
+		for (auto& frame : m_Frames) {
+			frame.m_CommandBuffer   = createBuffer(commandsSize, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer, frame.m_CommandBufferAllocation);
+			frame.m_DrawCountBuffer = createBuffer(sizeof(std::uint32_t), vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst, frame.m_DrawCountBufferAllocation);
+
+			auto& commandsInfo  = bufferInfos.emplace_back(frame.m_CommandBuffer, 0, commandsSize);
+			auto& drawCountInfo = bufferInfos.emplace_back(frame.m_DrawCountBuffer, 0, sizeof(std::uint32_t));
+			writeDescriptorSets.push_back({ frame.m_DescriptorSet, 0, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &objectsInfo, nullptr });
+			writeDescriptorSets.push_back({ frame.m_DescriptorSet, 1, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &commandsInfo, nullptr });
+			writeDescriptorSets.push_back({ frame.m_DescriptorSet, 2, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &drawCountInfo, nullptr });
+			writeDescriptorSets.push_back({ frame.m_DescriptorSet, 3, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &lodsInfo, nullptr });
+		}
+		m_Device.updateDescriptorSets(writeDescriptorSets, {});
+	}
+
+	void GPUCuller::cull(vk::CommandBuffer commandBuffer, std::uint32_t frame, const Utils::Mat4& projView, float viewportHeight, float lodThreshold) {
+		if (m_ObjectCount == 0)
+			return;
+
+		auto& currentFrame = m_Frames[frame];
+
+		// The draw count is only accumulated by the shader, so it starts at 0 every frame
+		commandBuffer.fillBuffer(currentFrame.m_DrawCountBuffer, 0, sizeof(std::uint32_t), 0);
+		commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {}, vk::MemoryBarrier { vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite }, {}, {});
+
+		CullConstants constants;
+		ExtractFrustumPlanes(projView, constants.m_Planes);
+		const float* m           = projView.m_Values;
+		constants.m_DepthRow[0]  = m[3];
+		constants.m_DepthRow[1]  = m[7];
+		constants.m_DepthRow[2]  = m[11];
+		constants.m_DepthRow[3]  = m[15];
+		constants.m_ObjectCount  = m_ObjectCount;
+		constants.m_Compact      = isCompacted();
+		constants.m_PixelScale   = std::sqrt(m[1] * m[1] + m[5] * m[5] + m[9] * m[9]) * viewportHeight * 0.5f;
+		constants.m_LODThreshold = lodThreshold;
+
+		m_Pipeline.bind(commandBuffer, { currentFrame.m_DescriptorSet });
+		m_Pipeline.pushConstants(commandBuffer, constants);
+		m_Pipeline.dispatchThreads(commandBuffer, m_ObjectCount);
+
+		commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eDrawIndirect, {}, vk::MemoryBarrier { vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eIndirectCommandRead }, {}, {});
+	}
+
+	void GPUCuller::draw(vk::CommandBuffer commandBuffer, std::uint32_t frame) {
+		if (m_ObjectCount == 0)
+			return;
+
+		auto& currentFrame   = m_Frames[frame];
+		std::uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand);
+		if (isCompacted()) {
+			commandBuffer.drawIndexedIndirectCount(currentFrame.m_CommandBuffer, 0, currentFrame.m_DrawCountBuffer, 0, m_ObjectCount, stride);
+			return;
+		}
+
+		switch (m_Mode) {
+		case IndirectDrawMode::Count:
+		case IndirectDrawMode::Multi:
+			// A single call may draw at most 'maxDrawIndirectCount' commands
+			for (std::uint32_t first = 0; first < m_ObjectCount; first += m_MaxDrawCount)
+				commandBuffer.drawIndexedIndirect(currentFrame.m_CommandBuffer, static_cast<vk::DeviceSize>(first) * stride, std::min(m_ObjectCount - first, m_MaxDrawCount), stride);
+			break;
+		case IndirectDrawMode::Single:
+			for (std::uint32_t i = 0; i < m_ObjectCount; ++i)
+				commandBuffer.drawIndexedIndirect(currentFrame.m_CommandBuffer, static_cast<vk::DeviceSize>(i) * stride, 1, stride);
+			break;
+		}
+	}
+
+	vk::Buffer GPUCuller::createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, VmaAllocation& allocation) {
+		vk::BufferCreateInfo createInfo              = { {}, size, usage, vk::SharingMode::eExclusive, {} };
+		VmaAllocationCreateInfo allocationCreateInfo = {};
+		allocationCreateInfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+
+		VkBuffer buffer;
+		vk::Result result = static_cast<vk::Result>(vmaCreateBuffer(m_Allocator, reinterpret_cast<VkBufferCreateInfo*>(&createInfo), &allocationCreateInfo, &buffer, &allocation, nullptr));
+		if (result != vk::Result::eSuccess)
+			vk::throwResultException(result, "vmaCreateBuffer");
+		return buffer;
+	}
+
+	void GPUCuller::destroyBuffers() {
+		for (auto& frame : m_Frames) {
+			if (frame.m_CommandBuffer)
+				vmaDestroyBuffer(m_Allocator, frame.m_CommandBuffer, frame.m_CommandBufferAllocation);
+			if (frame.m_DrawCountBuffer)
+				vmaDestroyBuffer(m_Allocator, frame.m_DrawCountBuffer, frame.m_DrawCountBufferAllocation);
+			frame.m_CommandBuffer   = nullptr;
+			frame.m_DrawCountBuffer = nullptr;
+		}
+
+		if (m_ObjectBuffer)
+			vmaDestroyBuffer(m_Allocator, m_ObjectBuffer, m_ObjectBufferAllocation);
+		if (m_LODBuffer)
+			vmaDestroyBuffer(m_Allocator, m_LODBuffer, m_LODBufferAllocation);
+		m_ObjectBuffer = nullptr;
+		m_LODBuffer    = nullptr;
+		m_ObjectCount  = 0;
+	}
+} // namespace Graphics
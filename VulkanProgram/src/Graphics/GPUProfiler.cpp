@@ -0,0 +1,311 @@
+#include "Graphics/GPUProfiler.h"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace Graphics {
+	namespace {
+		// Escapes 'str' for a double quoted JSON string
+		void WriteJSONString(std::ostream& stream, std::string_view str) {
+			stream << '"';
+			for (char c : str) {
+				switch (c) {
+				case '"': stream << "\\\""; break;
+				case '\\': stream << "\\\\"; break;
+				case '\n': stream << "\\n"; break;
+				case '\t': stream << "\\t"; break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20)
+						stream << "\\u00" << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+					else
+						stream << c;
+					break;
+				}
+			}
+			stream << '"';
+		}
+
+		// Quotes 'str' as a CSV field, quotes inside it are doubled
+		void WriteCSVString(std::ostream& stream, std::string_view str) {
+			stream << '"';
+			for (char c : str) {
+				if (c == '"')
+					stream << '"';
+				stream << c;
+			}
+			stream << '"';
+		}
+	} // namespace
+
+	GPUProfiler::GPUProfiler(vk::Device device, vk::PhysicalDevice physicalDevice, std::uint32_t queueFamilyIndex, std::uint32_t framesInFlight, bool pipelineStatistics)
+	    : m_Device(device), m_PhysicalDevice(physicalDevice), m_QueueFamilyIndex(queueFamilyIndex), m_FramesInFlight(std::max(framesInFlight, 1U)), m_PipelineStatistics(pipelineStatistics) { }
+
+	GPUProfiler::~GPUProfiler() {
+		if (isCreated())
+			destroy();
+	}
+
+	void GPUProfiler::create() {
+		if (isCreated())
+			destroy();
+
+		// Create a begin and end timestamp for every scope of every frame in flight, if the queue supports timestamps
+		auto properties    = m_PhysicalDevice.getProperties();
+		auto queueFamilies = m_PhysicalDevice.getQueueFamilyProperties();
+		if (m_QueueFamilyIndex < queueFamilies.size()) {
+			std::uint32_t validBits = queueFamilies[m_QueueFamilyIndex].timestampValidBits;
+			if (validBits > 0 && properties.limits.timestampPeriod > 0.0f) {
+				m_TimestampPeriod    = properties.limits.timestampPeriod;
+				m_TimestampMask      = validBits >= 64 ? ~0ULL : ((1ULL << validBits) - 1);
+				m_TimestampQueryPool = m_Device.createQueryPool({ {}, vk::QueryType::eTimestamp, 2 * s_MaxScopes * m_FramesInFlight, {} });
+			}
+		}
+
+		// One pipeline statistics query per frame in flight spans the whole frame
+		if (m_PipelineStatistics)
+			m_StatisticsQueryPool = m_Device.createQueryPool({ {}, vk::QueryType::ePipelineStatistics, m_FramesInFlight, getPipelineStatisticFlags() });
+
+		m_Frames.clear();
+		m_Frames.resize(m_FramesInFlight);
+		m_CurrentFrame = 0;
+		m_OpenScopes   = 0;
+		m_FrameSerial  = 0;
+		m_HasEpoch     = false;
+		m_Created      = true;
+	}
+
+	void GPUProfiler::destroy() {
+		if (m_TimestampQueryPool)
+			m_Device.destroyQueryPool(m_TimestampQueryPool);
+		if (m_StatisticsQueryPool)
+			m_Device.destroyQueryPool(m_StatisticsQueryPool);
+
+		m_TimestampQueryPool  = nullptr;
+		m_StatisticsQueryPool = nullptr;
+		m_Frames.clear();
+		m_Created = false;
+	}
+
+	void GPUProfiler::beginFrame(vk::CommandBuffer commandBuffer, std::uint32_t frame) {
+		if (!m_Created)
+			return;
+
+		readResults(frame);
+
+		auto& currentFrame               = m_Frames[frame];
+		currentFrame.m_Serial            = ++m_FrameSerial;
+		currentFrame.m_Recorded          = true;
+		currentFrame.m_StatisticsWritten = false;
+		currentFrame.m_Scopes.clear();
+		m_CurrentFrame = frame;
+		m_OpenScopes   = 0;
+
+		if (m_TimestampQueryPool)
+			commandBuffer.resetQueryPool(m_TimestampQueryPool, frame * 2 * s_MaxScopes, 2 * s_MaxScopes);
+		if (m_StatisticsQueryPool) {
+			commandBuffer.resetQueryPool(m_StatisticsQueryPool, frame, 1);
+			commandBuffer.beginQuery(m_StatisticsQueryPool, frame, {});
+		}
+	}
+
+	void GPUProfiler::endFrame(vk::CommandBuffer commandBuffer) {
+		if (!m_StatisticsQueryPool)
+			return;
+
+		commandBuffer.endQuery(m_StatisticsQueryPool, m_CurrentFrame);
+		m_Frames[m_CurrentFrame].m_StatisticsWritten = true;
+	}
+
+	std::uint32_t GPUProfiler::beginScope(vk::CommandBuffer commandBuffer, std::string_view name) {
+		if (!m_TimestampQueryPool)
+			return s_InvalidScope;
+
+		auto& scopes = m_Frames[m_CurrentFrame].m_Scopes;
+		if (scopes.size() >= s_MaxScopes)
+			return s_InvalidScope;
+
+		auto scope = static_cast<std::uint32_t>(scopes.size());
+		scopes.push_back({ getNameId(name), m_OpenScopes++ });
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, m_TimestampQueryPool, (m_CurrentFrame * s_MaxScopes + scope) * 2);
+		return scope;
+	}
+
+	void GPUProfiler::endScope(vk::CommandBuffer commandBuffer, std::uint32_t scope) {
+		if (scope == s_InvalidScope)
+			return;
+
+		m_OpenScopes = m_OpenScopes > 0 ? m_OpenScopes - 1 : 0;
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_TimestampQueryPool, (m_CurrentFrame * s_MaxScopes + scope) * 2 + 1);
+	}
+
+	void GPUProfiler::resolve() {
+		// Oldest frame first, so the trace stays in submission order
+		for (std::uint32_t i = 1; i <= m_Frames.size(); ++i)
+			readResults((m_CurrentFrame + i) % static_cast<std::uint32_t>(m_Frames.size()));
+	}
+
+	void GPUProfiler::drawOverlay() const {
+		ImGui::SetNextWindowPos({ 10.0f, 10.0f }, ImGuiCond_FirstUseEver);
+		if (!ImGui::Begin("GPU Profiler", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+			ImGui::End();
+			return;
+		}
+
+		if (!m_TimestampQueryPool) {
+			ImGui::TextUnformatted("Timestamps are not supported by this queue");
+		} else if (ImGui::BeginTable("Scopes", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+			ImGui::TableSetupColumn("Scope");
+			ImGui::TableSetupColumn("Last ms");
+			ImGui::TableSetupColumn("Min ms");
+			ImGui::TableSetupColumn("Avg ms");
+			ImGui::TableSetupColumn("Max ms");
+			ImGui::TableHeadersRow();
+			for (auto& stats : m_Stats) {
+				ImGui::TableNextRow();
+				ImGui::TableSetColumnIndex(0);
+				ImGui::Text("%*s%s", static_cast<int>(stats.m_Depth * 2), "", stats.m_Name.c_str());
+				ImGui::TableSetColumnIndex(1);
+				ImGui::Text("%.3f", stats.m_Last);
+				ImGui::TableSetColumnIndex(2);
+				ImGui::Text("%.3f", stats.m_Min);
+				ImGui::TableSetColumnIndex(3);
+				ImGui::Text("%.3f", stats.m_Avg);
+				ImGui::TableSetColumnIndex(4);
+				ImGui::Text("%.3f", stats.m_Max);
+			}
+			ImGui::EndTable();
+		}
+
+		if (m_StatisticsQueryPool) {
+			auto& statistics = m_LastPipelineStatistics;
+			ImGui::Separator();
+			ImGui::Text("Input vertices:       %llu", static_cast<unsigned long long>(statistics.m_InputAssemblyVertices));
+			ImGui::Text("Input primitives:     %llu", static_cast<unsigned long long>(statistics.m_InputAssemblyPrimitives));
+			ImGui::Text("Vertex invocations:   %llu", static_cast<unsigned long long>(statistics.m_VertexShaderInvocations));
+			ImGui::Text("Clipping primitives:  %llu of %llu", static_cast<unsigned long long>(statistics.m_ClippingPrimitives), static_cast<unsigned long long>(statistics.m_ClippingInvocations));
+			ImGui::Text("Fragment invocations: %llu", static_cast<unsigned long long>(statistics.m_FragmentShaderInvocations));
+			ImGui::Text("Compute invocations:  %llu", static_cast<unsigned long long>(statistics.m_ComputeShaderInvocations));
+		}
+
+		ImGui::End();
+	}
+
+	bool GPUProfiler::writeCSV(const std::filesystem::path& path) const {
+		std::ofstream file(path, std::ios::trunc);
+		if (!file)
+			return false;
+
+		file << std::fixed << std::setprecision(6) << "frame,scope,depth,start_ms,duration_ms\n";
+		for (auto& event : m_Trace) {
+			file << event.m_Frame << ',';
+			WriteCSVString(file, m_Stats[event.m_Name].m_Name);
+			file << ',' << event.m_Depth << ',' << event.m_Start << ',' << event.m_Duration << '\n';
+		}
+		return static_cast<bool>(file);
+	}
+
+	bool GPUProfiler::writeJSON(const std::filesystem::path& path) const {
+		std::ofstream file(path, std::ios::trunc);
+		if (!file)
+			return false;
+
+		// Complete events on a single 'GPU' thread, nested scopes show up stacked below their parent. Times are in microseconds
+		file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+		for (auto& event : m_Trace) {
+			file << ",\n{\"name\":";
+			WriteJSONString(file, m_Stats[event.m_Name].m_Name);
+			file << ",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":" << event.m_Start * 1000.0 << ",\"dur\":" << event.m_Duration * 1000.0 << ",\"args\":{\"frame\":" << event.m_Frame << "}}";
+		}
+		file << "\n]}\n";
+		return static_cast<bool>(file);
+	}
+
+	vk::QueryPipelineStatisticFlags GPUProfiler::getPipelineStatisticFlags() const {
+		if (!m_PipelineStatistics)
+			return {};
+
+		// Only statistics without feature requirements, results are written in the order of the flag bits which matches 'GPUPipelineStatistics'
+		return vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices | vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives | vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+		       vk::QueryPipelineStatisticFlagBits::eClippingInvocations | vk::QueryPipelineStatisticFlagBits::eClippingPrimitives | vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations |
+		       vk::QueryPipelineStatisticFlagBits::eComputeShaderInvocations;
+	}
+
+	void GPUProfiler::readResults(std::uint32_t frame) {
+		auto& previousFrame = m_Frames[frame];
+		if (!previousFrame.m_Recorded)
+			return;
+
+		previousFrame.m_Recorded = false;
+
+		// The fence of this frame slot has signaled, so the results are available and this never waits.
+		// A scope that was begun but never ended leaves its query unavailable, which drops the timestamps of that frame
+		if (m_TimestampQueryPool && !previousFrame.m_Scopes.empty()) {
+			std::array<std::uint64_t, 2 * s_MaxScopes> timestamps;
+			auto queryCount   = static_cast<std::uint32_t>(previousFrame.m_Scopes.size() * 2);
+			vk::Result result = m_Device.getQueryPoolResults(m_TimestampQueryPool, frame * 2 * s_MaxScopes, queryCount, sizeof(std::uint64_t) * queryCount, timestamps.data(), sizeof(std::uint64_t), vk::QueryResultFlagBits::e64);
+			if (result == vk::Result::eSuccess) {
+				if (!m_HasEpoch) {
+					m_Epoch    = timestamps[0] & m_TimestampMask;
+					m_HasEpoch = true;
+				}
+
+				for (std::size_t i = 0; i < previousFrame.m_Scopes.size(); ++i) {
+					auto& scope         = previousFrame.m_Scopes[i];
+					std::uint64_t begin = timestamps[i * 2] & m_TimestampMask;
+					std::uint64_t end   = timestamps[i * 2 + 1] & m_TimestampMask;
+					double duration     = static_cast<double>((end - begin) & m_TimestampMask) * m_TimestampPeriod / 1'000'000.0;
+					double start        = static_cast<double>((begin - m_Epoch) & m_TimestampMask) * m_TimestampPeriod / 1'000'000.0;
+					addSample(scope.m_Name, scope.m_Depth, duration);
+
+					m_Trace.push_back({ previousFrame.m_Serial, scope.m_Name, scope.m_Depth, start, duration });
+					if (m_Trace.size() > s_MaxTraceEvents)
+						m_Trace.pop_front();
+				}
+			}
+		}
+
+		if (m_StatisticsQueryPool && previousFrame.m_StatisticsWritten) {
+			std::array<std::uint64_t, 7> values;
+			vk::Result result = m_Device.getQueryPoolResults(m_StatisticsQueryPool, frame, 1, sizeof(values), values.data(), sizeof(values), vk::QueryResultFlagBits::e64);
+			if (result == vk::Result::eSuccess)
+				m_LastPipelineStatistics = { values[0], values[1], values[2], values[3], values[4], values[5], values[6] };
+		}
+	}
+
+	void GPUProfiler::addSample(std::uint32_t name, std::uint32_t depth, double time) {
+		auto& history                     = m_Histories[name];
+		history.m_Samples[history.m_Next] = time;
+		history.m_Next                    = (history.m_Next + 1) % s_HistorySize;
+		history.m_Count                   = std::min(history.m_Count + 1, s_HistorySize);
+
+		auto& stats   = m_Stats[name];
+		stats.m_Depth = depth;
+		stats.m_Last  = time;
+		stats.m_Min   = time;
+		stats.m_Max   = time;
+
+		double sum = 0.0;
+		for (std::size_t i = 0; i < history.m_Count; ++i) {
+			stats.m_Min = std::min(stats.m_Min, history.m_Samples[i]);
+			stats.m_Max = std::max(stats.m_Max, history.m_Samples[i]);
+			sum += history.m_Samples[i];
+		}
+		stats.m_Avg = sum / static_cast<double>(history.m_Count);
+	}
+
+	std::uint32_t GPUProfiler::getNameId(std::string_view name) {
+		auto itr = m_NameIds.find(std::string(name));
+		if (itr != m_NameIds.end())
+			return itr->second;
+
+		auto id = static_cast<std::uint32_t>(m_Stats.size());
+		m_NameIds.emplace(name, id);
+		m_Stats.push_back({ std::string(name) });
+		m_Histories.emplace_back();
+		return id;
+	}
+} // namespace Graphics
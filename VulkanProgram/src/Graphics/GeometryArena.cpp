@@ -0,0 +1,176 @@
+#include "Graphics/GeometryArena.h"
+
+#include <algorithm>
+
+namespace Graphics {
+	GeometryArena::GeometryArena(vk::Device device, VmaAllocator allocator, DeletionQueue& deletionQueue, vk::BufferUsageFlags usage, vk::DeviceSize elementSize, std::uint32_t pageElementCount)
+	    : m_Device(device), m_Allocator(allocator), m_DeletionQueue(deletionQueue), m_Usage(usage), m_ElementSize(elementSize), m_PageElementCount(std::max(pageElementCount, 1U)) { }
+
+	GeometryArena::~GeometryArena() {
+		if (isCreated())
+			destroy();
+	}
+
+	void GeometryArena::create() {
+		if (isCreated())
+			destroy();
+
+		m_Pages.push_back(createPage(m_PageElementCount));
+		m_Created = true;
+	}
+
+	void GeometryArena::destroy() {
+		for (auto& page : m_Pages) {
+			vmaClearVirtualBlock(page.m_Block);
+			vmaDestroyVirtualBlock(page.m_Block);
+			vmaDestroyBuffer(m_Allocator, page.m_Buffer, page.m_Allocation);
+		}
+		m_Pages.clear();
+		m_Slots.clear();
+		m_FreeSlots.clear();
+		m_Created = false;
+	}
+
+	GeometryAllocation GeometryArena::allocate(std::uint32_t count) {
+		if (count == 0)
+			return InvalidGeometryAllocation;
+
+		Slot slot;
+		slot.m_Range = place(m_Pages, count, slot.m_Allocation);
+
+		if (m_FreeSlots.empty()) {
+			m_Slots.push_back(slot);
+			return static_cast<GeometryAllocation>(m_Slots.size() - 1);
+		}
+
+		GeometryAllocation allocation = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+		m_Slots[allocation] = slot;
+		return allocation;
+	}
+
+	void GeometryArena::free(GeometryAllocation allocation) {
+		if (allocation >= m_Slots.size() || !m_Slots[allocation].m_Allocation)
+			return;
+
+		auto& slot = m_Slots[allocation];
+		vmaVirtualFree(m_Pages[slot.m_Range.m_Page].m_Block, slot.m_Allocation);
+		slot = {};
+		m_FreeSlots.push_back(allocation);
+	}
+
+	bool GeometryArena::defragment(vk::CommandBuffer commandBuffer) {
+		std::vector<GeometryAllocation> live;
+		for (GeometryAllocation i = 0; i < m_Slots.size(); ++i)
+			if (m_Slots[i].m_Allocation)
+				live.push_back(i);
+		if (live.empty())
+			return false;
+
+		// Placing the largest allocations first leaves the fewest gaps
+		std::sort(live.begin(), live.end(), [this](GeometryAllocation lhs, GeometryAllocation rhs) { return m_Slots[lhs].m_Range.m_Count > m_Slots[rhs].m_Range.m_Count; });
+
+		// Transfer writes from uploads on this queue, and vertex input reads that waited on uploads from the transfer queue, have to finish before the copies read
+		vk::MemoryBarrier readBarrier = { vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eTransferRead };
+		commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eVertexInput, vk::PipelineStageFlagBits::eTransfer, {}, { readBarrier }, {}, {});
+
+		std::vector<Page> pages;
+		std::vector<std::vector<std::vector<vk::BufferCopy>>> copies(m_Pages.size()); // Indexed by old page, then new page
+		for (auto allocation : live) {
+			auto& slot = m_Slots[allocation];
+
+			VmaVirtualAllocation virtualAllocation;
+			GeometryRange range = place(pages, slot.m_Range.m_Count, virtualAllocation);
+
+			auto& pageCopies = copies[slot.m_Range.m_Page];
+			pageCopies.resize(pages.size());
+			pageCopies[range.m_Page].push_back({ getByteOffset(slot.m_Range), getByteOffset(range), slot.m_Range.m_Count * m_ElementSize });
+
+			slot.m_Allocation = virtualAllocation;
+			slot.m_Range      = range;
+		}
+
+		for (std::size_t oldPage = 0; oldPage < copies.size(); ++oldPage)
+			for (std::size_t newPage = 0; newPage < copies[oldPage].size(); ++newPage)
+				if (!copies[oldPage][newPage].empty())
+					commandBuffer.copyBuffer(m_Pages[oldPage].m_Buffer, pages[newPage].m_Buffer, copies[oldPage][newPage]);
+
+		vk::MemoryBarrier drawBarrier = { vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead };
+		commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eVertexInput, {}, { drawBarrier }, {}, {});
+
+		// Frames in flight and the copies above still read the old pages, their blocks only track free space and can go right away
+		for (auto& page : m_Pages) {
+			vmaClearVirtualBlock(page.m_Block);
+			vmaDestroyVirtualBlock(page.m_Block);
+			m_DeletionQueue.release(page.m_Buffer, page.m_Allocation);
+		}
+		m_Pages = std::move(pages);
+		++m_Generation;
+		return true;
+	}
+
+	GeometryRange GeometryArena::getRange(GeometryAllocation allocation) const {
+		if (allocation >= m_Slots.size())
+			return {};
+		return m_Slots[allocation].m_Range;
+	}
+
+	GeometryArenaStatistics GeometryArena::getStatistics() const {
+		GeometryArenaStatistics statistics;
+		statistics.m_PageCount = static_cast<std::uint32_t>(m_Pages.size());
+
+		vk::DeviceSize freeElements = 0;
+		for (auto& page : m_Pages) {
+			VmaDetailedStatistics blockStatistics;
+			vmaCalculateVirtualBlockStatistics(page.m_Block, &blockStatistics);
+
+			statistics.m_AllocationCount += blockStatistics.statistics.allocationCount;
+			statistics.m_FreeRangeCount += blockStatistics.unusedRangeCount;
+			statistics.m_CapacityBytes += page.m_Capacity * m_ElementSize;
+			statistics.m_UsedBytes += blockStatistics.statistics.allocationBytes * m_ElementSize;
+			if (blockStatistics.unusedRangeCount > 0)
+				statistics.m_LargestFreeRangeBytes = std::max(statistics.m_LargestFreeRangeBytes, blockStatistics.unusedRangeSizeMax * m_ElementSize);
+			freeElements += page.m_Capacity - blockStatistics.statistics.allocationBytes;
+		}
+
+		if (freeElements > 0)
+			statistics.m_Fragmentation = 1.0f - static_cast<float>(statistics.m_LargestFreeRangeBytes) / static_cast<float>(freeElements * m_ElementSize);
+		return statistics;
+	}
+
+	GeometryArena::Page GeometryArena::createPage(std::uint32_t capacity) {
+		Page page;
+		page.m_Capacity = capacity;
+
+		// The block counts elements, so its offsets are element indices
+		VmaVirtualBlockCreateInfo blockCreateInfo = {};
+		blockCreateInfo.size                      = capacity;
+		auto result                               = static_cast<vk::Result>(vmaCreateVirtualBlock(&blockCreateInfo, &page.m_Block));
+		if (result != vk::Result::eSuccess)
+			vk::throwResultException(result, "vmaCreateVirtualBlock");
+
+		vk::BufferCreateInfo createInfo      = { {}, capacity * m_ElementSize, m_Usage | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive, {} };
+		VkBufferCreateInfo createInfo_       = createInfo;
+		VmaAllocationCreateInfo allocateInfo = { {}, VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_ONLY, 0, 0, 0, 0, 0, 0.0f };
+
+		VkBuffer buffer;
+		page.m_Buffer = vk::createResultValue(static_cast<vk::Result>(vmaCreateBuffer(m_Allocator, &createInfo_, &allocateInfo, &buffer, &page.m_Allocation, nullptr)), buffer, "vmaCreateBuffer");
+		return page;
+	}
+
+	GeometryRange GeometryArena::place(std::vector<Page>& pages, std::uint32_t count, VmaVirtualAllocation& allocation) {
+		VmaVirtualAllocationCreateInfo allocationInfo = {};
+		allocationInfo.size                           = count;
+
+		VkDeviceSize offset;
+		for (std::uint32_t i = 0; i < pages.size(); ++i)
+			if (vmaVirtualAllocate(pages[i].m_Block, &allocationInfo, &allocation, &offset) == VK_SUCCESS)
+				return { i, static_cast<std::uint32_t>(offset), count };
+
+		pages.push_back(createPage(std::max(count, m_PageElementCount)));
+		auto result = static_cast<vk::Result>(vmaVirtualAllocate(pages.back().m_Block, &allocationInfo, &allocation, &offset));
+		if (result != vk::Result::eSuccess)
+			vk::throwResultException(result, "vmaVirtualAllocate");
+		return { static_cast<std::uint32_t>(pages.size() - 1), static_cast<std::uint32_t>(offset), count };
+	}
+} // namespace Graphics
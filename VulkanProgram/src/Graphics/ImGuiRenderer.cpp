@@ -0,0 +1,201 @@
+#include "Graphics/ImGuiRenderer.h"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace Graphics {
+	ImGuiRenderer::ImGuiRenderer(vk::Device device, VmaAllocator allocator, UploadManager& uploadManager, PipelineCompiler& pipelineCompiler, std::uint32_t framesInFlight)
+	    : m_Device(device), m_Allocator(allocator), m_UploadManager(uploadManager), m_PipelineCompiler(pipelineCompiler), m_FramesInFlight(std::max(framesInFlight, 1U)) { }
+
+	ImGuiRenderer::~ImGuiRenderer() {
+		if (isCreated())
+			destroy();
+	}
+
+	void ImGuiRenderer::create(vk::RenderPass renderPass, std::uint32_t subpass) {
+		if (isCreated())
+			destroy();
+
+		// Create the font texture from the atlas ImGui builds for the current context
+		{
+			unsigned char* pixels = nullptr;
+			int width             = 0;
+			int height            = 0;
+			ImGui::GetIO().Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+			vk::ImageCreateInfo createInfo       = { {}, vk::ImageType::e2D, vk::Format::eR8G8B8A8Unorm, { static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height), 1 }, 1, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled, vk::SharingMode::eExclusive, {}, vk::ImageLayout::eUndefined };
+			VkImageCreateInfo createInfo_        = createInfo;
+			VmaAllocationCreateInfo allocateInfo = { {}, VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_ONLY, 0, 0, 0, 0, 0, 0.0f };
+
+			VkImage image;
+			m_FontImage     = vk::createResultValue(static_cast<vk::Result>(vmaCreateImage(m_Allocator, &createInfo_, &allocateInfo, &image, &m_FontImageAllocation, nullptr)), image, "vmaCreateImage");
+			m_FontImageView = m_Device.createImageView({ {}, m_FontImage, vk::ImageViewType::e2D, createInfo.format, {}, { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 } });
+			m_FontSampler   = m_Device.createSampler({ {}, vk::Filter::eLinear, vk::Filter::eLinear, vk::SamplerMipmapMode::eLinear, vk::SamplerAddressMode::eClampToEdge, vk::SamplerAddressMode::eClampToEdge, vk::SamplerAddressMode::eClampToEdge, 0.0f, false, 0.0f, false, vk::CompareOp::eAlways, 0.0f, 0.0f, vk::BorderColor::eIntOpaqueBlack, false });
+
+			m_UploadManager.uploadImage(m_FontImage, { vk::ImageAspectFlagBits::eColor, 0, 0, 1 }, createInfo.extent, pixels, static_cast<vk::DeviceSize>(width) * height * 4, vk::ImageLayout::eShaderReadOnlyOptimal, vk::PipelineStageFlagBits::eFragmentShader, vk::AccessFlagBits::eShaderRead);
+		}
+
+		// The font texture is the only texture, so one set serves every frame
+		std::vector<vk::DescriptorSetLayoutBinding> bindings = { { 0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment, nullptr } };
+		m_SetLayout                                          = m_Device.createDescriptorSetLayout({ {}, bindings });
+
+		std::vector<vk::DescriptorPoolSize> poolSizes = { { vk::DescriptorType::eCombinedImageSampler, 1 } };
+		m_DescriptorPool                              = m_Device.createDescriptorPool({ {}, 1, poolSizes });
+		m_DescriptorSet                               = m_Device.allocateDescriptorSets({ m_DescriptorPool, m_SetLayout })[0];
+
+		vk::DescriptorImageInfo imageInfo = { m_FontSampler, m_FontImageView, vk::ImageLayout::eShaderReadOnlyOptimal };
+		m_Device.updateDescriptorSets({ { m_DescriptorSet, 0, 0, 1, vk::DescriptorType::eCombinedImageSampler, &imageInfo, nullptr, nullptr } }, {});
+
+		std::vector<vk::PushConstantRange> pushConstantRanges = { { vk::ShaderStageFlagBits::eVertex, 0, sizeof(PushConstants) } };
+		m_PipelineLayout                                      = m_Device.createPipelineLayout({ {}, m_SetLayout, pushConstantRanges });
+
+		// ImGui draws back to front with alpha blending and relies on the scissor for clipping, so depth and culling are off
+		GraphicsPipelineDesc desc;
+		desc.m_VertexShader     = "imgui.vert.spv";
+		desc.m_FragmentShader   = "imgui.frag.spv";
+		desc.m_VertexBindings   = { { 0, sizeof(ImDrawVert), vk::VertexInputRate::eVertex } };
+		desc.m_VertexAttributes = { { 0, 0, vk::Format::eR32G32Sfloat, offsetof(ImDrawVert, pos) }, { 1, 0, vk::Format::eR32G32Sfloat, offsetof(ImDrawVert, uv) }, { 2, 0, vk::Format::eR8G8B8A8Unorm, offsetof(ImDrawVert, col) } };
+		desc.m_CullMode         = vk::CullModeFlagBits::eNone;
+		desc.m_DepthTest        = false;
+		desc.m_DepthWrite       = false;
+		desc.m_BlendEnable      = true;
+		desc.m_Layout           = m_PipelineLayout;
+		desc.m_RenderPass       = renderPass;
+		desc.m_Subpass          = subpass;
+		m_Pipeline              = m_PipelineCompiler.request(desc);
+
+		m_Frames.resize(m_FramesInFlight);
+	}
+
+	void ImGuiRenderer::destroy() {
+		for (auto& frame : m_Frames) {
+			destroyBuffer(frame.m_VertexBuffer);
+			destroyBuffer(frame.m_IndexBuffer);
+		}
+		m_Frames.clear();
+
+		// The pipeline belongs to the compiler and is destroyed with it
+		m_Device.destroyPipelineLayout(m_PipelineLayout);
+		m_Device.destroyDescriptorPool(m_DescriptorPool);
+		m_Device.destroyDescriptorSetLayout(m_SetLayout);
+		m_Device.destroySampler(m_FontSampler);
+		m_Device.destroyImageView(m_FontImageView);
+		if (m_FontImage)
+			vmaDestroyImage(m_Allocator, m_FontImage, m_FontImageAllocation);
+
+		m_PipelineLayout      = nullptr;
+		m_DescriptorPool      = nullptr;
+		m_DescriptorSet       = nullptr;
+		m_SetLayout           = nullptr;
+		m_FontSampler         = nullptr;
+		m_FontImageView       = nullptr;
+		m_FontImage           = nullptr;
+		m_FontImageAllocation = nullptr;
+		m_Pipeline            = PipelineCompiler::s_InvalidHandle;
+	}
+
+	void ImGuiRenderer::record(vk::CommandBuffer commandBuffer, std::uint32_t frame, const ImDrawData* drawData) {
+		if (!drawData || drawData->TotalVtxCount == 0)
+			return;
+
+		vk::Pipeline pipeline = m_PipelineCompiler.getPipeline(m_Pipeline);
+		if (!pipeline)
+			return;
+
+		float width  = drawData->DisplaySize.x * drawData->FramebufferScale.x;
+		float height = drawData->DisplaySize.y * drawData->FramebufferScale.y;
+		if (width <= 0.0f || height <= 0.0f)
+			return;
+
+		// Copy every draw list into one vertex and one index buffer, the draws offset into them
+		auto& currentFrame        = m_Frames[frame];
+		vk::DeviceSize vertexSize = sizeof(ImDrawVert) * static_cast<vk::DeviceSize>(drawData->TotalVtxCount);
+		vk::DeviceSize indexSize  = sizeof(ImDrawIdx) * static_cast<vk::DeviceSize>(drawData->TotalIdxCount);
+		reserve(currentFrame.m_VertexBuffer, vertexSize, vk::BufferUsageFlagBits::eVertexBuffer);
+		reserve(currentFrame.m_IndexBuffer, indexSize, vk::BufferUsageFlagBits::eIndexBuffer);
+
+		auto vertices = static_cast<ImDrawVert*>(currentFrame.m_VertexBuffer.m_Data);
+		auto indices  = static_cast<ImDrawIdx*>(currentFrame.m_IndexBuffer.m_Data);
+		for (int i = 0; i < drawData->CmdListsCount; ++i) {
+			const ImDrawList* drawList = drawData->CmdLists[i];
+			std::memcpy(vertices, drawList->VtxBuffer.Data, sizeof(ImDrawVert) * drawList->VtxBuffer.Size);
+			std::memcpy(indices, drawList->IdxBuffer.Data, sizeof(ImDrawIdx) * drawList->IdxBuffer.Size);
+			vertices += drawList->VtxBuffer.Size;
+			indices += drawList->IdxBuffer.Size;
+		}
+		vmaFlushAllocation(m_Allocator, currentFrame.m_VertexBuffer.m_Allocation, 0, vertexSize);
+		vmaFlushAllocation(m_Allocator, currentFrame.m_IndexBuffer.m_Allocation, 0, indexSize);
+
+		PushConstants constants;
+		constants.m_Scale[0]     = 2.0f / drawData->DisplaySize.x;
+		constants.m_Scale[1]     = 2.0f / drawData->DisplaySize.y;
+		constants.m_Translate[0] = -1.0f - drawData->DisplayPos.x * constants.m_Scale[0];
+		constants.m_Translate[1] = -1.0f - drawData->DisplayPos.y * constants.m_Scale[1];
+
+		commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+		commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_PipelineLayout, 0, m_DescriptorSet, {});
+		commandBuffer.bindVertexBuffers(0, currentFrame.m_VertexBuffer.m_Buffer, 0ULL);
+		commandBuffer.bindIndexBuffer(currentFrame.m_IndexBuffer.m_Buffer, 0, sizeof(ImDrawIdx) == 2 ? vk::IndexType::eUint16 : vk::IndexType::eUint32);
+		commandBuffer.pushConstants(m_PipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(constants), &constants);
+		commandBuffer.setViewport(0, { { 0.0f, 0.0f, width, height, 0.0f, 1.0f } });
+		commandBuffer.setLineWidth(1.0f);
+
+		// Clip rectangles are in display coordinates, the scissor is in framebuffer pixels
+		ImVec2 clipOffset         = drawData->DisplayPos;
+		ImVec2 clipScale          = drawData->FramebufferScale;
+		std::uint32_t indexOffset = 0;
+		std::int32_t vertexOffset = 0;
+		for (int i = 0; i < drawData->CmdListsCount; ++i) {
+			const ImDrawList* drawList = drawData->CmdLists[i];
+			for (auto& drawCommand : drawList->CmdBuffer) {
+				// The overlay doesn't use callbacks, so there's no render state to reset either
+				if (drawCommand.UserCallback)
+					continue;
+
+				float minX = std::max((drawCommand.ClipRect.x - clipOffset.x) * clipScale.x, 0.0f);
+				float minY = std::max((drawCommand.ClipRect.y - clipOffset.y) * clipScale.y, 0.0f);
+				float maxX = std::min((drawCommand.ClipRect.z - clipOffset.x) * clipScale.x, width);
+				float maxY = std::min((drawCommand.ClipRect.w - clipOffset.y) * clipScale.y, height);
+				if (maxX <= minX || maxY <= minY)
+					continue;
+
+				commandBuffer.setScissor(0, { { { static_cast<std::int32_t>(minX), static_cast<std::int32_t>(minY) }, { static_cast<std::uint32_t>(maxX - minX), static_cast<std::uint32_t>(maxY - minY) } } });
+				commandBuffer.drawIndexed(drawCommand.ElemCount, 1, indexOffset + drawCommand.IdxOffset, vertexOffset + static_cast<std::int32_t>(drawCommand.VtxOffset), 0);
+			}
+			indexOffset += static_cast<std::uint32_t>(drawList->IdxBuffer.Size);
+			vertexOffset += drawList->VtxBuffer.Size;
+		}
+	}
+
+	void ImGuiRenderer::reserve(Buffer& buffer, vk::DeviceSize size, vk::BufferUsageFlags usage) {
+		if (buffer.m_Size >= size)
+			return;
+
+		// Grow geometrically so a growing overlay doesn't recreate the buffer every frame
+		vk::DeviceSize newSize = std::max<vk::DeviceSize>(size, buffer.m_Size * 2);
+		destroyBuffer(buffer);
+
+		vk::BufferCreateInfo createInfo              = { {}, newSize, usage, vk::SharingMode::eExclusive, {} };
+		VmaAllocationCreateInfo allocationCreateInfo = {};
+		allocationCreateInfo.flags                   = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+		allocationCreateInfo.usage                   = VMA_MEMORY_USAGE_CPU_TO_GPU;
+
+		VkBuffer vkBuffer;
+		VmaAllocationInfo allocationInfo;
+		vk::Result result = static_cast<vk::Result>(vmaCreateBuffer(m_Allocator, reinterpret_cast<VkBufferCreateInfo*>(&createInfo), &allocationCreateInfo, &vkBuffer, &buffer.m_Allocation, &allocationInfo));
+		if (result != vk::Result::eSuccess)
+			vk::throwResultException(result, "vmaCreateBuffer");
+		buffer.m_Buffer = vkBuffer;
+		buffer.m_Size   = newSize;
+		buffer.m_Data   = allocationInfo.pMappedData;
+	}
+
+	void ImGuiRenderer::destroyBuffer(Buffer& buffer) {
+		if (buffer.m_Buffer)
+			vmaDestroyBuffer(m_Allocator, buffer.m_Buffer, buffer.m_Allocation);
+		buffer = {};
+	}
+} // namespace Graphics
@@ -1,14 +1,109 @@
 #include "Graphics/Instance.h"
+#include "Utils/StringInterner.h"
 
+#include <cstdlib>
+
+#include <fstream>
+#include <string>
+#include <system_error>
 #include <utility>
 
 namespace Graphics {
+	namespace {
+		constexpr std::uint32_t s_SnapshotFormatVersion = 1;
+
+		// Views the name in a fixed size, null terminated Vulkan array
+		template <class Array>
+		std::string_view GetName(const Array& name) {
+			return std::string_view(name.data(), std::char_traits<char>::length(name.data()));
+		}
+
+		// Enables every requested layer the table of available layers has in a high enough version, and records the required ones it lacks
+		void NegotiateLayers(const InstanceLayerTable& requested, const InstanceLayerTable& available, InstanceLayerTable& enabled, std::vector<const char*>& enabledNames, std::vector<InstanceLayer>& missing) {
+			for (auto& layer : requested.getLayers()) {
+				auto availableLayer = available.findInterned(layer.m_Name);
+				if (availableLayer && availableLayer->m_Version >= layer.m_Version) {
+					enabled.insert(*availableLayer);
+					enabledNames.push_back(availableLayer->m_Name);
+				} else if (layer.m_Required) {
+					missing.push_back(layer);
+				}
+			}
+		}
+
+		// FNV-1a over 'size' bytes
+		void HashBytes(std::uint64_t& hash, const void* data, std::size_t size) {
+			auto bytes = static_cast<const std::uint8_t*>(data);
+			for (std::size_t i = 0; i < size; ++i)
+				hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+		}
+
+		bool ReadTable(std::istream& stream, InstanceLayerTable& table) {
+			std::size_t count = 0;
+			if (!(stream >> count))
+				return false;
+
+			table.reserve(count);
+			for (std::size_t i = 0; i < count; ++i) {
+				std::string name;
+				std::uint32_t version;
+				if (!(stream >> name >> version))
+					return false;
+				table.insert({ name, version });
+			}
+			return true;
+		}
+
+		void WriteTable(std::ostream& stream, const InstanceLayerTable& table) {
+			stream << table.size() << '\n';
+			for (auto& layer : table.getLayers())
+				stream << layer.m_Name << ' ' << layer.m_Version.m_Version << '\n';
+		}
+	} // namespace
+
 	InstanceLayer::InstanceLayer(std::string_view name, Version version, bool required)
-	    : m_Name(name), m_Version(version), m_Required(required) { }
+	    : m_Name(Utils::StringInterner::Get().intern(name)), m_Version(version), m_Required(required) { }
+
+	InstanceLayer* InstanceLayerTable::findInterned(const char* name) {
+		auto itr = m_Indices.find(name);
+		return itr != m_Indices.end() ? &m_Layers[itr->second] : nullptr;
+	}
+
+	const InstanceLayer* InstanceLayerTable::findInterned(const char* name) const {
+		auto itr = m_Indices.find(name);
+		return itr != m_Indices.end() ? &m_Layers[itr->second] : nullptr;
+	}
+
+	const InstanceLayer* InstanceLayerTable::find(std::string_view name) const {
+		// A name that was never interned can't be the name of any entry
+		const char* internedName = Utils::StringInterner::Get().find(name);
+		return internedName ? findInterned(internedName) : nullptr;
+	}
+
+	void InstanceLayerTable::insert(const InstanceLayer& layer) {
+		auto [itr, inserted] = m_Indices.emplace(layer.m_Name, m_Layers.size());
+		if (inserted)
+			m_Layers.push_back(layer);
+		else
+			m_Layers[itr->second] = layer;
+	}
+
+	void InstanceLayerTable::reserve(std::size_t count) {
+		m_Layers.reserve(count);
+		m_Indices.reserve(count);
+	}
+
+	void InstanceLayerTable::clear() {
+		m_Layers.clear();
+		m_Indices.clear();
+	}
 
 	Version Instance::s_CachedVersion;
-	std::vector<InstanceLayer> Instance::s_CachedAvailableLayers;
-	std::vector<InstanceLayer> Instance::s_CachedAvailableExtensions;
+	InstanceLayerTable Instance::s_CachedAvailableLayers;
+	InstanceLayerTable Instance::s_CachedAvailableExtensions;
+	bool Instance::s_LayersEnumerated        = false;
+	bool Instance::s_ExtensionsEnumerated    = false;
+	bool Instance::s_EnumerationFromSnapshot = false;
 
 	Version Instance::GetVulkanVersion() {
 		if (!s_CachedVersion) {
@@ -24,55 +119,117 @@ namespace Graphics {
 	}
 
 	const std::vector<InstanceLayer>& Instance::GetAvailableLayers(bool requery) {
-		if (requery || s_CachedAvailableLayers.empty()) {
-			s_CachedAvailableLayers.clear();
+		if (requery || !s_LayersEnumerated) {
 			auto properties = vk::enumerateInstanceLayerProperties();
+			s_CachedAvailableLayers.clear();
 			s_CachedAvailableLayers.reserve(properties.size());
-			for (std::size_t i = 0; i < properties.size(); ++i) {
-				auto& property = properties[i];
-				std::string layerName(property.layerName.size(), '\0');
-				std::memcpy(layerName.data(), property.layerName.data(), property.layerName.size());
-				auto end = layerName.find_first_of('\0');
-				if (end < layerName.size())
-					layerName.resize(end);
-
-				s_CachedAvailableLayers.emplace_back(std::move(layerName), property.implementationVersion);
-			}
+			for (auto& property : properties)
+				s_CachedAvailableLayers.insert({ GetName(property.layerName), property.implementationVersion });
+
+			s_LayersEnumerated        = true;
+			s_EnumerationFromSnapshot = false;
 		}
-		return s_CachedAvailableLayers;
+		return s_CachedAvailableLayers.getLayers();
 	}
 
 	const std::vector<InstanceExtension>& Instance::GetAvailableExtensions(bool requery) {
-		if (requery || s_CachedAvailableExtensions.empty()) {
-			s_CachedAvailableExtensions.clear();
+		if (requery || !s_ExtensionsEnumerated) {
 			auto properties = vk::enumerateInstanceExtensionProperties();
+			s_CachedAvailableExtensions.clear();
 			s_CachedAvailableExtensions.reserve(properties.size());
-			for (std::size_t i = 0; i < properties.size(); ++i) {
-				auto& property = properties[i];
-				std::string extensionName(property.extensionName.size(), '\0');
-				std::memcpy(extensionName.data(), property.extensionName.data(), property.extensionName.size());
-				auto end = extensionName.find_first_of('\0');
-				if (end < extensionName.size())
-					extensionName.resize(end);
-
-				s_CachedAvailableExtensions.emplace_back(extensionName, property.specVersion);
-			}
+			for (auto& property : properties)
+				s_CachedAvailableExtensions.insert({ GetName(property.extensionName), property.specVersion });
+
+			s_ExtensionsEnumerated    = true;
+			s_EnumerationFromSnapshot = false;
 		}
-		return s_CachedAvailableExtensions;
+		return s_CachedAvailableExtensions.getLayers();
 	}
 
 	bool Instance::HasLayer(std::string_view name, Version lowestVersion) {
-		for (auto& layer : s_CachedAvailableLayers)
-			if (layer.m_Name == name && layer.m_Version > lowestVersion)
-				return true;
-		return false;
+		GetAvailableLayers();
+		auto layer = s_CachedAvailableLayers.find(name);
+		return layer && layer->m_Version >= lowestVersion;
 	}
 
 	bool Instance::HasExtension(std::string_view name, Version lowestVersion) {
-		for (auto& extension : s_CachedAvailableExtensions)
-			if (extension.m_Name == name && extension.m_Version > lowestVersion)
-				return true;
-		return false;
+		GetAvailableExtensions();
+		auto extension = s_CachedAvailableExtensions.find(name);
+		return extension && extension->m_Version >= lowestVersion;
+	}
+
+	bool Instance::LoadEnumerationSnapshot(const std::filesystem::path& path) {
+		std::ifstream file = std::ifstream(path);
+		if (!file.is_open())
+			return false;
+
+		std::string magic;
+		std::uint32_t formatVersion = 0;
+		std::uint64_t key           = 0;
+		if (!(file >> magic >> formatVersion >> key) || magic != "InstanceEnumeration" || formatVersion != s_SnapshotFormatVersion || key != GetEnumerationKey())
+			return false;
+
+		InstanceLayerTable layers;
+		InstanceLayerTable extensions;
+		if (!ReadTable(file, layers) || !ReadTable(file, extensions))
+			return false;
+
+		s_CachedAvailableLayers     = std::move(layers);
+		s_CachedAvailableExtensions = std::move(extensions);
+		s_LayersEnumerated          = true;
+		s_ExtensionsEnumerated      = true;
+		s_EnumerationFromSnapshot   = true;
+		return true;
+	}
+
+	bool Instance::SaveEnumerationSnapshot(const std::filesystem::path& path) {
+		GetAvailableLayers();
+		GetAvailableExtensions();
+
+		std::filesystem::path tempPath = path;
+		tempPath += ".tmp";
+
+		{
+			std::ofstream file = std::ofstream(tempPath, std::ios::trunc);
+			if (!file.is_open())
+				return false;
+
+			file << "InstanceEnumeration " << s_SnapshotFormatVersion << ' ' << GetEnumerationKey() << '\n';
+			WriteTable(file, s_CachedAvailableLayers);
+			WriteTable(file, s_CachedAvailableExtensions);
+			file.flush();
+			if (!file) {
+				file.close();
+				std::error_code ec;
+				std::filesystem::remove(tempPath, ec);
+				return false;
+			}
+		}
+
+		// Renaming over the old snapshot replaces it atomically, like the pipeline cache
+		std::error_code ec;
+		std::filesystem::rename(tempPath, path, ec);
+		if (ec) {
+			std::filesystem::remove(tempPath, ec);
+			return false;
+		}
+		return true;
+	}
+
+	std::uint64_t Instance::GetEnumerationKey() {
+		// Hashes the loader version and the environment variables that add, remove or redirect layers and drivers.
+		// Installing a layer without touching any of them goes unnoticed, 'createImpl' enumerates again if the snapshot turns out stale
+		std::uint64_t hash = 0xCBF29CE484222325ULL;
+
+		std::uint32_t version = GetVulkanVersion();
+		HashBytes(hash, &version, sizeof(version));
+		for (const char* variable : { "VK_LAYER_PATH", "VK_ADD_LAYER_PATH", "VK_INSTANCE_LAYERS", "VK_LOADER_LAYERS_ENABLE", "VK_LOADER_LAYERS_DISABLE", "VK_ICD_FILENAMES", "VK_DRIVER_FILES", "VK_ADD_DRIVER_FILES" }) {
+			const char* value = std::getenv(variable);
+			if (value)
+				HashBytes(hash, value, std::char_traits<char>::length(value));
+			HashBytes(hash, "", 1);
+		}
+		return hash;
 	}
 
 	Instance::Instance(std::string_view appName, Version appVersion, std::string_view engineName, Version engineVersion, Version minAPIVersion, Version maxAPIVersion)
@@ -84,47 +241,35 @@ namespace Graphics {
 	}
 
 	void Instance::requestLayer(std::string_view name, Version requiredVersion, bool required) {
-		auto itr = std::find_if(m_Layers.begin(), m_Layers.end(), [name](const InstanceLayer& layer) -> bool {
-			return layer.m_Name == name;
-		});
-
-		if (itr != m_Layers.end()) {
-			auto& layer = *itr;
-			if (requiredVersion < layer.m_Version)
-				layer.m_Version = requiredVersion;
-			layer.m_Required = required;
+		InstanceLayer request = { name, requiredVersion, required };
+		if (auto layer = m_Layers.findInterned(request.m_Name)) {
+			if (requiredVersion < layer->m_Version)
+				layer->m_Version = requiredVersion;
+			layer->m_Required = required;
 		} else {
-			m_Layers.emplace_back(name, requiredVersion, required);
+			m_Layers.insert(request);
 		}
 	}
 
 	void Instance::requestExtension(std::string_view name, Version requiredVersion, bool required) {
-		auto itr = std::find_if(m_Extensions.begin(), m_Extensions.end(), [name](const InstanceExtension& extension) -> bool {
-			return extension.m_Name == name;
-		});
-
-		if (itr != m_Extensions.end()) {
-			auto& extension = *itr;
-			if (requiredVersion < extension.m_Version)
-				extension.m_Version = requiredVersion;
-			extension.m_Required = required;
+		InstanceExtension request = { name, requiredVersion, required };
+		if (auto extension = m_Extensions.findInterned(request.m_Name)) {
+			if (requiredVersion < extension->m_Version)
+				extension->m_Version = requiredVersion;
+			extension->m_Required = required;
 		} else {
-			m_Extensions.emplace_back(name, requiredVersion, required);
+			m_Extensions.insert(request);
 		}
 	}
 
 	Version Instance::getLayerVersion(std::string_view name) const {
-		for (auto& layer : m_EnabledLayers)
-			if (layer.m_Name == name)
-				return layer.m_Version;
-		return {};
+		auto layer = m_EnabledLayers.find(name);
+		return layer ? layer->m_Version : Version {};
 	}
 
 	Version Instance::getExtensionVersion(std::string_view name) const {
-		for (auto& extension : m_EnabledExtensions)
-			if (extension.m_Name == name)
-				return extension.m_Version;
-		return {};
+		auto extension = m_EnabledExtensions.find(name);
+		return extension ? extension->m_Version : Version {};
 	}
 
 	void Instance::createImpl() {
@@ -138,69 +283,61 @@ namespace Graphics {
 		else if (vulkanVersion >= m_MinAPIVersion)
 			instanceVersion = m_MinAPIVersion;
 
-		m_MissingLayers.clear();
-		m_MissingExtensions.clear();
-		GetAvailableLayers();
-		for (auto& layer : m_Layers) {
-			bool found = false;
-			for (auto& availLayer : s_CachedAvailableLayers) {
-				if (availLayer.m_Name == layer.m_Name && availLayer.m_Version > layer.m_Version) {
-					m_EnabledLayers.push_back(availLayer);
-					found = true;
-					break;
-				}
-			}
-			if (found) continue;
-			if (layer.m_Required)
-				m_MissingLayers.push_back(layer);
-		}
+		// A stale snapshot can also lack layers or extensions that were installed since, so a failed negotiation is retried with a real enumeration
+		if (!negotiate()) {
+			if (!s_EnumerationFromSnapshot)
+				return;
 
-		GetAvailableExtensions();
-		for (auto& extension : m_Extensions) {
-			bool found = false;
-			for (auto& availExtension : s_CachedAvailableExtensions) {
-				if (availExtension.m_Name == extension.m_Name && availExtension.m_Version > extension.m_Version) {
-					m_EnabledExtensions.push_back(availExtension);
-					found = true;
-					break;
-				}
-			}
-			if (found) continue;
-			if (extension.m_Required)
-				m_MissingExtensions.push_back(extension);
+			GetAvailableLayers(true);
+			GetAvailableExtensions(true);
+			if (!negotiate())
+				return;
 		}
 
-		if (!m_MissingLayers.empty() || !m_MissingExtensions.empty())
-			return;
-
-		std::vector<const char*> useLayers(m_EnabledLayers.size());
-		std::vector<const char*> useExtensions(m_EnabledExtensions.size());
+		vk::ApplicationInfo appInfo = { m_AppName.c_str(), m_AppVersion, m_EngineName.c_str(), m_EngineVersion, instanceVersion };
 
-		for (std::size_t i = 0; i < useLayers.size(); ++i) {
-			auto& layer = m_EnabledLayers[i];
-			char* buf   = new char[layer.m_Name.size() + 1] { 0 };
-			std::memcpy(buf, layer.m_Name.c_str(), layer.m_Name.size());
-			useLayers[i] = buf;
-		}
+		// The names are interned, so they outlive the create info without being copied
+		vk::InstanceCreateInfo createInfo = { {}, &appInfo, m_EnabledLayerNames, m_EnabledExtensionNames };
 
-		for (std::size_t i = 0; i < useExtensions.size(); ++i) {
-			auto& extension = m_EnabledExtensions[i];
-			char* buf       = new char[extension.m_Name.size() + 1] { 0 };
-			std::memcpy(buf, extension.m_Name.c_str(), extension.m_Name.size());
-			useExtensions[i] = buf;
-		}
-
-		vk::ApplicationInfo appInfo = { m_AppName.c_str(), m_AppVersion, m_EngineName.c_str(), m_EngineVersion, instanceVersion };
+		try {
+			m_Handle = vk::createInstance(createInfo);
+		} catch (const vk::SystemError& error) {
+			// A stale snapshot can offer layers or extensions the loader no longer has, enumerate for real and negotiate once more
+			bool notPresent = error.code() == vk::Result::eErrorLayerNotPresent || error.code() == vk::Result::eErrorExtensionNotPresent;
+			if (!notPresent || !s_EnumerationFromSnapshot)
+				throw;
 
-		vk::InstanceCreateInfo createInfo = { {}, &appInfo, useLayers, useExtensions };
+			GetAvailableLayers(true);
+			GetAvailableExtensions(true);
+			if (!negotiate())
+				return;
 
-		m_Handle = vk::createInstance(createInfo);
+			createInfo = { {}, &appInfo, m_EnabledLayerNames, m_EnabledExtensionNames };
+			m_Handle   = vk::createInstance(createInfo);
+		}
+		m_APIVersion = instanceVersion;
 	}
 
 	bool Instance::destroyImpl() {
 		m_Handle.destroy();
+		m_APIVersion = {};
 		m_EnabledLayers.clear();
 		m_EnabledExtensions.clear();
 		return true;
 	}
-} // namespace Graphics
\ No newline at end of file
+
+	bool Instance::negotiate() {
+		m_EnabledLayers.clear();
+		m_EnabledExtensions.clear();
+		m_MissingLayers.clear();
+		m_MissingExtensions.clear();
+		m_EnabledLayerNames.clear();
+		m_EnabledExtensionNames.clear();
+
+		GetAvailableLayers();
+		GetAvailableExtensions();
+		NegotiateLayers(m_Layers, s_CachedAvailableLayers, m_EnabledLayers, m_EnabledLayerNames, m_MissingLayers);
+		NegotiateLayers(m_Extensions, s_CachedAvailableExtensions, m_EnabledExtensions, m_EnabledExtensionNames, m_MissingExtensions);
+		return m_MissingLayers.empty() && m_MissingExtensions.empty();
+	}
+} // namespace Graphics
@@ -0,0 +1,102 @@
+#include "Graphics/OffscreenTarget.h"
+
+#include <cstring>
+
+namespace Graphics {
+	OffscreenTarget::OffscreenTarget(vk::Device device, VmaAllocator allocator)
+	    : m_Device(device), m_Allocator(allocator) { }
+
+	OffscreenTarget::~OffscreenTarget() {
+		if (isCreated())
+			destroy();
+	}
+
+	void OffscreenTarget::create(vk::Extent2D extent, vk::Format colorFormat, vk::Format depthFormat, vk::RenderPass renderPass, std::uint32_t count) {
+		if (isCreated())
+			destroy();
+
+		m_Extent      = extent;
+		m_ColorFormat = colorFormat;
+		m_DepthFormat = depthFormat;
+		m_Targets.resize(count);
+
+		VmaAllocationCreateInfo allocationInfo = { {}, VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_ONLY, 0, 0, 0, 0, 0, 0.0f };
+		for (auto& target : m_Targets) {
+			// Create color image, this both creates an image and allocates memory for it
+			{
+				vk::ImageCreateInfo createInfo = { {}, vk::ImageType::e2D, m_ColorFormat, { m_Extent.width, m_Extent.height, 1 }, 1, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive, nullptr, vk::ImageLayout::eUndefined };
+				VkImageCreateInfo createInfo_  = createInfo;
+				VkImage image_;
+				target.m_ColorImage     = vk::createResultValue(static_cast<vk::Result>(vmaCreateImage(m_Allocator, &createInfo_, &allocationInfo, &image_, &target.m_ColorImageAllocation, nullptr)), image_, "vmaCreateImage");
+				target.m_ColorImageView = m_Device.createImageView({ {}, target.m_ColorImage, vk::ImageViewType::e2D, m_ColorFormat, {}, { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 } });
+			}
+
+			// Create depth image
+			{
+				vk::ImageCreateInfo createInfo = { {}, vk::ImageType::e2D, m_DepthFormat, { m_Extent.width, m_Extent.height, 1 }, 1, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eDepthStencilAttachment, vk::SharingMode::eExclusive, nullptr, vk::ImageLayout::eUndefined };
+				VkImageCreateInfo createInfo_  = createInfo;
+				VkImage image_;
+				target.m_DepthImage     = vk::createResultValue(static_cast<vk::Result>(vmaCreateImage(m_Allocator, &createInfo_, &allocationInfo, &image_, &target.m_DepthImageAllocation, nullptr)), image_, "vmaCreateImage");
+				target.m_DepthImageView = m_Device.createImageView({ {}, target.m_DepthImage, vk::ImageViewType::e2D, m_DepthFormat, {}, { vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1 } });
+			}
+
+			// Create framebuffer
+			std::vector<vk::ImageView> attachments = { target.m_ColorImageView, target.m_DepthImageView };
+
+			target.m_Framebuffer = m_Device.createFramebuffer({ {}, renderPass, attachments, m_Extent.width, m_Extent.height, 1 });
+		}
+	}
+
+	void OffscreenTarget::destroy() {
+		for (auto& target : m_Targets) {
+			m_Device.destroyFramebuffer(target.m_Framebuffer);
+			m_Device.destroyImageView(target.m_DepthImageView);
+			vmaDestroyImage(m_Allocator, target.m_DepthImage, target.m_DepthImageAllocation);
+			m_Device.destroyImageView(target.m_ColorImageView);
+			vmaDestroyImage(m_Allocator, target.m_ColorImage, target.m_ColorImageAllocation);
+		}
+		m_Targets.clear();
+	}
+
+	std::vector<std::uint8_t> OffscreenTarget::readColor(std::uint32_t index, vk::Queue queue, vk::CommandPool commandPool) const {
+		auto& target        = m_Targets[index];
+		vk::DeviceSize size = static_cast<vk::DeviceSize>(m_Extent.width) * m_Extent.height * 4;
+		std::vector<std::uint8_t> pixels(static_cast<std::size_t>(size));
+
+		// Create readback buffer
+		vk::BufferCreateInfo createInfo        = { {}, size, vk::BufferUsageFlagBits::eTransferDst, vk::SharingMode::eExclusive, {} };
+		VkBufferCreateInfo createInfo_         = createInfo;
+		VmaAllocationCreateInfo allocationInfo = { VMA_ALLOCATION_CREATE_MAPPED_BIT, VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_TO_CPU, 0, 0, 0, 0, 0, 0.0f };
+
+		VkBuffer readbackBuffer;
+		VmaAllocation readbackBufferAllocation;
+		VmaAllocationInfo readbackBufferInfo;
+		vk::Result result = static_cast<vk::Result>(vmaCreateBuffer(m_Allocator, &createInfo_, &allocationInfo, &readbackBuffer, &readbackBufferAllocation, &readbackBufferInfo));
+		if (result != vk::Result::eSuccess)
+			vk::throwResultException(result, "vmaCreateBuffer");
+
+		// Record the copy, the barriers make the render pass writes visible to the copy and the copy visible to the host
+		vk::CommandBuffer commandBuffer = m_Device.allocateCommandBuffers({ commandPool, vk::CommandBufferLevel::ePrimary, 1 })[0];
+		commandBuffer.begin(vk::CommandBufferBeginInfo { vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+
+		vk::ImageMemoryBarrier imageMemoryBarrier = { vk::AccessFlagBits::eColorAttachmentWrite, vk::AccessFlagBits::eTransferRead, vk::ImageLayout::eTransferSrcOptimal, vk::ImageLayout::eTransferSrcOptimal, ~0U, ~0U, target.m_ColorImage, { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 } };
+		commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, imageMemoryBarrier);
+
+		std::vector<vk::BufferImageCopy> bufferImageCopies = { { 0, 0, 0, { vk::ImageAspectFlagBits::eColor, 0, 0, 1 }, { 0, 0, 0 }, { m_Extent.width, m_Extent.height, 1 } } };
+		commandBuffer.copyImageToBuffer(target.m_ColorImage, vk::ImageLayout::eTransferSrcOptimal, readbackBuffer, bufferImageCopies);
+
+		vk::BufferMemoryBarrier bufferMemoryBarrier = { vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead, ~0U, ~0U, readbackBuffer, 0, size };
+		commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, nullptr, bufferMemoryBarrier, nullptr);
+
+		commandBuffer.end();
+		queue.submit({ { {}, {}, commandBuffer, {} } });
+		queue.waitIdle();
+		m_Device.freeCommandBuffers(commandPool, commandBuffer);
+
+		// Copy the texels out of the readback buffer
+		vmaInvalidateAllocation(m_Allocator, readbackBufferAllocation, 0, VK_WHOLE_SIZE);
+		std::memcpy(pixels.data(), readbackBufferInfo.pMappedData, pixels.size());
+		vmaDestroyBuffer(m_Allocator, readbackBuffer, readbackBufferAllocation);
+		return pixels;
+	}
+} // namespace Graphics
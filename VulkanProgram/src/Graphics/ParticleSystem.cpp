@@ -0,0 +1,151 @@
+#include "Graphics/ParticleSystem.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace Graphics {
+	ParticleSystem::ParticleSystem(vk::Device device, VmaAllocator allocator, ShaderLibrary& shaderLibrary, vk::PipelineCache pipelineCache, PipelineCompiler& pipelineCompiler, AsyncCompute& asyncCompute, std::uint32_t particleCount)
+	    : m_Device(device), m_Allocator(allocator), m_PipelineCompiler(pipelineCompiler), m_AsyncCompute(asyncCompute), m_ParticleCount(std::max(particleCount, 1U)), m_Simulation(device, pipelineCache, shaderLibrary) { }
+
+	ParticleSystem::~ParticleSystem() {
+		if (isCreated())
+			destroy();
+	}
+
+	void ParticleSystem::create(vk::RenderPass renderPass, std::uint32_t subpass) {
+		if (isCreated())
+			destroy();
+
+		// Both queues use the buffers every frame, so they're shared concurrently instead of transferring ownership back and forth
+		auto& queueFamilies       = m_AsyncCompute.getQueueFamilies();
+		vk::SharingMode sharing   = queueFamilies.size() > 1 ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive;
+		vk::DeviceSize bufferSize = sizeof(Particle) * static_cast<vk::DeviceSize>(m_ParticleCount);
+
+		m_Buffers.resize(AsyncCompute::s_GraphicsLatency);
+		for (auto& buffer : m_Buffers) {
+			vk::BufferCreateInfo createInfo              = { {}, bufferSize, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eVertexBuffer, sharing, queueFamilies };
+			VmaAllocationCreateInfo allocationCreateInfo = {};
+			allocationCreateInfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+
+			VkBuffer vkBuffer;
+			vk::Result result = static_cast<vk::Result>(vmaCreateBuffer(m_Allocator, reinterpret_cast<VkBufferCreateInfo*>(&createInfo), &allocationCreateInfo, &vkBuffer, &buffer.m_Allocation, nullptr));
+			if (result != vk::Result::eSuccess)
+				vk::throwResultException(result, "vmaCreateBuffer");
+			buffer.m_Buffer = vkBuffer;
+		}
+
+		// Binding 0 is the previous state and 1 the next one
+		std::vector<vk::DescriptorSetLayoutBinding> bindings = {
+			{ 0, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr },
+			{ 1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr }
+		};
+		m_SetLayout = m_Device.createDescriptorSetLayout({ {}, bindings });
+
+		auto setCount                                 = static_cast<std::uint32_t>(m_Buffers.size());
+		std::vector<vk::DescriptorPoolSize> poolSizes = { { vk::DescriptorType::eStorageBuffer, 2 * setCount } };
+		m_DescriptorPool                              = m_Device.createDescriptorPool({ {}, setCount, poolSizes });
+
+		std::vector<vk::DescriptorSetLayout> setLayouts(setCount, m_SetLayout);
+		m_DescriptorSets = m_Device.allocateDescriptorSets({ m_DescriptorPool, setLayouts });
+
+		std::vector<vk::DescriptorBufferInfo> bufferInfos;
+		bufferInfos.reserve(2 * setCount);
+		std::vector<vk::WriteDescriptorSet> writeDescriptorSets;
+		for (std::uint32_t i = 0; i < setCount; ++i) {
+			auto& sourceInfo      = bufferInfos.emplace_back(m_Buffers[i].m_Buffer, 0, bufferSize);
+			auto& destinationInfo = bufferInfos.emplace_back(m_Buffers[(i + 1) % setCount].m_Buffer, 0, bufferSize);
+			writeDescriptorSets.push_back({ m_DescriptorSets[i], 0, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &sourceInfo, nullptr });
+			writeDescriptorSets.push_back({ m_DescriptorSets[i], 1, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &destinationInfo, nullptr });
+		}
+		m_Device.updateDescriptorSets(writeDescriptorSets, {});
+
+		ComputePipelineDesc simulationDesc;
+		simulationDesc.m_Shader           = "particles.comp.spv";
+		simulationDesc.m_LocalSize        = { 256, 1, 1 };
+		simulationDesc.m_SetLayouts       = { m_SetLayout };
+		simulationDesc.m_PushConstantSize = sizeof(SimulationConstants);
+		m_Simulation.create(simulationDesc);
+
+		// Points blend over the scene and test against its depth without writing it, so they never hide each other
+		std::vector<vk::PushConstantRange> pushConstantRanges = { { vk::ShaderStageFlagBits::eVertex, 0, sizeof(Utils::Mat4) } };
+		m_DrawLayout                                          = m_Device.createPipelineLayout({ {}, {}, pushConstantRanges });
+
+		GraphicsPipelineDesc drawDesc;
+		drawDesc.m_VertexShader     = "particle.vert.spv";
+		drawDesc.m_FragmentShader   = "particle.frag.spv";
+		drawDesc.m_VertexBindings   = { { 0, sizeof(Particle), vk::VertexInputRate::eVertex } };
+		drawDesc.m_VertexAttributes = { { 0, 0, vk::Format::eR32G32B32A32Sfloat, offsetof(Particle, m_Position) }, { 1, 0, vk::Format::eR32G32B32A32Sfloat, offsetof(Particle, m_Velocity) } };
+		drawDesc.m_Topology         = vk::PrimitiveTopology::ePointList;
+		drawDesc.m_CullMode         = vk::CullModeFlagBits::eNone;
+		drawDesc.m_DepthWrite       = false;
+		drawDesc.m_BlendEnable      = true;
+		drawDesc.m_Layout           = m_DrawLayout;
+		drawDesc.m_RenderPass       = renderPass;
+		drawDesc.m_Subpass          = subpass;
+		m_DrawPipeline              = m_PipelineCompiler.request(drawDesc);
+
+		m_StepCount = 0;
+		m_Time      = 0.0f;
+	}
+
+	void ParticleSystem::destroy() {
+		// The draw pipeline belongs to the compiler and is destroyed with it
+		m_Simulation.destroy();
+		m_Device.destroyPipelineLayout(m_DrawLayout);
+		m_Device.destroyDescriptorPool(m_DescriptorPool);
+		m_Device.destroyDescriptorSetLayout(m_SetLayout);
+		for (auto& buffer : m_Buffers)
+			vmaDestroyBuffer(m_Allocator, buffer.m_Buffer, buffer.m_Allocation);
+
+		m_Buffers.clear();
+		m_DescriptorSets.clear();
+		m_DrawLayout     = nullptr;
+		m_DescriptorPool = nullptr;
+		m_SetLayout      = nullptr;
+		m_DrawPipeline   = PipelineCompiler::s_InvalidHandle;
+	}
+
+	void ParticleSystem::simulate(vk::CommandBuffer commandBuffer, float deltaTime) {
+		// The previous step wrote the source on this queue. On the graphics queue the vertex input of the draw 's_GraphicsLatency' steps back also has to be
+		// done reading the destination, on the compute queue 'AsyncCompute' waits for that with a semaphore
+		bool async                      = m_AsyncCompute.isAsync();
+		vk::PipelineStageFlags srcStage = async ? vk::PipelineStageFlags { vk::PipelineStageFlagBits::eComputeShader } : vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eVertexInput;
+		commandBuffer.pipelineBarrier(srcStage, vk::PipelineStageFlagBits::eComputeShader, {}, vk::MemoryBarrier { vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite }, {}, {});
+
+		m_Time += deltaTime;
+
+		SimulationConstants constants;
+		constants.m_DeltaTime     = deltaTime;
+		constants.m_Time          = m_Time;
+		constants.m_ParticleCount = m_ParticleCount;
+		constants.m_Spawn         = m_StepCount == 0;
+
+		m_Simulation.bind(commandBuffer, { m_DescriptorSets[m_StepCount % m_DescriptorSets.size()] });
+		m_Simulation.pushConstants(commandBuffer, constants);
+		m_Simulation.dispatchThreads(commandBuffer, m_ParticleCount);
+		++m_StepCount;
+
+		// Within the graphics command buffer the draw follows right after, across queues the semaphore makes the writes visible
+		if (!async)
+			commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eVertexInput, {}, vk::MemoryBarrier { vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eVertexAttributeRead }, {}, {});
+	}
+
+	void ParticleSystem::draw(vk::CommandBuffer commandBuffer, vk::Extent2D extent, const Utils::Mat4& projView) {
+		if (m_StepCount == 0)
+			return;
+
+		vk::Pipeline pipeline = m_PipelineCompiler.getPipeline(m_DrawPipeline);
+		if (!pipeline)
+			return;
+
+		// The newest state is the destination of the last step
+		vk::Buffer buffer = m_Buffers[m_StepCount % m_Buffers.size()].m_Buffer;
+		commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+		commandBuffer.bindVertexBuffers(0, buffer, 0ULL);
+		commandBuffer.pushConstants(m_DrawLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(projView), &projView);
+		commandBuffer.setViewport(0, { { 0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 1.0f } });
+		commandBuffer.setScissor(0, { { { 0, 0 }, extent } });
+		commandBuffer.setLineWidth(1.0f);
+		commandBuffer.draw(m_ParticleCount, 1, 0, 0);
+	}
+} // namespace Graphics
@@ -0,0 +1,111 @@
+#include "Graphics/PipelineCache.h"
+
+#include <cstring>
+
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+namespace Graphics {
+	PipelineCache::PipelineCache(vk::Device device, vk::PhysicalDevice physicalDevice, std::filesystem::path path)
+	    : m_Device(device), m_PhysicalDevice(physicalDevice), m_Path(std::move(path)) { }
+
+	PipelineCache::~PipelineCache() {
+		if (isCreated())
+			destroy();
+	}
+
+	void PipelineCache::create() {
+		if (m_Handle)
+			destroy();
+
+		std::vector<std::uint8_t> blob;
+		{
+			std::ifstream file = std::ifstream(m_Path, std::ios::binary | std::ios::ate);
+			if (file.is_open()) {
+				auto size = file.tellg();
+				if (size > 0) {
+					blob.resize(static_cast<std::size_t>(size));
+					file.seekg(0);
+					file.read(reinterpret_cast<char*>(blob.data()), size);
+					if (!file)
+						blob.clear();
+				}
+				file.close();
+			}
+		}
+
+		// A blob from another driver or device would be rejected or, worse, silently ignored by the driver, so start cold instead
+		if (!isBlobCompatible(blob))
+			blob.clear();
+
+		m_Warm = !blob.empty();
+
+		vk::PipelineCacheCreateInfo createInfo = { {}, blob.size(), blob.data() };
+		m_Handle                               = m_Device.createPipelineCache(createInfo);
+	}
+
+	void PipelineCache::destroy() {
+		if (m_Handle) {
+			m_Device.destroyPipelineCache(m_Handle);
+			m_Handle = nullptr;
+		}
+		m_Warm = false;
+	}
+
+	bool PipelineCache::save() const {
+		if (!m_Handle)
+			return false;
+
+		auto blob = m_Device.getPipelineCacheData(m_Handle);
+		if (blob.empty())
+			return false;
+
+		std::filesystem::path tempPath = m_Path;
+		tempPath += ".tmp";
+
+		{
+			std::ofstream file = std::ofstream(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+				return false;
+
+			file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+			file.flush();
+			if (!file) {
+				file.close();
+				std::error_code ec;
+				std::filesystem::remove(tempPath, ec);
+				return false;
+			}
+			file.close();
+		}
+
+		// Renaming over the old blob replaces it atomically, readers either see the old or the new cache
+		std::error_code ec;
+		std::filesystem::rename(tempPath, m_Path, ec);
+		if (ec) {
+			std::filesystem::remove(tempPath, ec);
+			return false;
+		}
+		return true;
+	}
+
+	bool PipelineCache::isBlobCompatible(const std::vector<std::uint8_t>& blob) const {
+		if (blob.size() < sizeof(PipelineCacheHeader))
+			return false;
+
+		PipelineCacheHeader header;
+		std::memcpy(&header, blob.data(), sizeof(header));
+
+		if (header.m_HeaderSize < sizeof(PipelineCacheHeader) || header.m_HeaderSize > blob.size())
+			return false;
+		if (header.m_HeaderVersion != static_cast<std::uint32_t>(vk::PipelineCacheHeaderVersion::eOne))
+			return false;
+
+		auto properties = m_PhysicalDevice.getProperties();
+		if (header.m_VendorID != properties.vendorID || header.m_DeviceID != properties.deviceID)
+			return false;
+
+		return std::memcmp(header.m_PipelineCacheUUID, properties.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+	}
+} // namespace Graphics
@@ -0,0 +1,161 @@
+#include "Graphics/PipelineCompiler.h"
+#include "Utils/CPUProfiler.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace Graphics {
+	namespace {
+		// FNV-1a over the bytes of a value, only used on types without padding
+		template <class T>
+		void HashValue(std::uint64_t& hash, const T& value) {
+			auto bytes = reinterpret_cast<const std::uint8_t*>(&value);
+			for (std::size_t i = 0; i < sizeof(T); ++i)
+				hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+		}
+	} // namespace
+
+	PipelineCompiler::PipelineCompiler(vk::Device device, vk::PipelineCache pipelineCache, ShaderLibrary& shaderLibrary, Utils::ThreadPool& compilePool)
+	    : m_Device(device), m_PipelineCache(pipelineCache), m_ShaderLibrary(shaderLibrary), m_CompilePool(compilePool) { }
+
+	PipelineCompiler::~PipelineCompiler() {
+		if (isCreated())
+			destroy();
+	}
+
+	void PipelineCompiler::create() {
+		if (isCreated())
+			destroy();
+
+		m_Created = true;
+	}
+
+	void PipelineCompiler::destroy() {
+		// Compile jobs write into the entries, so all of them have to finish first
+		waitIdle();
+
+		for (auto& entry : m_Entries)
+			if (entry.m_Pipeline)
+				m_Device.destroyPipeline(entry.m_Pipeline);
+		m_Entries.clear();
+		m_HandlesByHash.clear();
+		m_Created = false;
+	}
+
+	PipelineCompiler::Handle PipelineCompiler::request(const GraphicsPipelineDesc& desc) {
+		std::uint64_t hash = Hash(desc);
+		auto itr           = m_HandlesByHash.find(hash);
+		if (itr != m_HandlesByHash.end() && m_Entries[itr->second].m_Desc == desc)
+			return itr->second;
+
+		Handle handle = static_cast<Handle>(m_Entries.size());
+		auto& entry   = m_Entries.emplace_back();
+		entry.m_Desc  = desc;
+		if (itr == m_HandlesByHash.end())
+			m_HandlesByHash.emplace(hash, handle);
+
+		// The shader library isn't thread safe, so modules are resolved here and only the handles go to the worker
+		vk::ShaderModule vertexShader;
+		vk::ShaderModule fragmentShader;
+		try {
+			vertexShader   = m_ShaderLibrary.getModule(desc.m_VertexShader);
+			fragmentShader = m_ShaderLibrary.getModule(desc.m_FragmentShader);
+		} catch (const std::exception& e) {
+			std::cerr << "Failed to compile pipeline: " << e.what() << '\n';
+			entry.m_State.store(PipelineState::Failed, std::memory_order_release);
+			return handle;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_PendingMutex);
+			++m_PendingCompiles;
+		}
+
+		m_CompilePool.submit([this, &entry, vertexShader, fragmentShader]() {
+			compile(entry, vertexShader, fragmentShader);
+
+			std::lock_guard<std::mutex> lock(m_PendingMutex);
+			if (--m_PendingCompiles == 0)
+				m_PendingCondition.notify_all();
+		});
+		return handle;
+	}
+
+	void PipelineCompiler::waitIdle() {
+		std::unique_lock<std::mutex> lock(m_PendingMutex);
+		m_PendingCondition.wait(lock, [this]() { return m_PendingCompiles == 0; });
+	}
+
+	vk::Pipeline PipelineCompiler::getPipeline(Handle handle, Handle fallback) const {
+		if (handle < m_Entries.size() && isReady(handle))
+			return m_Entries[handle].m_Pipeline;
+		if (fallback < m_Entries.size() && isReady(fallback))
+			return m_Entries[fallback].m_Pipeline;
+		return nullptr;
+	}
+
+	std::uint64_t PipelineCompiler::Hash(const GraphicsPipelineDesc& desc) {
+		std::uint64_t hash = 0xCBF29CE484222325ULL;
+		for (char c : desc.m_VertexShader) HashValue(hash, c);
+		HashValue(hash, '\0');
+		for (char c : desc.m_FragmentShader) HashValue(hash, c);
+		HashValue(hash, '\0');
+		for (auto& binding : desc.m_VertexBindings) HashValue(hash, binding);
+		for (auto& attribute : desc.m_VertexAttributes) HashValue(hash, attribute);
+		HashValue(hash, desc.m_Topology);
+		HashValue(hash, desc.m_PolygonMode);
+		HashValue(hash, static_cast<VkCullModeFlags>(desc.m_CullMode));
+		HashValue(hash, desc.m_FrontFace);
+		HashValue(hash, desc.m_DepthTest);
+		HashValue(hash, desc.m_DepthWrite);
+		HashValue(hash, desc.m_DepthCompareOp);
+		HashValue(hash, desc.m_BlendEnable);
+		HashValue(hash, static_cast<VkPipelineLayout>(desc.m_Layout));
+		HashValue(hash, static_cast<VkRenderPass>(desc.m_RenderPass));
+		HashValue(hash, desc.m_Subpass);
+		return hash;
+	}
+
+	void PipelineCompiler::compile(Entry& entry, vk::ShaderModule vertexShader, vk::ShaderModule fragmentShader) {
+		PROFILE_ZONE("Compile pipeline");
+
+		auto compileStart = std::chrono::steady_clock::now();
+		auto& desc        = entry.m_Desc;
+
+		std::vector<vk::PipelineShaderStageCreateInfo> stages;
+		stages.push_back({ {}, vk::ShaderStageFlagBits::eVertex, vertexShader, "main", nullptr });
+		stages.push_back({ {}, vk::ShaderStageFlagBits::eFragment, fragmentShader, "main", nullptr });
+
+		std::vector<vk::Viewport> viewports = { { 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f } };
+		std::vector<vk::Rect2D> scissors    = { { { 0, 0 }, { 1, 1 } } };
+
+		std::vector<vk::PipelineColorBlendAttachmentState> blendAttachments = { { desc.m_BlendEnable, vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eOneMinusSrcAlpha, vk::BlendOp::eAdd, vk::BlendFactor::eOne, vk::BlendFactor::eZero, vk::BlendOp::eAdd, vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA } };
+
+		std::vector<vk::DynamicState> dynamicStates = { vk::DynamicState::eViewport, vk::DynamicState::eScissor, vk::DynamicState::eLineWidth };
+
+		vk::PipelineVertexInputStateCreateInfo vertexInputState     = { {}, desc.m_VertexBindings, desc.m_VertexAttributes };
+		vk::PipelineInputAssemblyStateCreateInfo inputAssemblyState = { {}, desc.m_Topology, false };
+		vk::PipelineViewportStateCreateInfo viewportState           = { {}, viewports, scissors };
+		vk::PipelineRasterizationStateCreateInfo rasterizationState = { {}, false, false, desc.m_PolygonMode, desc.m_CullMode, desc.m_FrontFace, false, 0.0f, 0.0f, 0.0f, 1.0f };
+		vk::PipelineMultisampleStateCreateInfo multisampleState     = { {}, vk::SampleCountFlagBits::e1, false, 1.0f, nullptr, false, false };
+		vk::PipelineDepthStencilStateCreateInfo depthStencilState   = { {}, desc.m_DepthTest, desc.m_DepthWrite, desc.m_DepthCompareOp, false, false, { vk::StencilOp::eKeep, vk::StencilOp::eReplace, vk::StencilOp::eKeep, vk::CompareOp::eLess, ~0U, ~0U, ~0U }, { vk::StencilOp::eKeep, vk::StencilOp::eReplace, vk::StencilOp::eKeep, vk::CompareOp::eLess, ~0U, ~0U, ~0U }, 0.0f, 1.0f };
+		vk::PipelineColorBlendStateCreateInfo colorBlendState       = { {}, false, vk::LogicOp::eCopy, blendAttachments, {} };
+		vk::PipelineDynamicStateCreateInfo dynamicState             = { {}, dynamicStates };
+
+		vk::GraphicsPipelineCreateInfo createInfo = { {}, stages, &vertexInputState, &inputAssemblyState, nullptr, &viewportState, &rasterizationState, &multisampleState, &depthStencilState, &colorBlendState, &dynamicState, desc.m_Layout, desc.m_RenderPass, desc.m_Subpass, nullptr, 0 };
+
+		// Workers can't propagate exceptions, so a failed compile only marks the entry
+		vk::Pipeline pipeline;
+		try {
+			pipeline = m_Device.createGraphicsPipeline(m_PipelineCache, createInfo).value;
+		} catch (const vk::SystemError& e) {
+			std::cerr << "Failed to compile pipeline '" << desc.m_VertexShader << "' + '" << desc.m_FragmentShader << "': " << e.what() << '\n';
+			entry.m_State.store(PipelineState::Failed, std::memory_order_release);
+			return;
+		}
+
+		entry.m_Pipeline    = pipeline;
+		entry.m_CompileTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count();
+		entry.m_State.store(PipelineState::Ready, std::memory_order_release);
+	}
+} // namespace Graphics
@@ -0,0 +1,105 @@
+#include "Graphics/RenderQueue.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+namespace Graphics {
+	std::uint64_t RenderQueue::MakeSortKey(std::uint32_t pipeline, std::uint32_t material, std::uint32_t mesh, float depth) {
+		auto quantizedDepth = static_cast<std::uint64_t>(std::clamp(depth, 0.0f, 1.0f) * static_cast<float>((1 << 20) - 1));
+		return (static_cast<std::uint64_t>(pipeline & 0xFFF) << 52) | (static_cast<std::uint64_t>(material & 0xFFFF) << 36) | (static_cast<std::uint64_t>(mesh & 0xFFFF) << 20) | quantizedDepth;
+	}
+
+	void RenderQueue::clear() {
+		// Keeps the capacity, so a steady scene doesn't allocate once the vectors have grown
+		m_Packets.clear();
+		m_Entries.clear();
+		m_Draws.clear();
+	}
+
+	void RenderQueue::build() {
+		sort();
+
+		// Runs of packets with the same state become one instanced draw, split where the instance constants are full
+		m_Draws.clear();
+		for (std::uint32_t i = 0; i < m_Entries.size(); ++i) {
+			if (!m_Draws.empty()) {
+				auto& draw = m_Draws.back();
+				if (draw.m_InstanceCount < InstanceConstants::s_MaxInstances && HasSameState(m_Packets[m_Entries[draw.m_FirstEntry].m_Packet], m_Packets[m_Entries[i].m_Packet])) {
+					++draw.m_InstanceCount;
+					continue;
+				}
+			}
+			m_Draws.push_back({ i, 1 });
+		}
+	}
+
+	void RenderQueue::record(vk::CommandBuffer commandBuffer, std::size_t begin, std::size_t end, UniformRing& uniformRing, const Utils::Mat4& projView) const {
+		const RenderPacket* previous = nullptr;
+		for (std::size_t i = begin; i < end; ++i) {
+			auto& draw   = m_Draws[i];
+			auto& packet = m_Packets[m_Entries[draw.m_FirstEntry].m_Packet];
+
+			if (!previous || packet.m_Pipeline != previous->m_Pipeline)
+				commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, packet.m_Pipeline);
+			if (!previous || packet.m_VertexBuffer != previous->m_VertexBuffer)
+				commandBuffer.bindVertexBuffers(0, packet.m_VertexBuffer, 0ULL);
+			if (!previous || packet.m_IndexBuffer != previous->m_IndexBuffer || packet.m_IndexBufferOffset != previous->m_IndexBufferOffset)
+				commandBuffer.bindIndexBuffer(packet.m_IndexBuffer, packet.m_IndexBufferOffset, vk::IndexType::eUint32);
+			if (packet.m_HasDrawConstants && (!previous || !previous->m_HasDrawConstants || !HasSameDrawConstants(packet, *previous)))
+				commandBuffer.pushConstants(packet.m_Layout, vk::ShaderStageFlagBits::eFragment, 0, sizeof(DrawConstants), &packet.m_DrawConstants);
+
+			// Only the instances actually drawn are written, the shader never reads past them
+			auto allocation = uniformRing.allocate(sizeof(Utils::Mat4) * (1 + draw.m_InstanceCount));
+			auto constants  = static_cast<std::uint8_t*>(allocation.m_Data);
+			std::memcpy(constants, &projView, sizeof(Utils::Mat4));
+			for (std::uint32_t instance = 0; instance < draw.m_InstanceCount; ++instance)
+				std::memcpy(constants + sizeof(Utils::Mat4) * (1 + instance), &m_Packets[m_Entries[draw.m_FirstEntry + instance].m_Packet].m_Model, sizeof(Utils::Mat4));
+
+			// The dynamic offset moves with every draw, so the set is rebound per draw but never per object
+			commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, packet.m_Layout, 0, packet.m_DescriptorSet, allocation.m_Offset);
+			commandBuffer.drawIndexed(packet.m_IndexCount, draw.m_InstanceCount, packet.m_FirstIndex, packet.m_VertexOffset, 0);
+			previous = &packet;
+		}
+	}
+
+	bool RenderQueue::HasSameDrawConstants(const RenderPacket& lhs, const RenderPacket& rhs) {
+		return lhs.m_DrawConstants.m_TextureIndex == rhs.m_DrawConstants.m_TextureIndex && lhs.m_DrawConstants.m_SamplerIndex == rhs.m_DrawConstants.m_SamplerIndex;
+	}
+
+	bool RenderQueue::HasSameState(const RenderPacket& lhs, const RenderPacket& rhs) {
+		return lhs.m_Pipeline == rhs.m_Pipeline && lhs.m_Layout == rhs.m_Layout && lhs.m_DescriptorSet == rhs.m_DescriptorSet && lhs.m_HasDrawConstants == rhs.m_HasDrawConstants && HasSameDrawConstants(lhs, rhs) &&
+		       lhs.m_VertexBuffer == rhs.m_VertexBuffer && lhs.m_IndexBuffer == rhs.m_IndexBuffer && lhs.m_IndexBufferOffset == rhs.m_IndexBufferOffset &&
+		       lhs.m_IndexCount == rhs.m_IndexCount && lhs.m_FirstIndex == rhs.m_FirstIndex && lhs.m_VertexOffset == rhs.m_VertexOffset;
+	}
+
+	void RenderQueue::sort() {
+		m_Entries.resize(m_Packets.size());
+		m_ScratchEntries.resize(m_Packets.size());
+		for (std::uint32_t i = 0; i < m_Packets.size(); ++i)
+			m_Entries[i] = { m_Packets[i].m_SortKey, i };
+
+		// LSD radix sort over 8 bit digits, the histograms of all digits are built in one pass over the keys
+		std::array<std::array<std::uint32_t, 256>, 8> histograms = {};
+		for (auto& entry : m_Entries)
+			for (std::size_t digit = 0; digit < 8; ++digit)
+				++histograms[digit][(entry.m_Key >> (digit * 8)) & 0xFF];
+
+		for (std::size_t digit = 0; digit < 8; ++digit) {
+			auto& histogram = histograms[digit];
+
+			// Every key has the same value in this digit, the pass wouldn't change the order
+			if (histogram[(m_Entries.empty() ? 0 : m_Entries[0].m_Key >> (digit * 8)) & 0xFF] == m_Entries.size())
+				continue;
+
+			std::uint32_t offset = 0;
+			for (auto& count : histogram)
+				offset += std::exchange(count, offset);
+
+			for (auto& entry : m_Entries)
+				m_ScratchEntries[histogram[(entry.m_Key >> (digit * 8)) & 0xFF]++] = entry;
+			m_Entries.swap(m_ScratchEntries);
+		}
+	}
+} // namespace Graphics
@@ -0,0 +1,207 @@
+#include "Graphics/ShaderLibrary.h"
+
+#include <cstring>
+
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace Graphics {
+	bool ShaderLibrary::WriteArchive(const std::filesystem::path& path, const std::vector<std::filesystem::path>& files) {
+		std::vector<Utils::MappedFile> codes;
+		std::vector<std::string> names;
+		for (auto& file : files) {
+			auto& code = codes.emplace_back(file);
+			if (!IsSPIRV(code.getData(), code.getSize()))
+				return false;
+			names.push_back(file.filename().string());
+		}
+
+		// Lay out the names right after the entry table and the code after the names, keeping every blob 4 byte aligned
+		std::vector<ShaderArchiveEntry> entries(files.size());
+		std::uint64_t offset = sizeof(ShaderArchiveHeader) + sizeof(ShaderArchiveEntry) * entries.size();
+		for (std::size_t i = 0; i < entries.size(); ++i) {
+			entries[i].m_NameOffset = offset;
+			entries[i].m_NameSize   = names[i].size();
+			offset += names[i].size();
+		}
+		for (std::size_t i = 0; i < entries.size(); ++i) {
+			offset                  = (offset + 3) & ~3ULL;
+			entries[i].m_CodeOffset = offset;
+			entries[i].m_CodeSize   = codes[i].getSize();
+			offset += codes[i].getSize();
+		}
+
+		ShaderArchiveHeader header = { s_ArchiveMagic, s_ArchiveVersion, static_cast<std::uint32_t>(entries.size()), 0 };
+
+		// Write to a temporary file first so a running program never maps a half written archive
+		std::filesystem::path tempPath = path;
+		tempPath += ".tmp";
+		{
+			std::ofstream file = std::ofstream(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+				return false;
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(sizeof(ShaderArchiveEntry) * entries.size()));
+			for (auto& name : names)
+				file.write(name.data(), static_cast<std::streamsize>(name.size()));
+			for (std::size_t i = 0; i < entries.size(); ++i) {
+				static constexpr char padding[4] = {};
+				file.write(padding, static_cast<std::streamsize>(entries[i].m_CodeOffset - static_cast<std::uint64_t>(file.tellp())));
+				file.write(reinterpret_cast<const char*>(codes[i].getData()), static_cast<std::streamsize>(codes[i].getSize()));
+			}
+			file.flush();
+			if (!file) {
+				file.close();
+				std::error_code error;
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(tempPath, path, error);
+		if (error) {
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+		return true;
+	}
+
+	ShaderLibrary::ShaderLibrary(vk::Device device, std::filesystem::path directory)
+	    : m_Device(device), m_Directory(std::move(directory)) { }
+
+	ShaderLibrary::~ShaderLibrary() {
+		if (isCreated())
+			destroy();
+	}
+
+	void ShaderLibrary::create() {
+		if (isCreated())
+			destroy();
+
+		m_Created = true;
+	}
+
+	void ShaderLibrary::destroy() {
+		for (auto& [hash, module] : m_ModulesByHash)
+			m_Device.destroyShaderModule(module.m_Handle);
+		for (auto& module : m_OrphanModules)
+			m_Device.destroyShaderModule(module);
+		m_ModulesByHash.clear();
+		m_OrphanModules.clear();
+		m_ModulesByName.clear();
+		m_ArchiveEntries.clear();
+		m_Archive.close();
+		m_Created = false;
+	}
+
+	bool ShaderLibrary::loadArchive(const std::filesystem::path& path) {
+		m_ArchiveEntries.clear();
+		if (!m_Archive.open(path))
+			return false;
+
+		std::error_code error;
+		m_ArchiveWriteTime = std::filesystem::last_write_time(path, error);
+
+		const std::uint8_t* data = m_Archive.getData();
+		std::size_t size         = m_Archive.getSize();
+
+		ShaderArchiveHeader header;
+		if (size < sizeof(header)) {
+			m_Archive.close();
+			return false;
+		}
+		std::memcpy(&header, data, sizeof(header));
+		if (header.m_Magic != s_ArchiveMagic || header.m_Version != s_ArchiveVersion || (size - sizeof(header)) / sizeof(ShaderArchiveEntry) < header.m_EntryCount) {
+			m_Archive.close();
+			return false;
+		}
+
+		// Reject the whole archive if any entry points outside of it, a truncated archive must not be half used
+		auto entries = reinterpret_cast<const ShaderArchiveEntry*>(data + sizeof(header));
+		for (std::uint32_t i = 0; i < header.m_EntryCount; ++i) {
+			auto& entry = entries[i];
+			if (entry.m_NameOffset > size || entry.m_NameSize > size - entry.m_NameOffset || entry.m_CodeOffset > size || entry.m_CodeSize > size - entry.m_CodeOffset || (entry.m_CodeOffset & 3) != 0) {
+				m_ArchiveEntries.clear();
+				m_Archive.close();
+				return false;
+			}
+
+			std::string_view name = { reinterpret_cast<const char*>(data + entry.m_NameOffset), static_cast<std::size_t>(entry.m_NameSize) };
+			m_ArchiveEntries[name] = { data + entry.m_CodeOffset, static_cast<std::size_t>(entry.m_CodeSize) };
+		}
+		return true;
+	}
+
+	vk::ShaderModule ShaderLibrary::getModule(std::string_view name) {
+		auto itr = m_ModulesByName.find(std::string(name));
+		if (itr != m_ModulesByName.end())
+			return itr->second;
+
+		// The archive is only refreshed by '--pack-shaders', a loose file compiled since then is newer
+		vk::ShaderModule module;
+		auto entry = m_ArchiveEntries.find(name);
+		if (entry != m_ArchiveEntries.end()) {
+			std::error_code error;
+			auto looseWriteTime = std::filesystem::last_write_time(m_Directory / name, error);
+			if (!error && looseWriteTime > m_ArchiveWriteTime)
+				entry = m_ArchiveEntries.end();
+		}
+
+		if (entry != m_ArchiveEntries.end()) {
+			module = createModule(entry->second.first, entry->second.second);
+		} else {
+			// The file only has to stay mapped until the module is created
+			Utils::MappedFile file = { m_Directory / name };
+			module                 = createModule(file.getData(), file.getSize());
+		}
+
+		if (!module)
+			throw std::runtime_error("Shader '" + std::string(name) + "' is missing or not valid SPIR-V");
+
+		m_ModulesByName.emplace(std::string(name), module);
+		return module;
+	}
+
+	bool ShaderLibrary::IsSPIRV(const std::uint8_t* code, std::size_t size) {
+		if (!code || size < 20 || (size & 3) != 0)
+			return false;
+
+		std::uint32_t magic;
+		std::memcpy(&magic, code, sizeof(magic));
+		return magic == 0x07230203;
+	}
+
+	std::uint64_t ShaderLibrary::Hash(const std::uint8_t* code, std::size_t size) {
+		// FNV-1a over 32 bit words, SPIR-V is always a whole number of words
+		std::uint64_t hash = 0xCBF29CE484222325ULL;
+		for (std::size_t i = 0; i < size; i += 4) {
+			std::uint32_t word;
+			std::memcpy(&word, code + i, sizeof(word));
+			hash = (hash ^ word) * 0x100000001B3ULL;
+		}
+		return hash;
+	}
+
+	vk::ShaderModule ShaderLibrary::createModule(const std::uint8_t* code, std::size_t size) {
+		if (!IsSPIRV(code, size))
+			return nullptr;
+
+		// Identical code under another name shares the module
+		std::uint64_t hash = Hash(code, size);
+		auto itr           = m_ModulesByHash.find(hash);
+		if (itr != m_ModulesByHash.end() && itr->second.m_CodeSize == size)
+			return itr->second.m_Handle;
+
+		// Mapped files and archive blobs are 4 byte aligned, so the code can be handed to the driver without a copy
+		vk::ShaderModule module = m_Device.createShaderModule({ {}, size, reinterpret_cast<const std::uint32_t*>(code) });
+		if (itr == m_ModulesByHash.end())
+			m_ModulesByHash.emplace(hash, Module { module, size });
+		else
+			m_OrphanModules.push_back(module);
+		return module;
+	}
+} // namespace Graphics
@@ -0,0 +1,135 @@
+#include "Graphics/Swapchain.h"
+
+#include <algorithm>
+
+namespace Graphics {
+	Swapchain::Swapchain(vk::Device device, vk::PhysicalDevice physicalDevice, VmaAllocator allocator, DeletionQueue& deletionQueue, vk::SurfaceKHR surface, std::uint32_t queueFamilyIndex)
+	    : m_Device(device), m_PhysicalDevice(physicalDevice), m_Allocator(allocator), m_DeletionQueue(deletionQueue), m_Surface(surface), m_QueueFamilyIndex(queueFamilyIndex) { }
+
+	Swapchain::~Swapchain() {
+		if (isCreated())
+			destroy();
+	}
+
+	bool Swapchain::create(vk::SurfaceFormatKHR surfaceFormat, vk::PresentModeKHR presentMode, vk::Format depthFormat, vk::RenderPass renderPass, vk::Extent2D extent) {
+		if (isCreated())
+			destroy();
+
+		m_SurfaceFormat = surfaceFormat;
+		m_PresentMode   = presentMode;
+		m_DepthFormat   = depthFormat;
+		m_RenderPass    = renderPass;
+
+		vk::Extent2D swapchainExtent = chooseExtent(m_PhysicalDevice.getSurfaceCapabilitiesKHR(m_Surface), extent);
+		if (swapchainExtent.width == 0 || swapchainExtent.height == 0)
+			return false;
+
+		createGeneration(m_Current, swapchainExtent, nullptr);
+		return true;
+	}
+
+	bool Swapchain::recreate(vk::Extent2D extent) {
+		vk::Extent2D swapchainExtent = chooseExtent(m_PhysicalDevice.getSurfaceCapabilitiesKHR(m_Surface), extent);
+		if (swapchainExtent.width == 0 || swapchainExtent.height == 0)
+			return false;
+
+		// The new swapchain takes over the images the presentation engine still holds from the old one, which is kept alive until its last frame completes
+		Generation generation;
+		createGeneration(generation, swapchainExtent, m_Current.m_Swapchain);
+
+		releaseGeneration(m_Current);
+		m_Current = std::move(generation);
+		return true;
+	}
+
+	void Swapchain::destroy() {
+		destroyGeneration(m_Current);
+		m_Extent = {};
+	}
+
+	vk::Result Swapchain::acquire(vk::Semaphore signalSemaphore, std::uint32_t& imageIndex) {
+		return m_Device.acquireNextImageKHR(m_Current.m_Swapchain, ~0ULL, signalSemaphore, nullptr, &imageIndex);
+	}
+
+	vk::Result Swapchain::present(vk::Queue queue, vk::Semaphore waitSemaphore, std::uint32_t imageIndex) {
+		// The pointer overload returns out of date and suboptimal results instead of throwing them
+		vk::PresentInfoKHR presentInfo = { 1, &waitSemaphore, 1, &m_Current.m_Swapchain, &imageIndex, nullptr };
+		return queue.presentKHR(&presentInfo);
+	}
+
+	vk::Extent2D Swapchain::chooseExtent(const vk::SurfaceCapabilitiesKHR& capabilities, vk::Extent2D extent) const {
+		// A minimized window reports a zero extent, nothing can be created until it is restored
+		if (capabilities.currentExtent.width != ~0U)
+			return capabilities.currentExtent;
+		if (extent.width == 0 || extent.height == 0)
+			return {};
+
+		return { std::clamp(extent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width),
+			     std::clamp(extent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height) };
+	}
+
+	void Swapchain::createGeneration(Generation& generation, vk::Extent2D extent, vk::SwapchainKHR oldSwapchain) {
+		vk::SurfaceCapabilitiesKHR capabilities = m_PhysicalDevice.getSurfaceCapabilitiesKHR(m_Surface);
+
+		// One image more than the minimum so acquiring does not wait on the presentation engine, a maximum of 0 means there is no limit
+		std::uint32_t imageCount = capabilities.minImageCount + 1;
+		if (capabilities.maxImageCount > 0)
+			imageCount = std::min(imageCount, capabilities.maxImageCount);
+
+		std::vector<std::uint32_t> queueFamilyIndices = { m_QueueFamilyIndex };
+
+		generation.m_Swapchain = m_Device.createSwapchainKHR({ {}, m_Surface, imageCount, m_SurfaceFormat.format, m_SurfaceFormat.colorSpace, extent, 1, vk::ImageUsageFlagBits::eColorAttachment, vk::SharingMode::eExclusive, queueFamilyIndices, capabilities.currentTransform, vk::CompositeAlphaFlagBitsKHR::eOpaque, m_PresentMode, true, oldSwapchain });
+		generation.m_Images    = m_Device.getSwapchainImagesKHR(generation.m_Swapchain);
+		m_Extent               = extent;
+
+		// Create image views, depth images and framebuffers for every swapchain image.
+		// The render pass clears depth from an undefined layout, so the depth images need no layout transition before their first frame
+		std::size_t count = generation.m_Images.size();
+		generation.m_ImageViews.resize(count);
+		generation.m_DepthImages.resize(count);
+		generation.m_DepthImageAllocations.resize(count);
+		generation.m_DepthImageViews.resize(count);
+		generation.m_Framebuffers.resize(count);
+
+		VmaAllocationCreateInfo allocationInfo = { {}, VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_ONLY, 0, 0, 0, 0, 0, 0.0f };
+		for (std::size_t i = 0; i < count; ++i) {
+			generation.m_ImageViews[i] = m_Device.createImageView({ {}, generation.m_Images[i], vk::ImageViewType::e2D, m_SurfaceFormat.format, {}, { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 } });
+
+			// Create depth image, this both creates an image and allocates memory for it
+			{
+				vk::ImageCreateInfo createInfo = { {}, vk::ImageType::e2D, m_DepthFormat, { extent.width, extent.height, 1 }, 1, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eDepthStencilAttachment, vk::SharingMode::eExclusive, nullptr, vk::ImageLayout::eUndefined };
+				VkImageCreateInfo createInfo_  = createInfo;
+				VkImage image_;
+				generation.m_DepthImages[i]     = vk::createResultValue(static_cast<vk::Result>(vmaCreateImage(m_Allocator, &createInfo_, &allocationInfo, &image_, &generation.m_DepthImageAllocations[i], nullptr)), image_, "vmaCreateImage");
+				generation.m_DepthImageViews[i] = m_Device.createImageView({ {}, generation.m_DepthImages[i], vk::ImageViewType::e2D, m_DepthFormat, {}, { vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1 } });
+			}
+
+			// Create framebuffer
+			std::vector<vk::ImageView> attachments = { generation.m_ImageViews[i], generation.m_DepthImageViews[i] };
+
+			generation.m_Framebuffers[i] = m_Device.createFramebuffer({ {}, m_RenderPass, attachments, extent.width, extent.height, 1 });
+		}
+	}
+
+	void Swapchain::destroyGeneration(Generation& generation) {
+		for (std::size_t i = 0; i < generation.m_Framebuffers.size(); ++i) {
+			m_Device.destroyFramebuffer(generation.m_Framebuffers[i]);
+			m_Device.destroyImageView(generation.m_DepthImageViews[i]);
+			vmaDestroyImage(m_Allocator, generation.m_DepthImages[i], generation.m_DepthImageAllocations[i]);
+			m_Device.destroyImageView(generation.m_ImageViews[i]);
+		}
+		m_Device.destroySwapchainKHR(generation.m_Swapchain);
+		generation = {};
+	}
+
+	void Swapchain::releaseGeneration(Generation& generation) {
+		for (std::size_t i = 0; i < generation.m_Framebuffers.size(); ++i) {
+			m_DeletionQueue.release(generation.m_Framebuffers[i]);
+			m_DeletionQueue.release(generation.m_DepthImageViews[i]);
+			m_DeletionQueue.release(generation.m_DepthImages[i], generation.m_DepthImageAllocations[i]);
+			m_DeletionQueue.release(generation.m_ImageViews[i]);
+		}
+		m_DeletionQueue.release(generation.m_Swapchain);
+		generation = {};
+	}
+} // namespace Graphics
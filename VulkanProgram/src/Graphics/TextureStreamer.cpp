@@ -0,0 +1,231 @@
+#include "Graphics/TextureStreamer.h"
+#include "Utils/CPUProfiler.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace Graphics {
+	namespace {
+		// sRGB to linear conversion of every 8 bit value, mips are averaged in linear space so they don't darken
+		const std::array<float, 256>& GetSRGBToLinearTable() {
+			static const std::array<float, 256> table = []() {
+				std::array<float, 256> values;
+				for (std::size_t i = 0; i < values.size(); ++i) {
+					float c   = static_cast<float>(i) / 255.0f;
+					values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+				}
+				return values;
+			}();
+			return table;
+		}
+
+		std::uint8_t LinearToSRGB(float value) {
+			float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+			return static_cast<std::uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+		}
+	} // namespace
+
+	TextureStreamer::TextureStreamer(vk::Device device, VmaAllocator allocator, UploadManager& uploadManager, Utils::ThreadPool& decodePool, vk::DeviceSize uploadBudget)
+	    : m_Device(device), m_Allocator(allocator), m_UploadManager(uploadManager), m_DecodePool(decodePool), m_UploadBudget(uploadBudget) { }
+
+	TextureStreamer::~TextureStreamer() {
+		if (isCreated())
+			destroy();
+	}
+
+	void TextureStreamer::create() {
+		if (isCreated())
+			destroy();
+
+		m_ResidentCount = 0;
+		m_FailedCount   = 0;
+		m_Created       = true;
+	}
+
+	void TextureStreamer::destroy() {
+		// Decode jobs write into this object, so all of them have to finish first
+		{
+			std::unique_lock<std::mutex> lock(m_DecodedMutex);
+			m_DecodedCondition.wait(lock, [this]() { return m_PendingDecodes == 0; });
+			m_Decoded.clear();
+		}
+
+		for (auto& texture : m_Textures) {
+			if (texture.m_ImageView)
+				m_Device.destroyImageView(texture.m_ImageView);
+			if (texture.m_Image)
+				vmaDestroyImage(m_Allocator, texture.m_Image, texture.m_ImageAllocation);
+		}
+		m_Textures.clear();
+		m_UploadQueue.clear();
+		m_Transferring.clear();
+		m_Created = false;
+	}
+
+	std::uint32_t TextureStreamer::request(std::filesystem::path path) {
+		std::uint32_t id = static_cast<std::uint32_t>(m_Textures.size());
+		auto& texture    = m_Textures.emplace_back();
+		texture.m_Path   = path;
+
+		{
+			std::lock_guard<std::mutex> lock(m_DecodedMutex);
+			++m_PendingDecodes;
+		}
+
+		m_DecodePool.submit([this, id, path = std::move(path)]() {
+			DecodedTexture decoded;
+			decoded.m_Id = id;
+			Decode(decoded, path);
+
+			std::lock_guard<std::mutex> lock(m_DecodedMutex);
+			m_Decoded.push_back(std::move(decoded));
+			if (--m_PendingDecodes == 0)
+				m_DecodedCondition.notify_all();
+		});
+		return id;
+	}
+
+	void TextureStreamer::update() {
+		PROFILE_ZONE("Stream textures");
+
+		// Pick up everything the decode jobs have finished since the last update
+		std::vector<DecodedTexture> decodedTextures;
+		{
+			std::lock_guard<std::mutex> lock(m_DecodedMutex);
+			decodedTextures.swap(m_Decoded);
+		}
+
+		for (auto& decoded : decodedTextures) {
+			auto& texture = m_Textures[decoded.m_Id];
+			if (decoded.m_Pixels.empty()) {
+				texture.m_State = TextureState::Failed;
+				++m_FailedCount;
+				continue;
+			}
+
+			texture.m_Decoded = std::move(decoded);
+			createImage(texture);
+			texture.m_State = TextureState::Uploading;
+			m_UploadQueue.push_back(texture.m_Decoded.m_Id);
+		}
+
+		// Promote textures whose last upload the graphics queue has acquired
+		std::erase_if(m_Transferring, [this](std::uint32_t id) {
+			auto& texture = m_Textures[id];
+			if (!m_UploadManager.isAvailable(texture.m_BatchId))
+				return false;
+
+			texture.m_State = TextureState::Resident;
+			++m_ResidentCount;
+			return true;
+		});
+
+		// Upload mips in request order until the budget is spent, the first mip of an update always goes through so a large mip can't stall the queue
+		vk::DeviceSize uploaded = 0;
+		bool uploadedAny        = false;
+		std::size_t finished    = 0;
+		for (std::uint32_t id : m_UploadQueue) {
+			auto& texture = m_Textures[id];
+			auto& decoded = texture.m_Decoded;
+			while (texture.m_NextMip < texture.m_MipCount) {
+				std::uint32_t mip     = texture.m_NextMip;
+				vk::DeviceSize offset = decoded.m_MipOffsets[mip];
+				vk::DeviceSize size   = (mip + 1 < texture.m_MipCount ? decoded.m_MipOffsets[mip + 1] : decoded.m_Pixels.size()) - offset;
+				if (uploadedAny && uploaded + size > m_UploadBudget)
+					break;
+
+				vk::Extent3D extent = { std::max(decoded.m_Width >> mip, 1U), std::max(decoded.m_Height >> mip, 1U), 1 };
+				m_UploadManager.uploadImage(texture.m_Image, { vk::ImageAspectFlagBits::eColor, mip, 0, 1 }, extent, decoded.m_Pixels.data() + offset, size, vk::ImageLayout::eShaderReadOnlyOptimal, vk::PipelineStageFlagBits::eFragmentShader, vk::AccessFlagBits::eShaderRead);
+				uploaded += size;
+				uploadedAny = true;
+				++texture.m_NextMip;
+			}
+
+			if (texture.m_NextMip < texture.m_MipCount)
+				break;
+			++finished;
+		}
+
+		// Everything uploaded in this update goes out in one submission
+		if (!uploadedAny)
+			return;
+
+		std::uint64_t batchId = m_UploadManager.flush();
+		for (std::size_t i = 0; i < finished; ++i) {
+			auto& texture = m_Textures[m_UploadQueue[i]];
+
+			// Every mip is submitted, the CPU copy is no longer needed
+			texture.m_BatchId = batchId;
+			texture.m_State   = TextureState::Transferring;
+			texture.m_Decoded = {};
+			m_Transferring.push_back(m_UploadQueue[i]);
+		}
+		m_UploadQueue.erase(m_UploadQueue.begin(), m_UploadQueue.begin() + finished);
+	}
+
+	void TextureStreamer::Decode(DecodedTexture& decoded, const std::filesystem::path& path) {
+		PROFILE_ZONE("Decode texture");
+
+		int width, height, channels;
+		stbi_uc* pixels = stbi_load(path.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+		if (!pixels)
+			return;
+
+		decoded.m_Width  = static_cast<std::uint32_t>(width);
+		decoded.m_Height = static_cast<std::uint32_t>(height);
+
+		// Lay out the full mip chain, down to 1x1
+		std::uint32_t mipCount = static_cast<std::uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+		vk::DeviceSize size    = 0;
+		for (std::uint32_t mip = 0; mip < mipCount; ++mip) {
+			decoded.m_MipOffsets.push_back(size);
+			size += static_cast<vk::DeviceSize>(std::max(decoded.m_Width >> mip, 1U)) * std::max(decoded.m_Height >> mip, 1U) * 4;
+		}
+		decoded.m_Pixels.resize(size);
+		std::copy(pixels, pixels + static_cast<std::size_t>(width) * height * 4, decoded.m_Pixels.begin());
+		stbi_image_free(pixels);
+
+		// Every mip is a 2x2 box filter of the previous one, odd edges reuse the last texel
+		auto& toLinear = GetSRGBToLinearTable();
+		for (std::uint32_t mip = 1; mip < mipCount; ++mip) {
+			std::uint32_t srcWidth  = std::max(decoded.m_Width >> (mip - 1), 1U);
+			std::uint32_t srcHeight = std::max(decoded.m_Height >> (mip - 1), 1U);
+			std::uint32_t dstWidth  = std::max(decoded.m_Width >> mip, 1U);
+			std::uint32_t dstHeight = std::max(decoded.m_Height >> mip, 1U);
+
+			const std::uint8_t* src = decoded.m_Pixels.data() + decoded.m_MipOffsets[mip - 1];
+			std::uint8_t* dst       = decoded.m_Pixels.data() + decoded.m_MipOffsets[mip];
+			for (std::uint32_t y = 0; y < dstHeight; ++y) {
+				std::uint32_t y0 = std::min(y * 2, srcHeight - 1);
+				std::uint32_t y1 = std::min(y * 2 + 1, srcHeight - 1);
+				for (std::uint32_t x = 0; x < dstWidth; ++x) {
+					std::uint32_t x0 = std::min(x * 2, srcWidth - 1);
+					std::uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1);
+
+					const std::uint8_t* texels[4] = { src + (y0 * srcWidth + x0) * 4, src + (y0 * srcWidth + x1) * 4, src + (y1 * srcWidth + x0) * 4, src + (y1 * srcWidth + x1) * 4 };
+					std::uint8_t* out             = dst + (y * dstWidth + x) * 4;
+					for (std::size_t c = 0; c < 3; ++c)
+						out[c] = LinearToSRGB((toLinear[texels[0][c]] + toLinear[texels[1][c]] + toLinear[texels[2][c]] + toLinear[texels[3][c]]) * 0.25f);
+					out[3] = static_cast<std::uint8_t>((texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3] + 2) / 4);
+				}
+			}
+		}
+	}
+
+	void TextureStreamer::createImage(Texture& texture) {
+		auto& decoded      = texture.m_Decoded;
+		texture.m_MipCount = static_cast<std::uint32_t>(decoded.m_MipOffsets.size());
+
+		vk::ImageCreateInfo createInfo       = { {}, vk::ImageType::e2D, vk::Format::eR8G8B8A8Srgb, { decoded.m_Width, decoded.m_Height, 1 }, texture.m_MipCount, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled, vk::SharingMode::eExclusive, {}, vk::ImageLayout::eUndefined };
+		VkImageCreateInfo createInfo_        = createInfo;
+		VmaAllocationCreateInfo allocateInfo = { {}, VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_ONLY, 0, 0, 0, 0, 0, 0.0f };
+
+		VkImage image;
+		texture.m_Image     = vk::createResultValue(static_cast<vk::Result>(vmaCreateImage(m_Allocator, &createInfo_, &allocateInfo, &image, &texture.m_ImageAllocation, nullptr)), image, "vmaCreateImage");
+		texture.m_ImageView = m_Device.createImageView({ {}, texture.m_Image, vk::ImageViewType::e2D, createInfo.format, {}, { vk::ImageAspectFlagBits::eColor, 0, texture.m_MipCount, 0, 1 } });
+	}
+} // namespace Graphics
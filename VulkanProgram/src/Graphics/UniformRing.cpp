@@ -0,0 +1,69 @@
+#include "Graphics/UniformRing.h"
+
+#include <stdexcept>
+
+namespace Graphics {
+	UniformRing::UniformRing(vk::PhysicalDevice physicalDevice, VmaAllocator allocator, vk::DeviceSize frameSize, std::uint32_t framesInFlight, vk::DeviceSize bindingRange)
+	    : m_PhysicalDevice(physicalDevice), m_Allocator(allocator), m_FrameSize(frameSize), m_FramesInFlight(std::max(framesInFlight, 1U)), m_BindingRange(bindingRange) { }
+
+	UniformRing::~UniformRing() {
+		if (isCreated())
+			destroy();
+	}
+
+	void UniformRing::create() {
+		if (isCreated())
+			destroy();
+
+		// Every frame region has to start at a valid dynamic offset
+		m_Alignment = std::max<vk::DeviceSize>(m_PhysicalDevice.getProperties().limits.minUniformBufferOffsetAlignment, 16);
+		m_FrameSize = getAlignedSize(m_FrameSize);
+
+		// The last allocation of the last frame may be bound with the full binding range, which can reach past the end of the frame region
+		vk::BufferCreateInfo createInfo              = { {}, m_FrameSize * m_FramesInFlight + m_BindingRange, vk::BufferUsageFlagBits::eUniformBuffer, vk::SharingMode::eExclusive, {} };
+		VmaAllocationCreateInfo allocationCreateInfo = {};
+		allocationCreateInfo.flags                   = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+		allocationCreateInfo.usage                   = VMA_MEMORY_USAGE_CPU_TO_GPU;
+
+		VkBuffer buffer;
+		VmaAllocationInfo allocationInfo;
+		vk::Result result = static_cast<vk::Result>(vmaCreateBuffer(m_Allocator, reinterpret_cast<VkBufferCreateInfo*>(&createInfo), &allocationCreateInfo, &buffer, &m_BufferAllocation, &allocationInfo));
+		if (result != vk::Result::eSuccess)
+			vk::throwResultException(result, "vmaCreateBuffer");
+		m_Buffer = buffer;
+		m_Data   = static_cast<std::uint8_t*>(allocationInfo.pMappedData);
+
+		m_CurrentFrame = 0;
+		m_Head.store(0, std::memory_order_relaxed);
+	}
+
+	void UniformRing::destroy() {
+		vmaDestroyBuffer(m_Allocator, m_Buffer, m_BufferAllocation);
+
+		m_Buffer           = nullptr;
+		m_BufferAllocation = nullptr;
+		m_Data             = nullptr;
+	}
+
+	void UniformRing::beginFrame(std::uint32_t frame) {
+		m_CurrentFrame = frame % m_FramesInFlight;
+		m_Head.store(0, std::memory_order_relaxed);
+	}
+
+	void UniformRing::flush() {
+		// Host writes to non coherent memory have to be flushed before the submission that reads them, this is a no-op for coherent memory
+		vk::DeviceSize usage = getFrameUsage();
+		if (usage > 0)
+			vmaFlushAllocation(m_Allocator, m_BufferAllocation, m_CurrentFrame * m_FrameSize, usage);
+	}
+
+	UniformAllocation UniformRing::allocate(vk::DeviceSize size) {
+		vk::DeviceSize alignedSize = getAlignedSize(size);
+		vk::DeviceSize offset      = m_Head.fetch_add(alignedSize, std::memory_order_relaxed);
+		if (offset + alignedSize > m_FrameSize)
+			throw std::runtime_error("Uniform ring frame region is exhausted");
+
+		vk::DeviceSize bufferOffset = m_CurrentFrame * m_FrameSize + offset;
+		return { m_Data + bufferOffset, static_cast<std::uint32_t>(bufferOffset) };
+	}
+} // namespace Graphics
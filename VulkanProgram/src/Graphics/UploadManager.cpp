@@ -0,0 +1,268 @@
+#include "Graphics/UploadManager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace Graphics {
+	UploadManager::UploadManager(vk::Device device, VmaAllocator allocator, vk::Queue transferQueue, std::uint32_t transferFamilyIndex, std::uint32_t graphicsFamilyIndex, vk::DeviceSize stagingSize)
+	    : m_Device(device), m_Allocator(allocator), m_TransferQueue(transferQueue), m_TransferFamilyIndex(transferFamilyIndex), m_GraphicsFamilyIndex(graphicsFamilyIndex), m_StagingSize(stagingSize) { }
+
+	UploadManager::~UploadManager() {
+		if (isCreated())
+			destroy();
+	}
+
+	void UploadManager::create() {
+		if (isCreated())
+			destroy();
+
+		// Create the persistently mapped staging ring
+		vk::BufferCreateInfo stagingBufferCreateInfo = { {}, m_StagingSize, vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive, {} };
+		VmaAllocationCreateInfo allocationCreateInfo = {};
+		allocationCreateInfo.flags                   = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+		allocationCreateInfo.usage                   = VMA_MEMORY_USAGE_CPU_ONLY;
+
+		VkBuffer stagingBuffer;
+		VmaAllocationInfo allocationInfo;
+		vk::Result result = static_cast<vk::Result>(vmaCreateBuffer(m_Allocator, reinterpret_cast<VkBufferCreateInfo*>(&stagingBufferCreateInfo), &allocationCreateInfo, &stagingBuffer, &m_StagingBufferAllocation, &allocationInfo));
+		if (result != vk::Result::eSuccess)
+			vk::throwResultException(result, "vmaCreateBuffer");
+		m_StagingBuffer = stagingBuffer;
+		m_StagingData   = static_cast<std::uint8_t*>(allocationInfo.pMappedData);
+
+		m_CommandPool = m_Device.createCommandPool({ vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer, m_TransferFamilyIndex });
+
+		m_RingHead            = 0;
+		m_RingTail            = 0;
+		m_Recording           = false;
+		m_NextBatchId         = 1;
+		m_LastAcquiredBatchId = 0;
+		m_UploadedBytes       = 0;
+	}
+
+	void UploadManager::destroy() {
+		// Destroying the objects of a batch that is still executing is not allowed
+		retireTransfers(true);
+
+		auto destroyBatch = [this](Batch& batch) {
+			if (batch.m_Fence)
+				m_Device.destroyFence(batch.m_Fence);
+			if (batch.m_Semaphore)
+				m_Device.destroySemaphore(batch.m_Semaphore);
+		};
+
+		if (m_Recording)
+			m_CurrentBatch.m_CommandBuffer.end();
+		destroyBatch(m_CurrentBatch);
+		for (auto& batch : m_InFlightBatches) destroyBatch(batch);
+		for (auto& batch : m_FreeBatches) destroyBatch(batch);
+		m_CurrentBatch = {};
+		m_InFlightBatches.clear();
+		m_FreeBatches.clear();
+		m_Recording = false;
+
+		m_Device.destroyCommandPool(m_CommandPool);
+		vmaDestroyBuffer(m_Allocator, m_StagingBuffer, m_StagingBufferAllocation);
+
+		m_CommandPool             = nullptr;
+		m_StagingBuffer           = nullptr;
+		m_StagingBufferAllocation = nullptr;
+		m_StagingData             = nullptr;
+	}
+
+	void UploadManager::uploadBuffer(vk::Buffer buffer, vk::DeviceSize offset, const void* data, vk::DeviceSize size, vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess) {
+		auto source = static_cast<const std::uint8_t*>(data);
+
+		vk::DeviceSize written = 0;
+		while (written < size) {
+			vk::DeviceSize chunkSize     = std::min(size - written, m_StagingSize);
+			vk::DeviceSize stagingOffset = allocateStaging(chunkSize, 16);
+			std::memcpy(m_StagingData + stagingOffset, source + written, chunkSize);
+
+			beginBatch(dstStage);
+			m_CurrentBatch.m_CommandBuffer.copyBuffer(m_StagingBuffer, buffer, { { stagingOffset, offset + written, chunkSize } });
+			written += chunkSize;
+		}
+
+		// Buffers in the same queue family only need the semaphore, otherwise the ownership has to be released here and acquired in 'acquire'
+		beginBatch(dstStage);
+		if (isDedicatedTransferQueue()) {
+			vk::BufferMemoryBarrier releaseBarrier = { vk::AccessFlagBits::eTransferWrite, {}, m_TransferFamilyIndex, m_GraphicsFamilyIndex, buffer, offset, size };
+			m_CurrentBatch.m_CommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, { releaseBarrier }, {});
+			m_CurrentBatch.m_AcquireBufferBarriers.push_back({ {}, dstAccess, m_TransferFamilyIndex, m_GraphicsFamilyIndex, buffer, offset, size });
+		}
+		m_UploadedBytes += size;
+	}
+
+	void UploadManager::uploadImage(vk::Image image, vk::ImageSubresourceLayers subresource, vk::Extent3D extent, const void* data, vk::DeviceSize size, vk::ImageLayout finalLayout, vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess) {
+		// Subresources larger than the ring are copied in slabs of whole rows, which needs at least one row to fit
+		vk::DeviceSize rowSize = size / (static_cast<vk::DeviceSize>(extent.height) * extent.depth);
+		if (size > m_StagingSize && (extent.depth > 1 || rowSize > m_StagingSize))
+			throw std::runtime_error("Image upload does not fit into the staging ring");
+
+		auto source = static_cast<const std::uint8_t*>(data);
+
+		beginBatch(dstStage);
+		vk::ImageSubresourceRange range = { subresource.aspectMask, subresource.mipLevel, 1, subresource.baseArrayLayer, subresource.layerCount };
+
+		vk::ImageMemoryBarrier toTransferBarrier = { {}, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image, range };
+		m_CurrentBatch.m_CommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, { toTransferBarrier });
+
+		std::uint32_t rowsPerSlab = size > m_StagingSize ? static_cast<std::uint32_t>(m_StagingSize / rowSize) : extent.height;
+		for (std::uint32_t row = 0; row < extent.height; row += rowsPerSlab) {
+			std::uint32_t rowCount  = std::min(rowsPerSlab, extent.height - row);
+			vk::DeviceSize slabSize = rowSize * rowCount * extent.depth;
+
+			// Texel copies need an offset that is a multiple of the texel size, 16 covers every uncompressed format
+			vk::DeviceSize stagingOffset = allocateStaging(slabSize, 16);
+			std::memcpy(m_StagingData + stagingOffset, source + rowSize * row, slabSize);
+
+			// Allocating can flush the batch, the copies still execute after the layout transition as they go to the same queue
+			beginBatch(dstStage);
+			m_CurrentBatch.m_CommandBuffer.copyBufferToImage(m_StagingBuffer, image, vk::ImageLayout::eTransferDstOptimal, { { stagingOffset, 0, 0, subresource, { 0, static_cast<std::int32_t>(row), 0 }, { extent.width, rowCount, extent.depth } } });
+		}
+
+		beginBatch(dstStage);
+		if (isDedicatedTransferQueue()) {
+			// The layout transition is part of the ownership transfer and has to match on both sides
+			vk::ImageMemoryBarrier releaseBarrier = { vk::AccessFlagBits::eTransferWrite, {}, vk::ImageLayout::eTransferDstOptimal, finalLayout, m_TransferFamilyIndex, m_GraphicsFamilyIndex, image, range };
+			m_CurrentBatch.m_CommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, {}, { releaseBarrier });
+			m_CurrentBatch.m_AcquireImageBarriers.push_back({ {}, dstAccess, vk::ImageLayout::eTransferDstOptimal, finalLayout, m_TransferFamilyIndex, m_GraphicsFamilyIndex, image, range });
+		} else {
+			// The semaphore wait makes the transfer write available, the destination access is covered by the wait stage
+			vk::ImageMemoryBarrier finalBarrier = { vk::AccessFlagBits::eTransferWrite, {}, vk::ImageLayout::eTransferDstOptimal, finalLayout, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image, range };
+			m_CurrentBatch.m_CommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, {}, { finalBarrier });
+		}
+		m_UploadedBytes += size;
+	}
+
+	std::uint64_t UploadManager::flush() {
+		if (!m_Recording)
+			return m_NextBatchId - 1;
+
+		m_CurrentBatch.m_CommandBuffer.end();
+		m_CurrentBatch.m_Id      = m_NextBatchId++;
+		m_CurrentBatch.m_RingEnd = m_RingHead;
+
+		vk::SubmitInfo submitInfo = { 0, nullptr, nullptr, 1, &m_CurrentBatch.m_CommandBuffer, 1, &m_CurrentBatch.m_Semaphore };
+		m_TransferQueue.submit({ submitInfo }, m_CurrentBatch.m_Fence);
+
+		std::uint64_t id = m_CurrentBatch.m_Id;
+		m_InFlightBatches.push_back(std::move(m_CurrentBatch));
+		m_CurrentBatch = {};
+		m_Recording    = false;
+		return id;
+	}
+
+	void UploadManager::acquire(vk::CommandBuffer commandBuffer, std::uint64_t frameSerial, std::vector<vk::Semaphore>& waitSemaphores, std::vector<vk::PipelineStageFlags>& waitStages) {
+		for (auto& batch : m_InFlightBatches) {
+			if (batch.m_Acquired)
+				continue;
+
+			// Every semaphore is waited on exactly once, by the first graphics submission after the flush
+			waitSemaphores.push_back(batch.m_Semaphore);
+			waitStages.push_back(batch.m_DstStages);
+			if (!batch.m_AcquireBufferBarriers.empty() || !batch.m_AcquireImageBarriers.empty())
+				commandBuffer.pipelineBarrier(batch.m_DstStages, batch.m_DstStages, {}, {}, batch.m_AcquireBufferBarriers, batch.m_AcquireImageBarriers);
+
+			batch.m_Acquired           = true;
+			batch.m_AcquireFrameSerial = frameSerial;
+			m_LastAcquiredBatchId      = batch.m_Id;
+		}
+	}
+
+	void UploadManager::collect(std::uint64_t completedFrameSerial) {
+		retireTransfers(false);
+
+		// A batch is only reused once the frame that waited on its semaphore has finished, otherwise the semaphore could still be pending
+		while (!m_InFlightBatches.empty()) {
+			auto& batch = m_InFlightBatches.front();
+			if (!batch.m_TransferComplete || !batch.m_Acquired || batch.m_AcquireFrameSerial > completedFrameSerial)
+				break;
+
+			batch.m_AcquireBufferBarriers.clear();
+			batch.m_AcquireImageBarriers.clear();
+			m_FreeBatches.push_back(std::move(batch));
+			m_InFlightBatches.pop_front();
+		}
+	}
+
+	void UploadManager::beginBatch(vk::PipelineStageFlags dstStage) {
+		if (m_Recording) {
+			m_CurrentBatch.m_DstStages |= dstStage;
+			return;
+		}
+
+		if (!m_FreeBatches.empty()) {
+			m_CurrentBatch = std::move(m_FreeBatches.back());
+			m_FreeBatches.pop_back();
+			m_Device.resetFences({ m_CurrentBatch.m_Fence });
+		} else {
+			m_CurrentBatch.m_CommandBuffer = m_Device.allocateCommandBuffers({ m_CommandPool, vk::CommandBufferLevel::ePrimary, 1 })[0];
+			m_CurrentBatch.m_Fence         = m_Device.createFence({ vk::FenceCreateFlags {} });
+			m_CurrentBatch.m_Semaphore     = m_Device.createSemaphore({ vk::SemaphoreCreateFlags {} });
+		}
+
+		m_CurrentBatch.m_Id                 = 0;
+		m_CurrentBatch.m_RingEnd            = 0;
+		m_CurrentBatch.m_AcquireFrameSerial = 0;
+		m_CurrentBatch.m_TransferComplete   = false;
+		m_CurrentBatch.m_Acquired           = false;
+		m_CurrentBatch.m_DstStages          = dstStage;
+
+		m_CurrentBatch.m_CommandBuffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit, nullptr });
+		m_Recording = true;
+	}
+
+	vk::DeviceSize UploadManager::allocateStaging(vk::DeviceSize size, vk::DeviceSize alignment) {
+		while (true) {
+			std::uint64_t start = (m_RingHead + alignment - 1) / alignment * alignment;
+
+			// An allocation never wraps around the end of the ring, skip to the next lap instead
+			if (start % m_StagingSize + size > m_StagingSize)
+				start = (start / m_StagingSize + 1) * m_StagingSize;
+
+			// An empty ring can start over at the skipped to position
+			if (m_RingTail == m_RingHead)
+				m_RingTail = m_RingHead = start;
+
+			if (start + size - m_RingTail <= m_StagingSize) {
+				m_RingHead = start + size;
+				return start % m_StagingSize;
+			}
+
+			// The ring is full, the uploads recorded so far have to be submitted before their staging memory can be waited on
+			if (m_InFlightBatches.empty() || std::all_of(m_InFlightBatches.begin(), m_InFlightBatches.end(), [](const Batch& batch) { return batch.m_TransferComplete; }))
+				flush();
+			retireTransfers(true);
+		}
+	}
+
+	void UploadManager::retireTransfers(bool wait) {
+		for (auto& batch : m_InFlightBatches) {
+			if (batch.m_TransferComplete)
+				continue;
+
+			if (wait) {
+				vk::Result result = m_Device.waitForFences({ batch.m_Fence }, true, ~0ULL);
+				if (result != vk::Result::eSuccess)
+					vk::throwResultException(result, "vk::Device::waitForFences");
+			} else if (m_Device.getFenceStatus(batch.m_Fence) != vk::Result::eSuccess) {
+				break;
+			}
+
+			batch.m_TransferComplete = true;
+			m_RingTail               = std::max(m_RingTail, batch.m_RingEnd);
+
+			// Waiting on the oldest pending transfer is enough to make room
+			if (wait)
+				break;
+		}
+
+		// Nothing is in flight, so the whole ring is free again
+		if (!m_Recording && std::all_of(m_InFlightBatches.begin(), m_InFlightBatches.end(), [](const Batch& batch) { return batch.m_TransferComplete; }))
+			m_RingTail = m_RingHead;
+	}
+} // namespace Graphics
@@ -0,0 +1,26 @@
+#include "Graphics/VertexInput.h"
+
+#include <stdexcept>
+
+namespace Graphics {
+	vk::Format VertexInput::GetFormat(Utils::VertexEncoding encoding) {
+		switch (encoding) {
+		case Utils::VertexEncoding::Float32x2: return vk::Format::eR32G32Sfloat;
+		case Utils::VertexEncoding::Float32x3: return vk::Format::eR32G32B32Sfloat;
+		case Utils::VertexEncoding::Float32x4: return vk::Format::eR32G32B32A32Sfloat;
+		case Utils::VertexEncoding::Float16x2: return vk::Format::eR16G16Sfloat;
+		case Utils::VertexEncoding::Unorm16x4: return vk::Format::eR16G16B16A16Unorm;
+		default: return vk::Format::eUndefined;
+		}
+	}
+
+	void VertexInput::Apply(GraphicsPipelineDesc& desc, const Utils::VertexLayout& layout, std::uint32_t binding, std::initializer_list<Utils::VertexSemantic> semantics) {
+		desc.m_VertexBindings   = { { binding, layout.getStride(), vk::VertexInputRate::eVertex } };
+		desc.m_VertexAttributes.clear();
+		for (auto semantic : semantics) {
+			if (!layout.hasAttribute(semantic))
+				throw std::runtime_error("Vertex layout lacks an attribute the vertex shader reads");
+			desc.m_VertexAttributes.push_back({ static_cast<std::uint32_t>(semantic), binding, GetFormat(layout.getEncoding(semantic)), layout.getOffset(semantic) });
+		}
+	}
+} // namespace Graphics
@@ -2,14 +2,51 @@
 
 #if USE_GRAPHICS
 	#include "Graphics/Instance.h"
+#else
+	#include "Graphics/AsyncCompute.h"
+	#include "Graphics/BindlessTable.h"
+	#include "Graphics/DeletionQueue.h"
+	#include "Graphics/FramePacer.h"
+	#include "Graphics/GPUCuller.h"
+	#include "Graphics/GPUProfiler.h"
+	#include "Graphics/GeometryArena.h"
+	#include "Graphics/ImGuiRenderer.h"
+	#include "Graphics/OffscreenTarget.h"
+	#include "Graphics/ParticleSystem.h"
+	#include "Graphics/PipelineCache.h"
+	#include "Graphics/PipelineCompiler.h"
+	#include "Graphics/RenderQueue.h"
+	#include "Graphics/ShaderLibrary.h"
+	#include "Graphics/Swapchain.h"
+	#include "Graphics/TextureStreamer.h"
+	#include "Graphics/UniformRing.h"
+	#include "Graphics/UploadManager.h"
+	#include "Graphics/VertexInput.h"
+	#include "Utils/VertexLayout.h"
 #endif
 
+// The option parsing and draw helpers are compiled in both configurations
+#include "Graphics/Common.h"
+#include "Graphics/Device.h"
+#include "Utils/CPUProfiler.h"
+#include "Utils/Math.h"
+#include "Utils/MeshFile.h"
+#include "Utils/ThreadPool.h"
+
+#include <cmath>
 #include <cstdint>
 #include <cstdlib>
 
-#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 #include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include <vulkan.hpp>
@@ -18,6 +55,10 @@
 
 #include <GLFW/glfw3.h>
 
+#include <imgui.h>
+
+#include <stb_image_write.h>
+
 #define VULKAN_PROGRAM_NAME "VulkanProgram"
 #define VULKAN_PROGRAM_VERSION VK_MAKE_API_VERSION(0, 0, 1, 0)
 #define VULKAN_ENGINE_NAME "VulkanEngine"
@@ -26,7 +67,27 @@
 #define VULKAN_MAX_VERSION VK_API_VERSION_1_2
 
 #define VULKAN_VSYNC false
-#define VULKAN_MAX_FRAMES_IN_FLIGHT 2
+#define VULKAN_DEFAULT_FRAMES_IN_FLIGHT 2
+#define VULKAN_MAX_FRAMES_IN_FLIGHT 8
+
+#define VULKAN_PIPELINE_CACHE_PATH "pipeline_cache.bin"
+#define VULKAN_INSTANCE_SNAPSHOT_PATH "instance_snapshot.txt"
+#define VULKAN_SHADER_DIRECTORY "shaders"
+#define VULKAN_SHADER_ARCHIVE_PATH "shaders/shaders.spva"
+
+#define VULKAN_STAGING_RING_SIZE (32ULL * 1024 * 1024)
+#define VULKAN_UNIFORM_RING_FRAME_SIZE (1ULL * 1024 * 1024)
+#define VULKAN_TEXTURE_UPLOAD_BUDGET (8ULL * 1024 * 1024)
+
+#define VULKAN_GEOMETRY_PAGE_VERTEX_COUNT (1U << 20)
+#define VULKAN_GEOMETRY_PAGE_INDEX_COUNT (1U << 22)
+#define VULKAN_GEOMETRY_DEFRAGMENT_THRESHOLD 0.5f
+
+#define VULKAN_BINDLESS_IMAGE_CAPACITY 16384
+#define VULKAN_BINDLESS_SAMPLER_CAPACITY 16
+
+#define VULKAN_HEADLESS_DEFAULT_FRAME_COUNT 1000
+#define VULKAN_HEADLESS_COLOR_FORMAT vk::Format::eR8G8B8A8Srgb
 
 #ifdef _DEBUG
 static std::string vulkanGetMessageSeverity(VkDebugUtilsMessageSeverityFlagBitsEXT severity) {
@@ -73,9 +134,228 @@ static VkBool32 vulkanDebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messa
 }
 #endif
 
+struct ProgramOptions {
+public:
+	std::uint32_t m_FramesInFlight = VULKAN_DEFAULT_FRAMES_IN_FLIGHT;
+	bool m_PackShaders             = false; // Packs every '.spv' file in the shader directory into the shader archive before loading shaders
+
+	// Headless mode renders into offscreen images without a window, surface or swapchain
+	bool m_Headless            = false;
+	std::uint32_t m_FrameCount = 0; // 0 runs until the window is closed, or VULKAN_HEADLESS_DEFAULT_FRAME_COUNT frames when headless
+	std::uint32_t m_Width      = 1280;
+	std::uint32_t m_Height     = 720;
+	std::string m_OutputPath; // Headless only, writes the last frame as a png when not empty
+
+	std::uint32_t m_ThreadCount = 1; // Number of threads recording draws, 0 uses every hardware thread
+	std::uint32_t m_DrawCount   = 1;
+
+	std::vector<std::string> m_TexturePaths; // Streamed in the background, the first one replaces the placeholder texture once resident
+	bool m_Bindless  = false;                // Draws index one bindless texture table instead of switching descriptor sets, falls back if descriptor indexing is missing
+	bool m_GPUDriven = false;                // Draws are culled in a compute pass and issued with one indirect call, textures always come from the per frame descriptor sets
+
+	bool m_Overlay = false;          // Shows the GPU profiler in an ImGui overlay
+	std::string m_ProfileOutputPath; // Writes the GPU profile on exit when not empty, as a Chrome trace for '.json' and as CSV otherwise
+	std::string m_TraceOutputPath;   // Writes the CPU zones on exit as a Chrome trace when not empty
+
+	std::uint32_t m_ResizeStorm = 0; // Resizes the window every frame for this many frames and reports frame time spikes caused by recreating the swapchain
+
+	std::uint32_t m_HandleBenchmark = 0; // Times attaching, creating, destroying and detaching this many child handles, then exits
+
+	std::string m_MeshPath; // Draws a mesh cooked by the MeshCooker instead of the built-in quads when not empty
+	float m_LODThreshold = 1.0f; // Draws pick the coarsest level of detail whose error projects to at most this many pixels
+
+	std::uint32_t m_ParticleCount = 0;    // Simulates and draws this many particles on the GPU when not 0
+	bool m_AsyncCompute           = true; // Simulates on the dedicated compute queue if there is one, overlapping with rendering, instead of in the graphics command buffer
+};
+
+struct DrawCommand {
+public:
+	std::uint32_t m_IndexCount  = 0;
+	std::uint32_t m_FirstIndex  = 0;
+	std::int32_t m_VertexOffset = 0;
+	Utils::Mat4 m_Model         = Utils::Mat4::Identity();
+	std::uint32_t m_Texture     = 0; // Index into the streamed textures, drawn with the placeholder until that one is resident
+};
+
+// Frame times of the resize storm benchmark, kept apart for frames that recreated the swapchain
+struct FrameTimeStats {
+public:
+	void add(double time) {
+		m_Total += time;
+		m_Max = std::max(m_Max, time);
+		++m_Count;
+	}
+
+	double getAverage() const { return m_Count ? m_Total / m_Count : 0.0; }
+
+public:
+	double m_Total        = 0.0;
+	double m_Max          = 0.0;
+	std::uint32_t m_Count = 0;
+};
+
+// Stand-in for the handle graph benchmark, creating and destroying it only does the graph bookkeeping
+struct BenchmarkHandle : public Graphics::Handle<void*> {
+public:
+	~BenchmarkHandle() {
+		if (isCreated())
+			destroy();
+	}
+
+private:
+	virtual void createImpl() override { m_Handle = this; }
+	virtual bool destroyImpl() override { return true; }
+};
+
+// Times every operation of the handle graph for one parent with 'count' children
+static void runHandleBenchmark(std::uint32_t count) {
+	auto elapsed = [](std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	BenchmarkHandle root;
+	std::vector<std::unique_ptr<BenchmarkHandle>> children(count);
+
+	auto start = std::chrono::steady_clock::now();
+	for (auto& child : children) {
+		child = std::make_unique<BenchmarkHandle>();
+		child->attach(root);
+	}
+	double attachTime = elapsed(start);
+
+	start = std::chrono::steady_clock::now();
+	root.createTree();
+	double createTime = elapsed(start);
+
+	// Recreating the root destroys every child and creates it again
+	start = std::chrono::steady_clock::now();
+	root.create();
+	double recreateTime = elapsed(start);
+
+	start = std::chrono::steady_clock::now();
+	root.destroy();
+	double destroyTime = elapsed(start);
+
+	// Free the children in random order, so most of them detach from the middle of the root's child list
+	std::shuffle(children.begin(), children.end(), std::mt19937(1234));
+	start = std::chrono::steady_clock::now();
+	children.clear();
+	double detachTime = elapsed(start);
+
+	std::cout << "Handle graph with " << count << " children: attach " << attachTime << " ms, create " << createTime << " ms, recreate " << recreateTime << " ms, destroy " << destroyTime << " ms, detach " << detachTime << " ms\n";
+}
+
+// Clip space depth of the origin of 'model', used to sort draws front to back
+static float getClipDepth(const Utils::Mat4& projView, const Utils::Mat4& model) {
+	const float* m = projView.m_Values;
+	const float* t = model.m_Values + 12;
+	float z        = m[2] * t[0] + m[6] * t[1] + m[10] * t[2] + m[14];
+	float w        = m[3] * t[0] + m[7] * t[1] + m[11] * t[2] + m[15];
+	return w != 0.0f ? z / w : z;
+}
+
+// Coarsest level of detail in 'lods' whose error stays within 'threshold' pixels at the point of the bounding sphere closest to the camera.
+// Pixels per model unit come from the vertical scale of 'projView' and the largest axis scale of 'model', which holds for perspective and orthographic projections
+static std::size_t selectLOD(const std::vector<Utils::MeshFileSubmesh>& lods, const Utils::Mat4& projView, const Utils::Mat4& model, float boundingRadius, float viewportHeight, float threshold) {
+	const float* m   = projView.m_Values;
+	const float* a   = model.m_Values;
+	float modelScale = std::sqrt(std::max({ a[0] * a[0] + a[1] * a[1] + a[2] * a[2], a[4] * a[4] + a[5] * a[5] + a[6] * a[6], a[8] * a[8] + a[9] * a[9] + a[10] * a[10] }));
+	float w          = m[3] * a[12] + m[7] * a[13] + m[11] * a[14] + m[15] - boundingRadius * modelScale * std::sqrt(m[3] * m[3] + m[7] * m[7] + m[11] * m[11]);
+	if (w <= 0.0f)
+		return 0;
+
+	float pixelsPerUnit = std::sqrt(m[1] * m[1] + m[5] * m[5] + m[9] * m[9]) * modelScale * viewportHeight * 0.5f / w;
+	std::size_t lod     = 0;
+	while (lod + 1 < lods.size() && lods[lod + 1].m_Error * pixelsPerUnit <= threshold)
+		++lod;
+	return lod;
+}
+
+// Camera flying over a grid of 'gridSize' by 'gridSize' draws 'spacing' apart in the xz plane, starting at z = 0 and extending into -z.
+// It moves back and forth over the front half of the grid, so draws keep crossing the distances at which the level of detail changes
+static Utils::Mat4 getCameraProjView(float time, float aspect, float spacing, std::uint32_t gridSize) {
+	float depth    = static_cast<float>(gridSize) * spacing;
+	float travel   = depth * 0.25f * (1.0f - std::cos(time * 0.25f));
+	float eye[]    = { 0.0f, spacing, 2.0f * spacing - travel };
+	float target[] = { 0.0f, 0.0f, eye[2] - 4.0f * spacing };
+	float up[]     = { 0.0f, 1.0f, 0.0f };
+	return Utils::Mat4::Perspective(1.0f, aspect, 0.05f * spacing, depth + 4.0f * spacing) * Utils::Mat4::LookAt(eye, target, up);
+}
+
+static ProgramOptions parseProgramOptions(int argc, char** argv) {
+	ProgramOptions options;
+	for (int i = 1; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		if (arg == "--frames-in-flight" && i + 1 < argc)
+			options.m_FramesInFlight = std::clamp(static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10)), 1U, static_cast<std::uint32_t>(VULKAN_MAX_FRAMES_IN_FLIGHT));
+		else if (arg == "--pack-shaders")
+			options.m_PackShaders = true;
+		else if (arg == "--headless")
+			options.m_Headless = true;
+		else if (arg == "--frames" && i + 1 < argc)
+			options.m_FrameCount = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if (arg == "--width" && i + 1 < argc)
+			options.m_Width = std::max(static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10)), 1U);
+		else if (arg == "--height" && i + 1 < argc)
+			options.m_Height = std::max(static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10)), 1U);
+		else if (arg == "--output" && i + 1 < argc)
+			options.m_OutputPath = argv[++i];
+		else if (arg == "--threads" && i + 1 < argc)
+			options.m_ThreadCount = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if (arg == "--draws" && i + 1 < argc)
+			options.m_DrawCount = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if (arg == "--texture" && i + 1 < argc)
+			options.m_TexturePaths.push_back(argv[++i]);
+		else if (arg == "--bindless")
+			options.m_Bindless = true;
+		else if (arg == "--gpu-driven")
+			options.m_GPUDriven = true;
+		else if (arg == "--overlay")
+			options.m_Overlay = true;
+		else if (arg == "--profile-output" && i + 1 < argc)
+			options.m_ProfileOutputPath = argv[++i];
+		else if (arg == "--trace-output" && i + 1 < argc)
+			options.m_TraceOutputPath = argv[++i];
+		else if (arg == "--resize-storm" && i + 1 < argc)
+			options.m_ResizeStorm = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if (arg == "--handle-benchmark" && i + 1 < argc)
+			options.m_HandleBenchmark = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if (arg == "--mesh" && i + 1 < argc)
+			options.m_MeshPath = argv[++i];
+		else if (arg == "--lod-threshold" && i + 1 < argc)
+			options.m_LODThreshold = std::strtof(argv[++i], nullptr);
+		else if (arg == "--particles" && i + 1 < argc)
+			options.m_ParticleCount = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		else if (arg == "--no-async-compute")
+			options.m_AsyncCompute = false;
+		else
+			std::cerr << "Unknown argument '" << arg << "'\n";
+	}
+
+	if (options.m_Headless && options.m_FrameCount == 0)
+		options.m_FrameCount = VULKAN_HEADLESS_DEFAULT_FRAME_COUNT;
+	if (options.m_ThreadCount == 0)
+		options.m_ThreadCount = static_cast<std::uint32_t>(Utils::ThreadPool::GetHardwareThreadCount());
+	return options;
+}
+
 int main(int argc, char** argv) {
+	// Used to report time to first frame
+	auto startTime = std::chrono::steady_clock::now();
+
 	try {
-		// Initialize GLFW
+		PROFILE_THREAD("Main");
+		ProgramOptions options = parseProgramOptions(argc, argv);
+		if (options.m_HandleBenchmark > 0) {
+			runHandleBenchmark(options.m_HandleBenchmark);
+			return EXIT_SUCCESS;
+		}
+
+		// Initialize GLFW, headless mode uses the null platform so no display is required
+#ifdef GLFW_PLATFORM_NULL
+		if (options.m_Headless)
+			glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
 		if (!glfwInit()) {
 			std::cerr << "GLFW failed to initialize!\n";
 			return EXIT_FAILURE;
@@ -90,23 +370,30 @@ int main(int argc, char** argv) {
 		// Set window hints
 		glfwDefaultWindowHints();
 		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-		glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE); // INFO: Disable resizing, enable once you can recreate the swapchain without lots of code. :)
+		glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
 		// Create window
-		GLFWwindow* windowPtr = glfwCreateWindow(1280, 720, VULKAN_PROGRAM_NAME, nullptr, nullptr);
+		GLFWwindow* windowPtr = nullptr;
+		if (!options.m_Headless)
+			windowPtr = glfwCreateWindow(static_cast<int>(options.m_Width), static_cast<int>(options.m_Height), VULKAN_PROGRAM_NAME, nullptr, nullptr);
 
 #if USE_GRAPHICS
+		// Seed the available layers and extensions from the last run, enumerating them through the loader is a measurable part of startup
+		Graphics::Instance::LoadEnumerationSnapshot(VULKAN_INSTANCE_SNAPSHOT_PATH);
+
 		Graphics::Instance instance = { "VulkanProgram", { 0, 0, 1, 0 }, "VulkanEngine", { 0, 0, 1, 0 }, VK_API_VERSION_1_0, VK_API_VERSION_1_2 };
 
 	#ifdef _DEBUG
 		instance.requestLayer("VK_LAYER_KHRONOS_validation", { 0 }, false);
 	#endif
 
-		std::uint32_t glfwExtensionCount;
-		const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+		if (!options.m_Headless) {
+			std::uint32_t glfwExtensionCount;
+			const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
-		for (std::size_t i = 0; i < glfwExtensionCount; ++i)
-			instance.requestExtension(glfwExtensions[i]);
+			for (std::size_t i = 0; i < glfwExtensionCount; ++i)
+				instance.requestExtension(glfwExtensions[i]);
+		}
 
 	#ifdef _DEBUG
 		instance.requestExtension("VK_EXT_debug_utils", { 0 }, false);
@@ -134,6 +421,14 @@ int main(int argc, char** argv) {
 			}
 		}
 
+		if (!Graphics::Instance::IsEnumerationFromSnapshot() && !Graphics::Instance::SaveEnumerationSnapshot(VULKAN_INSTANCE_SNAPSHOT_PATH))
+			std::cerr << "Failed to write instance snapshot to '" << VULKAN_INSTANCE_SNAPSHOT_PATH << "'\n";
+
+		// The device is a child of the instance, destroying the instance destroys it first
+		Graphics::Device device = { instance };
+		if (!device.create())
+			throw std::runtime_error("No physical device can be used");
+
 		instance.destroy();
 #else
 		// Get Implementation Version
@@ -166,6 +461,8 @@ int main(int argc, char** argv) {
 		// Create Vulkan Instance
 		vk::Instance vulkanInstance;
 		{
+			PROFILE_ZONE("Create instance");
+
 			vk::ApplicationInfo appInfo = { VULKAN_PROGRAM_NAME, VULKAN_PROGRAM_VERSION, VULKAN_ENGINE_NAME, VULKAN_ENGINE_VERSION, vulkanInstanceVersion };
 
 			std::vector<const char*> enabledLayerNames;
@@ -176,14 +473,16 @@ int main(int argc, char** argv) {
 			enabledLayerNames.push_back("VK_LAYER_KHRONOS_validation");
 	#endif
 
-			// Get required Instance extensions from GLFW
-			std::uint32_t glfwExtensionCount;
-			const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+			// Get required Instance extensions from GLFW, headless mode doesn't need any as it never creates a surface
+			if (!options.m_Headless) {
+				std::uint32_t glfwExtensionCount;
+				const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
-			// Add the extensions
-			enabledExtensionNames.resize(glfwExtensionCount);
-			for (std::size_t i = 0; i < glfwExtensionCount; ++i)
-				enabledExtensionNames[i] = glfwExtensions[i];
+				// Add the extensions
+				enabledExtensionNames.resize(glfwExtensionCount);
+				for (std::size_t i = 0; i < glfwExtensionCount; ++i)
+					enabledExtensionNames[i] = glfwExtensions[i];
+			}
 
 	#ifdef _DEBUG
 			// Add debug utils extension in Debug mode
@@ -208,173 +507,204 @@ int main(int argc, char** argv) {
 
 		// Create surface from window
 		vk::SurfaceKHR vulkanSurface;
-		{
+		if (!options.m_Headless) {
 			VkSurfaceKHR surface;
 			vulkanSurface = vk::createResultValue(static_cast<vk::Result>(glfwCreateWindowSurface(vulkanInstance, windowPtr, nullptr, &surface)), surface, "glfwCreateWindowSurface");
 		}
 
-		// Pick the best physical device
+		// Pick the best scored physical device, every capability it has is enabled on the device so the fast paths below switch on by themselves
+		std::vector<const char*> requiredDeviceExtensions;
+		if (!options.m_Headless)
+			requiredDeviceExtensions.push_back("VK_KHR_swapchain");
+
 		vk::PhysicalDevice vulkanPhysicalDevice;
+		Graphics::DeviceCapabilities deviceCapabilities;
+		Graphics::DeviceQueueFamilies deviceQueueFamilies;
 		{
-			std::size_t bestScore = 0L;
-
-			// Enumerate all physical devices from the Vulkan Instance and iterate through them
-			for (auto& physicalDevice : vulkanInstance.enumeratePhysicalDevices()) {
-				std::size_t score = 0L;
-
-				// Get properties and features from the current physical device
-				auto properties = physicalDevice.getProperties();
-				auto features   = physicalDevice.getFeatures();
-
-				// Prioritize better gpus
-				switch (properties.deviceType) {
-				case vk::PhysicalDeviceType::eCpu: score += 1L; break;
-				case vk::PhysicalDeviceType::eOther: score += 2L; break;
-				case vk::PhysicalDeviceType::eVirtualGpu: score += 3L; break;
-				case vk::PhysicalDeviceType::eIntegratedGpu: score += 4L; break;
-				case vk::PhysicalDeviceType::eDiscreteGpu: score += 5L; break;
-				}
+			PROFILE_ZONE("Pick physical device");
 
-				// If this physical device scored better than any previous ones, then select this one
-				if (bestScore == 0L || score > bestScore) {
-					bestScore            = score;
-					vulkanPhysicalDevice = physicalDevice;
-				}
-			}
+			vulkanPhysicalDevice = Graphics::Device::PickPhysicalDevice(vulkanInstance, vulkanInstanceVersion, vulkanSurface, requiredDeviceExtensions);
+			if (!vulkanPhysicalDevice)
+				throw std::runtime_error("No physical device can be used");
+
+			deviceCapabilities  = Graphics::Device::GetCapabilities(vulkanPhysicalDevice, vulkanInstanceVersion);
+			deviceQueueFamilies = Graphics::Device::GetQueueFamilies(vulkanPhysicalDevice, vulkanSurface);
 		}
 
-		// Find Graphics & Present queue family index
-		std::uint32_t graphicsFamilyIndex = 0;
-		{
-			auto queueFamilies = vulkanPhysicalDevice.getQueueFamilyProperties();
+		// GPU driven draws pass the object index as the first instance, without 'drawIndirectFirstInstance' the draws are recorded on the CPU
+		if (options.m_GPUDriven && !deviceCapabilities.m_DrawIndirectFirstInstance) {
+			options.m_GPUDriven = false;
+			std::cerr << "Indirect draws can't set the first instance, falling back to CPU recorded draws\n";
+		}
 
-			std::uint32_t i = 0;
-			for (auto& queueFamily : queueFamilies) {
-				if ((queueFamily.queueFlags & vk::QueueFlagBits::eGraphics) && vulkanPhysicalDevice.getSurfaceSupportKHR(i, vulkanSurface)) {
-					graphicsFamilyIndex = i;
-					break;
-				}
+		// Use the bindless texture table only if the device supports descriptor indexing, the per frame descriptor sets remain the fallback
+		bool bindless = false;
+		if (options.m_Bindless && options.m_GPUDriven) {
+			std::cerr << "The bindless texture table is not used for GPU driven draws\n";
+		} else if (options.m_Bindless) {
+			bindless = deviceCapabilities.m_DescriptorIndexing;
+			if (!bindless)
+				std::cerr << "Descriptor indexing is not supported, falling back to per frame descriptor sets\n";
+		}
 
-				++i;
-			}
+		// Pick how GPU driven draws are issued, from a GPU written draw count down to one indirect call per object
+		Graphics::IndirectDrawMode indirectDrawMode = Graphics::IndirectDrawMode::Single;
+		if (options.m_GPUDriven && deviceCapabilities.m_MultiDrawIndirect) {
+			if (deviceCapabilities.m_DrawIndirectCount)
+				indirectDrawMode = Graphics::IndirectDrawMode::Count;
+			else
+				indirectDrawMode = Graphics::IndirectDrawMode::Multi;
 		}
 
-		// Create Vulkan Device and get graphics queue
+		// Pipeline statistics span the whole frame, secondary command buffers can only be executed inside the query with 'inheritedQueries'
+		bool pipelineStatistics = deviceCapabilities.m_PipelineStatistics && (options.m_ThreadCount <= 1 || deviceCapabilities.m_InheritedQueries);
+
+		// The compute and transfer families are the graphics family if there is no dedicated one
+		std::uint32_t graphicsFamilyIndex = deviceQueueFamilies.m_Graphics;
+		std::uint32_t computeFamilyIndex  = options.m_AsyncCompute ? deviceQueueFamilies.m_Compute : graphicsFamilyIndex;
+		std::uint32_t transferFamilyIndex = deviceQueueFamilies.m_Transfer;
+
+		// Create Vulkan Device and get graphics, compute and transfer queue
 		vk::Device vulkanDevice;
 		vk::Queue vulkanGraphicsQueue;
+		vk::Queue vulkanComputeQueue;
+		vk::Queue vulkanTransferQueue;
 		{
-			std::vector<vk::DeviceQueueCreateInfo> deviceQueueCreateInfos;
-			std::vector<float> queuePriorities = { 1.0f };
-			deviceQueueCreateInfos.push_back({ {}, graphicsFamilyIndex, queuePriorities });
-
-			std::vector<const char*> enabledLayerNames;
-
-	#ifdef _DEBUG
-			enabledLayerNames.push_back("VK_LAYER_KHRONOS_validation");
-	#endif
-
-			std::vector<const char*> enabledExtensionNames = { "VK_KHR_swapchain" };
+			PROFILE_ZONE("Create device");
 
-			vk::PhysicalDeviceFeatures enabledFeatures = {};
+			// Every capability of the device is enabled, bindless textures, indirect draw counts and pipeline statistics included. Validation runs on the instance layer
+			std::vector<const char*> enabledExtensionNames = requiredDeviceExtensions;
 
-			vulkanDevice        = vulkanPhysicalDevice.createDevice({ {}, deviceQueueCreateInfos, enabledLayerNames, enabledExtensionNames, &enabledFeatures });
+			vulkanDevice        = Graphics::Device::CreateLogicalDevice(vulkanPhysicalDevice, deviceCapabilities, { graphicsFamilyIndex, computeFamilyIndex, transferFamilyIndex }, enabledExtensionNames);
 			vulkanGraphicsQueue = vulkanDevice.getQueue(graphicsFamilyIndex, 0);
+			vulkanComputeQueue  = vulkanDevice.getQueue(computeFamilyIndex, 0);
+			vulkanTransferQueue = vulkanDevice.getQueue(transferFamilyIndex, 0);
 		}
 
 		// Create a Vulkan Memory Allocator instance
 		VmaAllocator vmaAllocator;
 		{
+			PROFILE_ZONE("Create allocator");
+
 			VmaAllocatorCreateInfo createInfo = {};
-			createInfo.vulkanApiVersion       = vulkanInstanceVersion;
+			createInfo.vulkanApiVersion       = deviceCapabilities.m_APIVersion.m_Version; // VMA calls device functions of this version, the device may be older than the instance
 			createInfo.instance               = vulkanInstance;
 			createInfo.physicalDevice         = vulkanPhysicalDevice;
 			createInfo.device                 = vulkanDevice;
 
+			// Lets VMA track heap budgets from the driver instead of estimating them from its own allocations
+			if (deviceCapabilities.m_MemoryBudget)
+				createInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+
 			vmaCreateAllocator(&createInfo, &vmaAllocator);
 		}
 
+		// Create Vulkan Pipeline Cache, seeded from the previous run if the blob matches this device and driver
+		Graphics::PipelineCache pipelineCache = { vulkanDevice, vulkanPhysicalDevice, VULKAN_PIPELINE_CACHE_PATH };
+		pipelineCache.create();
+
+		// Create Shader Library, shaders come from the archive when there is one and from loose files otherwise
+		Graphics::ShaderLibrary shaderLibrary = { vulkanDevice, VULKAN_SHADER_DIRECTORY };
+		shaderLibrary.create();
+		{
+			PROFILE_ZONE("Load shaders");
+
+			if (options.m_PackShaders) {
+				std::vector<std::filesystem::path> shaderFiles;
+				for (auto& entry : std::filesystem::directory_iterator(VULKAN_SHADER_DIRECTORY))
+					if (entry.is_regular_file() && entry.path().extension() == ".spv")
+						shaderFiles.push_back(entry.path());
+
+				if (!Graphics::ShaderLibrary::WriteArchive(VULKAN_SHADER_ARCHIVE_PATH, shaderFiles))
+					std::cerr << "Failed to pack shaders into '" << VULKAN_SHADER_ARCHIVE_PATH << "'\n";
+			}
+
+			shaderLibrary.loadArchive(VULKAN_SHADER_ARCHIVE_PATH);
+		}
+
+		// Create the upload manager, uploads go through its staging ring on the transfer queue and never stall the graphics queue
+		Graphics::UploadManager uploadManager = { vulkanDevice, vmaAllocator, vulkanTransferQueue, transferFamilyIndex, graphicsFamilyIndex, VULKAN_STAGING_RING_SIZE };
+		uploadManager.create();
+
+		// Create worker threads for background work like texture decoding and pipeline compilation
+		Utils::ThreadPool workerThreadPool(Utils::ThreadPool::GetHardwareThreadCount());
+
+		// Create the pipeline compiler, pipelines compile on the worker threads and share the pipeline cache
+		Graphics::PipelineCompiler pipelineCompiler = { vulkanDevice, pipelineCache.getHandle(), shaderLibrary, workerThreadPool };
+		pipelineCompiler.create();
+
+		// Create the texture streamer, decoding and mip generation run on the worker threads
+		Graphics::TextureStreamer textureStreamer = { vulkanDevice, vmaAllocator, uploadManager, workerThreadPool, VULKAN_TEXTURE_UPLOAD_BUDGET };
+		textureStreamer.create();
+		auto textureStreamStart = std::chrono::steady_clock::now();
+		for (auto& path : options.m_TexturePaths)
+			textureStreamer.request(path);
+
 		// Create Vulkan Command Pools for graphics following formula 'F * T', F = Frames In Flight, T = Number of Threads
-		// Indexed 'F + T * NT', F = Current Frame, T = Current Thread, NT = Number of Threads
+		// Indexed 'T + F * NT', F = Current Frame, T = Current Thread, NT = Number of Threads
+		// Command pools can only be used by one thread at a time, so every recording thread gets its own pool per frame
+		std::size_t threadCount = options.m_ThreadCount;
 		std::vector<vk::CommandPool> vulkanCommandPools;
 		std::vector<std::vector<vk::CommandBuffer>> vulkanCommandBuffers;
+		std::vector<std::vector<vk::CommandBuffer>> vulkanSecondaryCommandBuffers;
 		{
-			std::size_t threadCount = 1; // Here we won't go into multithreading so we just use 1 as the thread count.
-			vulkanCommandPools.resize(VULKAN_MAX_FRAMES_IN_FLIGHT * threadCount);
-			vulkanCommandBuffers.resize(VULKAN_MAX_FRAMES_IN_FLIGHT * threadCount);
+			vulkanCommandPools.resize(options.m_FramesInFlight * threadCount);
+			vulkanCommandBuffers.resize(options.m_FramesInFlight * threadCount);
+			vulkanSecondaryCommandBuffers.resize(options.m_FramesInFlight);
 			for (std::size_t i = 0; i < vulkanCommandPools.size(); ++i) {
 				// Create a command pool
 				vulkanCommandPools[i] = vulkanDevice.createCommandPool({ {}, graphicsFamilyIndex });
 
 				// Allocate command buffers for the pool, currently that's just 1 primary buffer
 				vulkanCommandBuffers[i] = vulkanDevice.allocateCommandBuffers({ vulkanCommandPools[i], vk::CommandBufferLevel::ePrimary, 1 });
-			}
-		}
 
-		// Create synchronization objects
-		std::vector<vk::Semaphore> vulkanImageAvailableSemaphores;
-		std::vector<vk::Semaphore> vulkanRenderFinishedSemaphores;
-		std::vector<vk::Fence> vulkanInFlightFences;
-		{
-			vulkanImageAvailableSemaphores.resize(VULKAN_MAX_FRAMES_IN_FLIGHT);
-			vulkanRenderFinishedSemaphores.resize(VULKAN_MAX_FRAMES_IN_FLIGHT);
-			vulkanInFlightFences.resize(VULKAN_MAX_FRAMES_IN_FLIGHT);
-
-			// Create two semaphores and one fence for every frame in flight
-			for (std::size_t i = 0; i < VULKAN_MAX_FRAMES_IN_FLIGHT; ++i) {
-				vulkanImageAvailableSemaphores[i] = vulkanDevice.createSemaphore({ vk::SemaphoreCreateFlags {} });
-				vulkanRenderFinishedSemaphores[i] = vulkanDevice.createSemaphore({ vk::SemaphoreCreateFlags {} });
-				vulkanInFlightFences[i]           = vulkanDevice.createFence({ vk::FenceCreateFlagBits::eSignaled });
+				// With multiple recording threads every thread records its slice of the draws into 1 secondary buffer
+				if (threadCount > 1)
+					vulkanSecondaryCommandBuffers[i / threadCount].push_back(vulkanDevice.allocateCommandBuffers({ vulkanCommandPools[i], vk::CommandBufferLevel::eSecondary, 1 })[0]);
 			}
 		}
 
-		// Create Vulkan Swapchain
-		vk::Format vulkanSwapchainFormat                       = vk::Format::eUndefined;
-		vk::ColorSpaceKHR vulkanSwapchainColorSpace            = vk::ColorSpaceKHR::eSrgbNonlinear;
-		vk::PresentModeKHR vulkanSwapchainPresentMode          = vk::PresentModeKHR::eFifo;
-		vk::SurfaceCapabilitiesKHR vulkanSwapchainCapabilities = {};
-		vk::Extent2D vulkanSwapchainExtent                     = {};
-		vk::SwapchainKHR vulkanSwapchain;
-		vk::RenderPass vulkanRenderPass;
-		std::vector<vk::Image> vulkanSwapchainImages;
-		std::vector<vk::Image> vulkanSwapchainDepthImages;
-		std::vector<VmaAllocation> vulkanSwapchainDepthImageAllocations;
-		std::vector<vk::ImageView> vulkanSwapchainImageViews;
-		std::vector<vk::ImageView> vulkanSwapchainDepthImageViews;
-		std::vector<vk::Framebuffer> vulkanSwapchainFramebuffers;
-		std::vector<vk::Fence> vulkanImagesInFlight;
-		std::size_t currentImage = 0;
-		std::size_t currentFrame = 0;
-		{
-			// INFO: Most of this should be able to be moved into a separate function to support recreating the swapchain when the window resizes
+		// Create worker threads for recording, the main thread records the first slice itself
+		Utils::ThreadPool recordThreadPool(threadCount - 1, "Record");
 
-			std::uint32_t imageCount = 0;
+		// Create synchronization objects, two semaphores and one fence for every frame in flight
+		Graphics::FramePacer framePacer = { vulkanDevice, vulkanPhysicalDevice, graphicsFamilyIndex, options.m_FramesInFlight };
+		framePacer.create();
 
-			// Get Vulkan Swapchain Details
-			{
-				vulkanSwapchainCapabilities = vulkanPhysicalDevice.getSurfaceCapabilitiesKHR(vulkanSurface);
+		// Create the async compute queue, compute work is submitted to the dedicated compute family or recorded into the graphics command buffer without one
+		Graphics::AsyncCompute asyncCompute = { vulkanDevice, vulkanComputeQueue, computeFamilyIndex, graphicsFamilyIndex, options.m_FramesInFlight };
+		asyncCompute.create();
 
-				// Get swapchain extent
-				if (vulkanSwapchainCapabilities.currentExtent.width != -1) vulkanSwapchainExtent = vulkanSwapchainCapabilities.currentExtent;
+		// Create the deletion queue, resources released at runtime are destroyed once the frames that might use them have completed
+		Graphics::DeletionQueue deletionQueue = { vulkanDevice, vmaAllocator, framePacer };
 
-				std::int32_t fw, fh;
-				glfwGetFramebufferSize(windowPtr, &fw, &fh);
-				vulkanSwapchainExtent.width  = std::clamp(static_cast<std::uint32_t>(fw), vulkanSwapchainCapabilities.minImageExtent.width, vulkanSwapchainCapabilities.maxImageExtent.width);
-				vulkanSwapchainExtent.height = std::clamp(static_cast<std::uint32_t>(fh), vulkanSwapchainCapabilities.minImageExtent.height, vulkanSwapchainCapabilities.maxImageExtent.height);
+		// Create the GPU profiler, its scopes are read back once their frame slot comes around again
+		Graphics::GPUProfiler gpuProfiler = { vulkanDevice, vulkanPhysicalDevice, graphicsFamilyIndex, options.m_FramesInFlight, pipelineStatistics };
+		gpuProfiler.create();
 
-				// Get image count
-				imageCount = std::min(vulkanSwapchainCapabilities.minImageCount + 1, vulkanSwapchainCapabilities.maxImageCount);
+		// Create Vulkan Swapchain, or offscreen images to render into when running headless
+		vk::SurfaceFormatKHR vulkanSwapchainFormat    = { vk::Format::eUndefined, vk::ColorSpaceKHR::eSrgbNonlinear };
+		vk::PresentModeKHR vulkanSwapchainPresentMode = vk::PresentModeKHR::eFifo;
+		vk::RenderPass vulkanRenderPass;
+		Graphics::Swapchain swapchain = { vulkanDevice, vulkanPhysicalDevice, vmaAllocator, deletionQueue, vulkanSurface, graphicsFamilyIndex };
+		std::vector<vk::Fence> vulkanImagesInFlight;
+		Graphics::OffscreenTarget offscreenTarget = { vulkanDevice, vmaAllocator };
+		std::size_t currentImage                  = 0;
+		std::size_t currentFrame                  = 0;
+		{
+			PROFILE_ZONE("Create swapchain");
 
+			// Get Vulkan Swapchain Details
+			if (!options.m_Headless) {
 				// Get swapchain format and color space
 				auto formats = vulkanPhysicalDevice.getSurfaceFormatsKHR(vulkanSurface);
 				for (auto& format : formats) {
 					if (format.format == vk::Format::eB8G8R8Srgb && format.colorSpace == vk::ColorSpaceKHR::eSrgbNonlinear) {
-						vulkanSwapchainFormat     = format.format;
-						vulkanSwapchainColorSpace = format.colorSpace;
+						vulkanSwapchainFormat = format;
 						break;
 					}
 				}
-				vulkanSwapchainFormat     = formats[0].format;
-				vulkanSwapchainColorSpace = formats[0].colorSpace;
+				vulkanSwapchainFormat = formats[0];
 
 				// Get swapchain present mode
 				// INFO: I do not recomment using a macro for wether the app is using vsync or not.
@@ -398,8 +728,10 @@ int main(int argc, char** argv) {
 				std::vector<vk::SubpassDescription> subpasses;
 				std::vector<vk::SubpassDependency> dependencies;
 
-				// Add Color attachment
-				attachments.push_back({ {}, vulkanSwapchainFormat, vk::SampleCountFlagBits::e1, vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore, vk::AttachmentLoadOp::eDontCare, vk::AttachmentStoreOp::eDontCare, vk::ImageLayout::eUndefined, vk::ImageLayout::ePresentSrcKHR });
+				// Add Color attachment, headless mode copies it out of the offscreen image instead of presenting it
+				vk::Format colorFormat           = options.m_Headless ? VULKAN_HEADLESS_COLOR_FORMAT : vulkanSwapchainFormat.format;
+				vk::ImageLayout colorFinalLayout = options.m_Headless ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
+				attachments.push_back({ {}, colorFormat, vk::SampleCountFlagBits::e1, vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore, vk::AttachmentLoadOp::eDontCare, vk::AttachmentStoreOp::eDontCare, vk::ImageLayout::eUndefined, colorFinalLayout });
 
 				// Add Depth attachment
 				attachments.push_back({ {}, vk::Format::eD32Sfloat, vk::SampleCountFlagBits::e1, vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eDontCare, vk::AttachmentLoadOp::eDontCare, vk::AttachmentStoreOp::eDontCare, vk::ImageLayout::eUndefined, vk::ImageLayout::eDepthStencilAttachmentOptimal });
@@ -417,186 +749,138 @@ int main(int argc, char** argv) {
 				vulkanRenderPass = vulkanDevice.createRenderPass({ {}, attachments, subpasses, dependencies });
 			}
 
-			// Create Vulkan Swapchain
-			{
-				std::vector<std::uint32_t> swapchainIndices = { graphicsFamilyIndex };
-
-				vulkanSwapchain       = vulkanDevice.createSwapchainKHR({ {}, vulkanSurface, imageCount, vulkanSwapchainFormat, vulkanSwapchainColorSpace, vulkanSwapchainExtent, 1, vk::ImageUsageFlagBits::eColorAttachment, vk::SharingMode::eExclusive, swapchainIndices, vulkanSwapchainCapabilities.currentTransform, vk::CompositeAlphaFlagBitsKHR::eOpaque, vulkanSwapchainPresentMode, true, vulkanSwapchain });
-				vulkanSwapchainImages = vulkanDevice.getSwapchainImagesKHR(vulkanSwapchain);
-
-				// Create swapchain images, image views and framebuffers
-				vulkanSwapchainImageViews.resize(imageCount);
-				vulkanSwapchainDepthImages.resize(imageCount);
-				vulkanSwapchainDepthImageAllocations.resize(imageCount);
-				vulkanSwapchainDepthImageViews.resize(imageCount);
-				vulkanSwapchainFramebuffers.resize(imageCount);
-				for (std::size_t i = 0; i < imageCount; ++i) {
-					// Create Image View of current swapchain image
-					vulkanSwapchainImageViews[i] = vulkanDevice.createImageView({ {}, vulkanSwapchainImages[i], vk::ImageViewType::e2D, vulkanSwapchainFormat, {}, { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 } });
-
-					// Create depth image for current swapchain image
-					{
-						vk::ImageCreateInfo depthImageCreateInfo         = { {}, vk::ImageType::e2D, vk::Format::eD32Sfloat, { vulkanSwapchainExtent.width, vulkanSwapchainExtent.height, 1 }, 1, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eDepthStencilAttachment, vk::SharingMode::eExclusive, nullptr, vk::ImageLayout::eUndefined };
-						VkImageCreateInfo depthImageCreateInfo_          = depthImageCreateInfo;
-						VmaAllocationCreateInfo depthImageAllocationInfo = { {}, VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_ONLY, 0, 0, 0, 0, 0, 0.0f };
-						VkImage depthImage_;
-						VmaAllocation depthImageAllocation;
-						// This both creates an image and allocates memory for it
-						vulkanSwapchainDepthImages[i]           = vk::createResultValue(static_cast<vk::Result>(vmaCreateImage(vmaAllocator, &depthImageCreateInfo_, &depthImageAllocationInfo, &depthImage_, &depthImageAllocation, nullptr)), depthImage_, "vmaCreateImage");
-						vulkanSwapchainDepthImageAllocations[i] = depthImageAllocation;
-					}
-
-					// Create image view for current depth image
-					vulkanSwapchainDepthImageViews[i] = vulkanDevice.createImageView({ {}, vulkanSwapchainDepthImages[i], vk::ImageViewType::e2D, vk::Format::eD32Sfloat, {}, { vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1 } });
-
-					// Create framebuffer for current swapchain image
-					std::vector<vk::ImageView> framebufferAttachments = { vulkanSwapchainImageViews[i], vulkanSwapchainDepthImageViews[i] };
+			// Create Vulkan Swapchain, the render pass clears depth from an undefined layout so its depth images need no transition before the first frame
+			if (!options.m_Headless) {
+				std::int32_t fw, fh;
+				glfwGetFramebufferSize(windowPtr, &fw, &fh);
+				swapchain.create(vulkanSwapchainFormat, vulkanSwapchainPresentMode, vk::Format::eD32Sfloat, vulkanRenderPass, { static_cast<std::uint32_t>(fw), static_cast<std::uint32_t>(fh) });
 
-					vulkanSwapchainFramebuffers[i] = vulkanDevice.createFramebuffer({ {}, vulkanRenderPass, framebufferAttachments, vulkanSwapchainExtent.width, vulkanSwapchainExtent.height, 1 });
-				}
+				// Create fences for images currently in flight
+				vulkanImagesInFlight.assign(swapchain.getImageCount(), nullptr);
+			} else {
+				// Create one offscreen color and depth image per frame in flight, so frames can still overlap
+				offscreenTarget.create({ options.m_Width, options.m_Height }, VULKAN_HEADLESS_COLOR_FORMAT, vk::Format::eD32Sfloat, vulkanRenderPass, options.m_FramesInFlight);
 			}
+		}
 
-			// Create fences for images currently in flight
-			vulkanImagesInFlight.resize(imageCount);
-			for (std::size_t i = 0; i < imageCount; ++i) vulkanImagesInFlight[i] = nullptr;
-
-			// Change image layout of depth images to their optimal layout, tbh I don't really know what this does...
-			{
-				vk::CommandPool currentCommandPool = vulkanCommandPools[currentFrame];
-				// Reset current command pool before we use it
-				vulkanDevice.resetCommandPool(currentCommandPool);
-				vk::CommandBuffer currentCommandBuffer = vulkanCommandBuffers[currentFrame][0];
-
-				vk::CommandBufferBeginInfo beginInfo = {};
-				currentCommandBuffer.begin(beginInfo);
-
-				std::vector<vk::ImageMemoryBarrier> imageMemoryBarriers;
-				imageMemoryBarriers.resize(imageCount);
-				for (std::size_t i = 0; i < imageCount; ++i)
-					imageMemoryBarriers[i] = { {}, vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite, vk::ImageLayout::eUndefined, vk::ImageLayout::eDepthStencilAttachmentOptimal, ~0U, ~0U, vulkanSwapchainDepthImages[i], { vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1 } };
-
-				currentCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eEarlyFragmentTests, {}, {}, {}, imageMemoryBarriers);
+		// Extent of the images every frame renders to, follows the swapchain when it is recreated
+		vk::Extent2D renderExtent = options.m_Headless ? offscreenTarget.getExtent() : swapchain.getExtent();
 
-				currentCommandBuffer.end();
+		// ------------------
+		// -- Dynamic data --
 
-				// Submit current command buffer and wait until it finishes
-				std::vector<vk::CommandBuffer> submitCommandBuffers = { currentCommandBuffer };
-				vulkanGraphicsQueue.submit({ { {}, {}, submitCommandBuffers, {} } });
-				vulkanGraphicsQueue.waitIdle();
+		// Create the bindless texture table, its set is bound once per command buffer and draws pick textures with a push constant
+		Graphics::BindlessTable bindlessTable = { vulkanDevice, vulkanPhysicalDevice, VULKAN_BINDLESS_IMAGE_CAPACITY, VULKAN_BINDLESS_SAMPLER_CAPACITY, vk::ShaderStageFlagBits::eFragment };
+		if (bindless)
+			bindlessTable.create();
+
+		// Create the GPU culler, its set holds the objects the indirect vertex shader reads its model matrix from
+		Graphics::GPUCuller gpuCuller = { vulkanDevice, vmaAllocator, uploadManager, shaderLibrary, pipelineCache.getHandle(), options.m_FramesInFlight, indirectDrawMode, vulkanPhysicalDevice.getProperties().limits.maxDrawIndirectCount };
+		if (options.m_GPUDriven)
+			gpuCuller.create();
+
+		// Open the cooked mesh before requesting the pipeline, its vertex layout decides the vertex input. The built-in quads use the standard layout
+		Utils::MeshFile meshFile;
+		if (!options.m_MeshPath.empty()) {
+			if (!meshFile.open(options.m_MeshPath))
+				std::cerr << "Failed to load mesh '" << options.m_MeshPath << "', drawing the built-in quads instead\n";
+			else if (!meshFile.getVertexLayout().hasAttribute(Utils::VertexSemantic::UV)) {
+				std::cerr << "Mesh '" << options.m_MeshPath << "' has a vertex layout the pipeline can't read, drawing the built-in quads instead\n";
+				meshFile.close();
 			}
 		}
-
-		// ------------------
-		// -- Dynamic data --
+		Utils::VertexLayout vertexLayout             = meshFile.isOpen() ? meshFile.getVertexLayout() : Utils::VertexLayout::Standard();
+		Utils::VertexQuantization vertexQuantization = meshFile.isOpen() ? meshFile.getHeader().m_Quantization : Utils::VertexQuantization {};
 
 		// Create Graphics Pipeline
 		vk::DescriptorSetLayout descriptorSetLayout;
 		vk::PipelineLayout graphicsPipelineLayout;
-		vk::Pipeline graphicsPipeline;
+		Graphics::PipelineCompiler::Handle graphicsPipeline;
 		vk::DescriptorPool descriptorPool;
 		{
-			// Create shader modules
-			vk::ShaderModule vertexShaderModule;
-			vk::ShaderModule fragmentShaderModule;
-			{
-				// Load vertex shader
-				std::string vertexFileContent;
-				{
-					std::ifstream vertexFile = std::ifstream("shaders/vert.spv", std::ios::binary | std::ios::ate);
-					if (vertexFile.is_open()) {
-						auto size = vertexFile.tellg();
-						vertexFileContent.resize(static_cast<std::size_t>(size));
-						vertexFile.seekg(0);
-						vertexFile.read(vertexFileContent.data(), size);
-						vertexFile.close();
-					}
-				}
-				vertexShaderModule = vulkanDevice.createShaderModule({ {}, vertexFileContent.size(), reinterpret_cast<std::uint32_t*>(vertexFileContent.data()) });
-
-				// Load fragment shader
-				std::string fragmentFileContent;
-				{
-					std::ifstream fragmentFile = std::ifstream("shaders/frag.spv", std::ios::binary | std::ios::ate);
-					if (fragmentFile.is_open()) {
-						auto size = fragmentFile.tellg();
-						fragmentFileContent.resize(static_cast<std::size_t>(size));
-						fragmentFile.seekg(0);
-						fragmentFile.read(fragmentFileContent.data(), size);
-						fragmentFile.close();
-					}
-				}
-				fragmentShaderModule = vulkanDevice.createShaderModule({ {}, fragmentFileContent.size(), reinterpret_cast<std::uint32_t*>(fragmentFileContent.data()) });
-			}
+			PROFILE_ZONE("Create pipelines");
 
 			// Create descriptor set layout
 			{
 				std::vector<vk::DescriptorSetLayoutBinding> bindings = {
-					{ 0, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eVertex, nullptr },
+					{ 0, vk::DescriptorType::eUniformBufferDynamic, 1, vk::ShaderStageFlagBits::eVertex, nullptr },
 					{ 1, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment, nullptr }
 				};
 
 				descriptorSetLayout = vulkanDevice.createDescriptorSetLayout({ {}, bindings });
 			}
 
-			// Create graphics pipeline layout
-			graphicsPipelineLayout = vulkanDevice.createPipelineLayout({ {}, descriptorSetLayout, {} });
-
-			// Create graphics pipeline
+			// Create graphics pipeline layout, the bindless table or the GPU culled objects go into set 1
 			{
-				std::vector<vk::PipelineShaderStageCreateInfo> stages;
-				stages.push_back({ {}, vk::ShaderStageFlagBits::eVertex, vertexShaderModule, "main", nullptr });
-				stages.push_back({ {}, vk::ShaderStageFlagBits::eFragment, fragmentShaderModule, "main", nullptr });
-
-				std::vector<vk::VertexInputBindingDescription> vertexBindings     = { { 0, 24, vk::VertexInputRate::eVertex } };
-				std::vector<vk::VertexInputAttributeDescription> vertexAttributes = { { 0, 0, vk::Format::eR32G32B32A32Sfloat, 0 }, { 1, 0, vk::Format::eR32G32Sfloat, 16 } };
-
-				std::vector<vk::Viewport> viewports = { { 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f } };
-				std::vector<vk::Rect2D> scissors    = { { { 0, 0 }, { 1, 1 } } };
-
-				std::vector<vk::PipelineColorBlendAttachmentState> blendAttachments = { { false, vk::BlendFactor::eOne, vk::BlendFactor::eZero, vk::BlendOp::eAdd, vk::BlendFactor::eOne, vk::BlendFactor::eZero, vk::BlendOp::eAdd, vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA } };
-
-				std::vector<vk::DynamicState> dynamicStates = { vk::DynamicState::eViewport, vk::DynamicState::eScissor, vk::DynamicState::eLineWidth };
+				std::vector<vk::DescriptorSetLayout> setLayouts = { descriptorSetLayout };
+				std::vector<vk::PushConstantRange> pushConstantRanges;
+				if (options.m_GPUDriven) {
+					setLayouts.push_back(gpuCuller.getLayout());
+				} else if (bindless) {
+					setLayouts.push_back(bindlessTable.getLayout());
+					pushConstantRanges.push_back({ vk::ShaderStageFlagBits::eFragment, 0, sizeof(Graphics::DrawConstants) });
+				}
 
-				vk::PipelineVertexInputStateCreateInfo vertexInputState     = { {}, vertexBindings, vertexAttributes };
-				vk::PipelineInputAssemblyStateCreateInfo inputAssemblyState = { {}, vk::PrimitiveTopology::eTriangleList, false };
-				vk::PipelineViewportStateCreateInfo viewportState           = { {}, viewports, scissors };
-				vk::PipelineRasterizationStateCreateInfo rasterizationState = { {}, false, false, vk::PolygonMode::eFill, vk::CullModeFlagBits::eBack, vk::FrontFace::eClockwise, false, 0.0f, 0.0f, 0.0f, 1.0f };
-				vk::PipelineMultisampleStateCreateInfo multisampleState     = { {}, vk::SampleCountFlagBits::e1, false, 1.0f, nullptr, false, false };
-				vk::PipelineDepthStencilStateCreateInfo depthStencilState   = { {}, true, true, vk::CompareOp::eLess, false, false, { vk::StencilOp::eKeep, vk::StencilOp::eReplace, vk::StencilOp::eKeep, vk::CompareOp::eLess, ~0U, ~0U, ~0U }, { vk::StencilOp::eKeep, vk::StencilOp::eReplace, vk::StencilOp::eKeep, vk::CompareOp::eLess, ~0U, ~0U, ~0U }, 0.0f, 1.0f };
-				vk::PipelineColorBlendStateCreateInfo colorBlendState       = { {}, false, vk::LogicOp::eCopy, blendAttachments, {} };
-				vk::PipelineDynamicStateCreateInfo dynamicState             = { {}, dynamicStates };
+				graphicsPipelineLayout = vulkanDevice.createPipelineLayout({ {}, setLayouts, pushConstantRanges });
+			}
 
-				graphicsPipeline = vulkanDevice.createGraphicsPipeline(nullptr, { {}, stages, &vertexInputState, &inputAssemblyState, nullptr, &viewportState, &rasterizationState, &multisampleState, &depthStencilState, &colorBlendState, &dynamicState, graphicsPipelineLayout, vulkanRenderPass, 0, nullptr, 0 }).value; // .value is apparently required here, as it gives an error with multiple cast functions available.
+			// Request graphics pipeline, it compiles in the background and draws are skipped until it's ready
+			{
+				Graphics::GraphicsPipelineDesc desc;
+				desc.m_VertexShader   = options.m_GPUDriven ? "indirect.vert.spv" : "shader.vert.spv";
+				desc.m_FragmentShader = bindless ? "bindless.frag.spv" : "shader.frag.spv";
+				desc.m_Layout         = graphicsPipelineLayout;
+				desc.m_RenderPass     = vulkanRenderPass;
+				desc.m_FrontFace      = vk::FrontFace::eCounterClockwise; // The camera's projection flips y, so counter clockwise model space triangles stay counter clockwise
+				Graphics::VertexInput::Apply(desc, vertexLayout, 0, { Utils::VertexSemantic::Position, Utils::VertexSemantic::UV });
+
+				graphicsPipeline = pipelineCompiler.request(desc);
 			}
 
 			// Create descriptor pool
 			{
-				std::vector<vk::DescriptorPoolSize> poolSizes = { { vk::DescriptorType::eUniformBuffer, VULKAN_MAX_FRAMES_IN_FLIGHT }, { vk::DescriptorType::eCombinedImageSampler, VULKAN_MAX_FRAMES_IN_FLIGHT } };
+				std::vector<vk::DescriptorPoolSize> poolSizes = { { vk::DescriptorType::eUniformBufferDynamic, options.m_FramesInFlight }, { vk::DescriptorType::eCombinedImageSampler, options.m_FramesInFlight } };
 
-				descriptorPool = vulkanDevice.createDescriptorPool({ {}, VULKAN_MAX_FRAMES_IN_FLIGHT, poolSizes });
+				descriptorPool = vulkanDevice.createDescriptorPool({ {}, options.m_FramesInFlight, poolSizes });
 			}
+		}
+
+		// Create the ImGui overlay, its font atlas goes out with the first upload flush
+		Graphics::ImGuiRenderer imguiRenderer = { vulkanDevice, vmaAllocator, uploadManager, pipelineCompiler, options.m_FramesInFlight };
+		if (options.m_Overlay) {
+			ImGui::CreateContext();
+			ImGui::GetIO().IniFilename = nullptr;
+			imguiRenderer.create(vulkanRenderPass);
+		}
 
-			// Destroy shader modules
-			vulkanDevice.destroyShaderModule(vertexShaderModule);
-			vulkanDevice.destroyShaderModule(fragmentShaderModule);
+		// Create the particle system, it's simulated with the async compute queue and drawn on top of the scene
+		Graphics::ParticleSystem particleSystem = { vulkanDevice, vmaAllocator, shaderLibrary, pipelineCache.getHandle(), pipelineCompiler, asyncCompute, options.m_ParticleCount };
+		if (options.m_ParticleCount > 0) {
+			particleSystem.create(vulkanRenderPass);
+			std::cout << "Simulating " << particleSystem.getParticleCount() << " particles on the " << (asyncCompute.isAsync() ? "dedicated compute" : "graphics") << " queue\n";
 		}
 
-		// Create Mesh Buffer and image
-		vk::Buffer meshBuffer;
-		VmaAllocation meshBufferAllocation;
+		// Create the geometry arenas, every mesh is a range of vertices and indices in a few shared buffers instead of a buffer of its own
+		Graphics::GeometryArena vertexArena = { vulkanDevice, vmaAllocator, deletionQueue, vk::BufferUsageFlagBits::eVertexBuffer, vertexLayout.getStride(), VULKAN_GEOMETRY_PAGE_VERTEX_COUNT };
+		Graphics::GeometryArena indexArena  = { vulkanDevice, vmaAllocator, deletionQueue, vk::BufferUsageFlagBits::eIndexBuffer, sizeof(std::uint32_t), VULKAN_GEOMETRY_PAGE_INDEX_COUNT };
+		vertexArena.create();
+		indexArena.create();
+
+		// Create mesh and image
+		Graphics::GeometryAllocation meshVertices = Graphics::InvalidGeometryAllocation;
+		Graphics::GeometryAllocation meshIndices  = Graphics::InvalidGeometryAllocation;
+		std::uint64_t meshUploadBatch             = 0;
 		vk::Image image;
 		VmaAllocation imageAllocation;
 		vk::ImageView imageView;
 		vk::Sampler imageSampler;
+		float meshBoundingRadius     = 0.0f;
+		std::uint32_t meshIndexCount = 0;
+		std::vector<Utils::MeshFileSubmesh> meshLODs; // Index ranges relative to the first index of the mesh, full detail first
 		{
-			// Create mesh buffer
-			std::size_t meshBufferSize           = 240;
-			vk::BufferCreateInfo createInfo      = { {}, meshBufferSize, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eVertexBuffer, vk::SharingMode::eExclusive, {} };
-			VkBufferCreateInfo createInfo_       = createInfo;
-			VmaAllocationCreateInfo allocateInfo = { {}, VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_ONLY, 0, 0, 0, 0, 0, 0.0f };
+			PROFILE_ZONE("Create mesh and image");
 
-			VkBuffer buffer;
-			meshBuffer = vk::createResultValue(static_cast<vk::Result>(vmaCreateBuffer(vmaAllocator, &createInfo_, &allocateInfo, &buffer, &meshBufferAllocation, nullptr)), buffer, "vmaCreateBuffer");
+			VmaAllocationCreateInfo allocateInfo = { {}, VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_ONLY, 0, 0, 0, 0, 0, 0.0f };
 
 			// Create image
 			vk::ImageCreateInfo imageCreateInfo = { {}, vk::ImageType::e2D, vk::Format::eR8G8B8A8Srgb, { 2, 2, 1 }, 1, 1, vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled, vk::SharingMode::eExclusive, {}, vk::ImageLayout::eUndefined };
@@ -608,86 +892,84 @@ int main(int argc, char** argv) {
 			imageView = vulkanDevice.createImageView({ {}, image, vk::ImageViewType::e2D, imageCreateInfo.format, {}, { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 } });
 
 			// Create image sampler
-			imageSampler = vulkanDevice.createSampler({ {}, vk::Filter::eLinear, vk::Filter::eLinear, vk::SamplerMipmapMode::eLinear, vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eRepeat, 0.0f, false, 0.0f, false, vk::CompareOp::eAlways, 0.0f, 1.0f, vk::BorderColor::eIntOpaqueBlack, false });
+			imageSampler = vulkanDevice.createSampler({ {}, vk::Filter::eLinear, vk::Filter::eLinear, vk::SamplerMipmapMode::eLinear, vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eRepeat, 0.0f, false, 0.0f, false, vk::CompareOp::eAlways, 0.0f, VK_LOD_CLAMP_NONE, vk::BorderColor::eIntOpaqueBlack, false });
 
-			// Create staging buffer
-			createInfo   = { {}, meshBufferSize + (2 * 2 * 4), vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive, {} };
-			createInfo_  = createInfo;
-			allocateInfo = { {}, VmaMemoryUsage::VMA_MEMORY_USAGE_CPU_ONLY, 0, 0, 0, 0, 0, 0.0f };
-
-			VkBuffer stagingBuffer;
-			VmaAllocation stagingBufferAllocation;
-			vk::Result result = static_cast<vk::Result>(vmaCreateBuffer(vmaAllocator, &createInfo_, &allocateInfo, &stagingBuffer, &stagingBufferAllocation, nullptr));
-			if (result != vk::Result::eSuccess)
-				vk::throwResultException(result, "vmaCreateBuffer");
-
-			// Map staging buffer and copy mesh data into it.
-			void* pData;
-			vmaMapMemory(vmaAllocator, stagingBufferAllocation, &pData);
+			// Queue the mesh and texture uploads, the first frame waits for them on the GPU instead of the CPU waiting here
 			float vertices[]        = { -0.5f, -0.5f, 0.5f, 1.0f, 1.0f, 1.0f, 0.5f, -0.5f, 0.5f, 1.0f, 0.0f, 1.0f, 0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 0.0f, -0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 0.0f, -0.3f, -0.3f, 0.0f, 1.0f, 1.0f, 1.0f, 0.3f, -0.3f, 0.0f, 1.0f, 0.0f, 1.0f, 0.3f, 0.3f, 0.0f, 1.0f, 0.0f, 0.0f, -0.3f, 0.3f, 0.0f, 1.0f, 1.0f, 0.0f };
 			std::uint32_t indices[] = { 0, 1, 2, 2, 3, 0, 4, 5, 6, 6, 7, 4 };
 			std::uint8_t pixels[]   = { 0xFF, 0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0xFF };
-			std::uintptr_t dataPtr  = reinterpret_cast<std::uintptr_t>(pData);
-			std::memcpy(reinterpret_cast<void*>(dataPtr), vertices, sizeof(vertices));
-			std::memcpy(reinterpret_cast<void*>(dataPtr + sizeof(vertices)), indices, sizeof(indices));
-			std::memcpy(reinterpret_cast<void*>(dataPtr + sizeof(vertices) + sizeof(indices)), pixels, sizeof(pixels));
-			vmaUnmapMemory(vmaAllocator, stagingBufferAllocation);
-
-			// Copy data from staging buffer into mesh buffer
-			vk::CommandPool currentCommandPool = vulkanCommandPools[currentFrame];
-			vulkanDevice.resetCommandPool(currentCommandPool);
-			vk::CommandBuffer currentCommandBuffer = vulkanCommandBuffers[currentFrame][0];
 
-			vk::CommandBufferBeginInfo beginInfo = {};
-			currentCommandBuffer.begin(beginInfo);
-			currentCommandBuffer.copyBuffer(stagingBuffer, meshBuffer, { { 0, 0, meshBufferSize } });
-
-			vk::ImageMemoryBarrier imageMemoryBarrier = { {}, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, ~0U, ~0U, image, { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 } };
-			currentCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, imageMemoryBarrier);
-
-			std::vector<vk::BufferImageCopy> bufferImageCopies = { { meshBufferSize, 0, 0, { vk::ImageAspectFlagBits::eColor, 0, 0, 1 }, { 0, 0, 0 }, imageCreateInfo.extent } };
-			currentCommandBuffer.copyBufferToImage(stagingBuffer, image, vk::ImageLayout::eTransferDstOptimal, bufferImageCopies);
-
-			imageMemoryBarrier = { vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, ~0U, ~0U, image, { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 } };
-			currentCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, nullptr, nullptr, imageMemoryBarrier);
-
-			currentCommandBuffer.end();
-			vulkanGraphicsQueue.submit({ { {}, {}, currentCommandBuffer, {} } });
-			vulkanGraphicsQueue.waitIdle();
-
-			// Destroy staging buffer
-			vmaDestroyBuffer(vmaAllocator, stagingBuffer, stagingBufferAllocation);
+			// A cooked mesh is stored exactly as the vertex input reads it, so its mapped sections go to the staging ring as they are
+			const void* vertexData     = vertices;
+			std::size_t vertexDataSize = sizeof(vertices);
+			const void* indexData      = indices;
+			std::size_t indexDataSize  = sizeof(indices);
+			if (meshFile.isOpen()) {
+				auto& header   = meshFile.getHeader();
+				vertexData     = meshFile.getVertexData();
+				vertexDataSize = meshFile.getVertexDataSize();
+				indexData      = meshFile.getIndexData();
+				indexDataSize  = meshFile.getIndexDataSize();
+
+				// The culler's spheres are centered on the origin of the model, so the sphere of the mesh is grown to contain the origin
+				auto sphere        = header.m_BoundingSphere;
+				meshBoundingRadius = std::sqrt(sphere[0] * sphere[0] + sphere[1] * sphere[1] + sphere[2] * sphere[2]) + sphere[3];
+
+				// Every level of detail is uploaded along with full detail, they share the vertices and only differ in their index ranges
+				for (std::uint32_t lod = 0; lod < meshFile.getLODCount(); ++lod)
+					meshLODs.push_back(meshFile.getLOD(lod));
+			} else {
+				for (std::size_t i = 0; i < std::size(vertices); i += 6)
+					meshBoundingRadius = std::max(meshBoundingRadius, std::sqrt(vertices[i] * vertices[i] + vertices[i + 1] * vertices[i + 1] + vertices[i + 2] * vertices[i + 2]));
+				meshLODs.push_back({ 0, static_cast<std::uint32_t>(std::size(indices)), 0.0f });
+			}
+			meshIndexCount = meshLODs[0].m_IndexCount;
+
+			meshVertices     = vertexArena.allocate(static_cast<std::uint32_t>(vertexDataSize / vertexLayout.getStride()));
+			meshIndices      = indexArena.allocate(static_cast<std::uint32_t>(indexDataSize / sizeof(std::uint32_t)));
+			auto vertexRange = vertexArena.getRange(meshVertices);
+			auto indexRange  = indexArena.getRange(meshIndices);
+			uploadManager.uploadBuffer(vertexArena.getBuffer(vertexRange.m_Page), vertexArena.getByteOffset(vertexRange), vertexData, vertexDataSize, vk::PipelineStageFlagBits::eVertexInput, vk::AccessFlagBits::eVertexAttributeRead);
+			uploadManager.uploadBuffer(indexArena.getBuffer(indexRange.m_Page), indexArena.getByteOffset(indexRange), indexData, indexDataSize, vk::PipelineStageFlagBits::eVertexInput, vk::AccessFlagBits::eIndexRead);
+			uploadManager.uploadImage(image, { vk::ImageAspectFlagBits::eColor, 0, 0, 1 }, imageCreateInfo.extent, pixels, sizeof(pixels), vk::ImageLayout::eShaderReadOnlyOptimal, vk::PipelineStageFlagBits::eFragmentShader, vk::AccessFlagBits::eShaderRead);
+			meshUploadBatch = uploadManager.flush();
+			meshFile.close();
 		}
 
-		// Create Uniform Buffer
-		vk::Buffer uniformBuffer;
-		VmaAllocation uniformBufferAllocation;
-		{
-			vk::BufferCreateInfo createInfo      = { {}, 128 * VULKAN_MAX_FRAMES_IN_FLIGHT, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eUniformBuffer, vk::SharingMode::eExclusive, {} };
-			VkBufferCreateInfo createInfo_       = createInfo;
-			VmaAllocationCreateInfo allocateInfo = { {}, VmaMemoryUsage::VMA_MEMORY_USAGE_CPU_TO_GPU, 0, 0, 0, 0, 0, 0.0f };
-
-			VkBuffer buffer;
-			uniformBuffer = vk::createResultValue(static_cast<vk::Result>(vmaCreateBuffer(vmaAllocator, &createInfo_, &allocateInfo, &buffer, &uniformBufferAllocation, nullptr)), buffer, "vmaCreateBuffer");
+		// Register the placeholder texture and sampler in the bindless table, streamed textures are added once they're resident
+		std::uint32_t placeholderTextureIndex = 0;
+		std::uint32_t samplerIndex            = 0;
+		std::vector<std::uint32_t> textureIndices;
+		std::size_t registeredTextureCount = 0;
+		if (bindless) {
+			placeholderTextureIndex = bindlessTable.addImage(imageView);
+			samplerIndex            = bindlessTable.addSampler(imageSampler);
+			textureIndices.resize(textureStreamer.getTextureCount(), placeholderTextureIndex);
 		}
 
-		// Create descriptor sets and write to them
+		// Create Uniform Ring, every instanced draw gets its constants from the region of the current frame, 256 is the largest offset alignment a device may require.
+		// The frame region is large enough for the worst case of no draws being merged
+		Graphics::UniformRing uniformRing = { vulkanPhysicalDevice, vmaAllocator, std::max<vk::DeviceSize>(VULKAN_UNIFORM_RING_FRAME_SIZE, options.m_DrawCount * ((2 * sizeof(Utils::Mat4) + 255) / 256 * 256)), options.m_FramesInFlight, sizeof(Graphics::InstanceConstants) };
+		uniformRing.create();
+
+		// Create descriptor sets and write to them, the uniform buffer is dynamic so one set per frame serves every draw.
+		// A set per frame lets the texture be swapped in once the frame that last used the set has finished
 		std::vector<vk::DescriptorSet> descriptorSets;
+		std::vector<vk::ImageView> descriptorImageViews(options.m_FramesInFlight, imageView);
 		{
-			std::vector<vk::DescriptorSetLayout> descriptorSetLayouts(VULKAN_MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
+			PROFILE_ZONE("Create descriptor sets");
+
+			std::vector<vk::DescriptorSetLayout> descriptorSetLayouts(options.m_FramesInFlight, descriptorSetLayout);
 			descriptorSets = vulkanDevice.allocateDescriptorSets({ descriptorPool, descriptorSetLayouts });
 
+			vk::DescriptorBufferInfo bufferInfo = { uniformRing.getBuffer(), 0, sizeof(Graphics::InstanceConstants) };
+			vk::DescriptorImageInfo imageInfo   = { imageSampler, imageView, vk::ImageLayout::eShaderReadOnlyOptimal };
+
 			std::vector<vk::WriteDescriptorSet> writeDescriptorSets;
-			vk::DescriptorImageInfo imageInfo = { imageSampler, imageView, vk::ImageLayout::eShaderReadOnlyOptimal };
-			std::vector<vk::DescriptorBufferInfo> bufferInfos;
-			writeDescriptorSets.resize(VULKAN_MAX_FRAMES_IN_FLIGHT * 2);
-			bufferInfos.resize(VULKAN_MAX_FRAMES_IN_FLIGHT);
-			for (size_t i = 0; i < VULKAN_MAX_FRAMES_IN_FLIGHT; ++i) {
-				bufferInfos[i]         = vk::DescriptorBufferInfo { uniformBuffer, 128 * i, 128 };
-				writeDescriptorSets[i] = { descriptorSets[i], 0, 0, 1, vk::DescriptorType::eUniformBuffer, nullptr, &bufferInfos[i], nullptr };
+			for (auto& descriptorSet : descriptorSets) {
+				writeDescriptorSets.push_back({ descriptorSet, 0, 0, 1, vk::DescriptorType::eUniformBufferDynamic, nullptr, &bufferInfo, nullptr });
+				writeDescriptorSets.push_back({ descriptorSet, 1, 0, 1, vk::DescriptorType::eCombinedImageSampler, &imageInfo, nullptr, nullptr });
 			}
-			for (size_t i = VULKAN_MAX_FRAMES_IN_FLIGHT; i < VULKAN_MAX_FRAMES_IN_FLIGHT * 2; ++i)
-				writeDescriptorSets[i] = { descriptorSets[i - VULKAN_MAX_FRAMES_IN_FLIGHT], 1, 0, vk::DescriptorType::eCombinedImageSampler, imageInfo, {}, {} };
 
 			vulkanDevice.updateDescriptorSets(writeDescriptorSets, {});
 		}
@@ -695,92 +977,567 @@ int main(int argc, char** argv) {
 		// -- Dynamic Data --
 		// ------------------
 
-		// Poll for all window events and wait until window should be closed (Pressed X button)
-		while (!glfwWindowShouldClose(windowPtr)) {
-			glfwPollEvents();
+		// Build the draw list, every draw renders the whole mesh. The offsets are fetched again whenever defragmenting moves the mesh.
+		// The draws are laid out in a square grid on the ground, so they spread over distance from the camera
+		std::vector<DrawCommand> drawList(options.m_DrawCount, { meshIndexCount, 0, 0, Utils::Mat4::Identity() });
+		auto gridSize     = static_cast<std::uint32_t>(std::ceil(std::sqrt(static_cast<float>(drawList.size()))));
+		float gridSpacing = 3.0f * meshBoundingRadius;
+		for (std::size_t i = 0; i < drawList.size(); ++i) {
+			float scale[]       = { 1.0f, 1.0f, 1.0f };
+			float translation[] = { (static_cast<float>(i % gridSize) - 0.5f * static_cast<float>(gridSize - 1)) * gridSpacing, 0.0f, -static_cast<float>(i / gridSize) * gridSpacing };
+			drawList[i].m_Model = Utils::Mat4::ScaleTranslation(scale, translation);
+		}
+		auto updateMeshRanges = [&]() {
+			auto vertexRange = vertexArena.getRange(meshVertices);
+			auto indexRange  = indexArena.getRange(meshIndices);
+			for (auto& draw : drawList) {
+				draw.m_FirstIndex   = indexRange.m_First;
+				draw.m_VertexOffset = static_cast<std::int32_t>(vertexRange.m_First);
+			}
+		};
+		updateMeshRanges();
+		for (std::size_t i = 0; i < drawList.size() && textureStreamer.getTextureCount() > 0; ++i)
+			drawList[i].m_Texture = static_cast<std::uint32_t>(i % textureStreamer.getTextureCount());
+
+		// Updated at the start of every frame, before the levels of detail are picked
+		Utils::Mat4 projView = Utils::Mat4::Identity();
+
+		// Maps quantized positions back to model space ahead of the model matrix of every draw, so the shaders never see them
+		Utils::Mat4 meshDequantize = vertexQuantization.getMatrix();
+
+		// Hand the draw list to the GPU culler once, from then on the CPU doesn't touch individual draws
+		if (options.m_GPUDriven) {
+			// The culler transforms the sphere with the same matrix as the vertices, so it's moved into the space of the quantized positions
+			auto& scale    = vertexQuantization.m_Scale;
+			auto& offset   = vertexQuantization.m_Offset;
+			float sphere[] = { -offset[0] / scale[0], -offset[1] / scale[1], -offset[2] / scale[2], meshBoundingRadius / std::max({ scale[0], scale[1], scale[2] }) };
+
+			// Every draw shares the levels of detail of the mesh, the culling shader picks one per object every frame.
+			// Their errors are moved into the same space as the sphere
+			std::vector<Graphics::CullLOD> cullLODs;
+			for (auto& lod : meshLODs)
+				cullLODs.push_back({ indexArena.getRange(meshIndices).m_First + lod.m_FirstIndex, lod.m_IndexCount, lod.m_Error / std::max({ scale[0], scale[1], scale[2] }), 0 });
+
+			std::vector<Graphics::CullObject> cullObjects;
+			cullObjects.reserve(drawList.size());
+			for (auto& draw : drawList)
+				cullObjects.push_back({ draw.m_Model * meshDequantize, { sphere[0], sphere[1], sphere[2], sphere[3] }, 0, static_cast<std::uint32_t>(cullLODs.size()), draw.m_VertexOffset, 0 });
+			gpuCuller.setObjects(cullObjects, cullLODs);
+			uploadManager.flush();
+		}
+
+		// Records the draws in [begin, end) of the render queue, every recording thread calls this for its own slice
+		vk::Pipeline currentPipeline;
+		Graphics::RenderQueue renderQueue;
+		auto recordDraws = [&](vk::CommandBuffer commandBuffer, std::size_t begin, std::size_t end) {
+			// Draws whose pipeline is still compiling are skipped instead of stalling the frame
+			if (!currentPipeline)
+				return;
+
+			commandBuffer.setViewport(0, { { 0.0f, 0.0f, static_cast<float>(renderExtent.width), static_cast<float>(renderExtent.height), 0.0f, 1.0f } });
+			commandBuffer.setScissor(0, { { { 0, 0 }, renderExtent } });
+			commandBuffer.setLineWidth(1.0f);
+
+			// GPU driven draws all share one set of frame constants, the models come from the object buffer
+			if (options.m_GPUDriven) {
+				commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, currentPipeline);
+				commandBuffer.bindVertexBuffers(0, vertexArena.getBuffer(vertexArena.getRange(meshVertices).m_Page), 0ULL);
+				commandBuffer.bindIndexBuffer(indexArena.getBuffer(indexArena.getRange(meshIndices).m_Page), 0, vk::IndexType::eUint32);
+
+				std::uint32_t constantsOffset = uniformRing.push(projView);
+				commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, graphicsPipelineLayout, 0, { descriptorSets[currentFrame], gpuCuller.getDescriptorSet(static_cast<std::uint32_t>(currentFrame)) }, constantsOffset);
+				gpuCuller.draw(commandBuffer, static_cast<std::uint32_t>(currentFrame));
+				return;
+			}
+
+			// The render queue binds pipelines, buffers and instance constants itself, skipping whatever the previous draw already bound
+			if (bindless)
+				commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, graphicsPipelineLayout, 1, bindlessTable.getDescriptorSet(), {});
+			renderQueue.record(commandBuffer, begin, end, uniformRing, projView);
+		};
+
+		// Poll for all window events and wait until window should be closed (Pressed X button), or until all frames are rendered in headless mode
+		bool firstFramePresented                  = false;
+		bool texturesStreamed                     = false;
+		Graphics::FrameTimings accumulatedTimings = {};
+		std::uint32_t accumulatedFrames           = 0;
+		auto lastTimingsReport                    = std::chrono::steady_clock::now();
+		bool defragmentGeometry                   = false;
+		double accumulatedRecordTime              = 0.0;
+		double totalRecordTime                    = 0.0;
+		Graphics::FrameTimings totalTimings       = {};
+		std::uint32_t renderedFrames              = 0;
+		std::uint32_t lastRenderedFrame           = 0;
+		auto renderStart                          = std::chrono::steady_clock::now();
+		auto lastOverlayTime                      = renderStart;
+		auto lastSimulationTime                   = renderStart;
+		bool swapchainOutOfDate                   = !options.m_Headless && !swapchain.isCreated(); // Also set when the window started minimized
+		vk::Extent2D framebufferExtent            = renderExtent;
+		std::uint32_t resizeStormFrames           = 0;
+		std::uint32_t swapchainRecreations        = 0;
+		std::uint32_t skippedFrames               = 0;
+		FrameTimeStats recreateFrameTimes;
+		FrameTimeStats steadyFrameTimes;
+		while (options.m_Headless || !glfwWindowShouldClose(windowPtr)) {
+			if (options.m_FrameCount && renderedFrames >= options.m_FrameCount)
+				break;
+
+			PROFILE_ZONE("Frame");
+
+			auto frameStart = std::chrono::steady_clock::now();
+
+			// Resize the window every frame during the resize storm benchmark, alternating between the requested and three quarters of the requested size
+			if (!options.m_Headless && resizeStormFrames < options.m_ResizeStorm) {
+				bool shrink = resizeStormFrames % 2 == 0;
+				glfwSetWindowSize(windowPtr, static_cast<int>(shrink ? options.m_Width * 3 / 4 : options.m_Width), static_cast<int>(shrink ? options.m_Height * 3 / 4 : options.m_Height));
+				++resizeStormFrames;
+			}
+
+			if (!options.m_Headless)
+				glfwPollEvents();
+
+			// Recreate the swapchain when the window was resized or the swapchain went out of date.
+			// The old swapchain goes through the deletion queue until the frames already submitted to it have completed, so this never idles the device
+			bool recreatedSwapchain = false;
+			if (!options.m_Headless) {
+				std::int32_t fw, fh;
+				glfwGetFramebufferSize(windowPtr, &fw, &fh);
+				vk::Extent2D extent = { static_cast<std::uint32_t>(fw), static_cast<std::uint32_t>(fh) };
+				if (extent != framebufferExtent) {
+					framebufferExtent  = extent;
+					swapchainOutOfDate = true;
+				}
+
+				if (swapchainOutOfDate) {
+					PROFILE_ZONE("Recreate swapchain");
 
-			// Begin frame
-			vk::Result result = vulkanDevice.waitForFences({ vulkanInFlightFences[currentFrame] }, true, ~0ULL);
-			vulkanDevice.resetFences({ vulkanInFlightFences[currentFrame] });
+					// A minimized window has no area to present to, sleep until it is restored
+					if (!swapchain.recreate(extent)) {
+						glfwWaitEvents();
+						continue;
+					}
 
-			std::uint32_t imageIndex;
-			result = vulkanDevice.acquireNextImageKHR(vulkanSwapchain, -1, vulkanImageAvailableSemaphores[currentFrame], nullptr, &imageIndex);
+					renderExtent = swapchain.getExtent();
+					vulkanImagesInFlight.assign(swapchain.getImageCount(), nullptr);
+					swapchainOutOfDate = false;
+					recreatedSwapchain = true;
+					++swapchainRecreations;
+				}
+			}
 
-			if (result == vk::Result::eErrorOutOfDateKHR) {
-				// Recreate swapchain.
-				// Begin Frame again.
-				continue;
-			} else if (result != vk::Result::eSuccess && result != vk::Result::eSuboptimalKHR) {
-				vk::throwResultException(result, "vk::Device::acquireNextImageKHR");
+			// Begin frame, this only blocks while the GPU still executes the frame that last used this frame slot
+			{
+				PROFILE_ZONE("Wait for frame");
+				currentFrame = framePacer.beginFrame();
 			}
+			uniformRing.beginFrame(static_cast<std::uint32_t>(currentFrame));
+			deletionQueue.collect();
+
+			vk::Framebuffer currentFramebuffer;
+			if (!options.m_Headless) {
+				PROFILE_ZONE("Acquire");
+
+				std::uint32_t imageIndex;
+				vk::Result result = swapchain.acquire(framePacer.getImageAvailableSemaphore(), imageIndex);
+
+				// Drop this frame and recreate the swapchain before the next one, a suboptimal swapchain can still be rendered to first
+				if (result == vk::Result::eErrorOutOfDateKHR) {
+					swapchainOutOfDate = true;
+					++skippedFrames;
+					framePacer.skipFrame();
+					continue;
+				} else if (result == vk::Result::eSuboptimalKHR) {
+					swapchainOutOfDate = true;
+				} else if (result != vk::Result::eSuccess) {
+					vk::throwResultException(result, "vk::Device::acquireNextImageKHR");
+				}
+
+				currentImage = imageIndex;
 
-			currentImage = imageIndex;
+				// Wait for an older frame that is still rendering to this swapchain image
+				if (vulkanImagesInFlight[currentImage])
+					result = vulkanDevice.waitForFences({ vulkanImagesInFlight[currentImage] }, true, ~0ULL);
+				vulkanImagesInFlight[currentImage] = framePacer.getInFlightFence();
 
-			if (vulkanImagesInFlight[currentImage])
-				result = vulkanDevice.waitForFences({ vulkanImagesInFlight[currentImage] }, true, ~0ULL);
-			vulkanImagesInFlight[currentImage] = vulkanInFlightFences[currentFrame];
+				currentFramebuffer = swapchain.getFramebuffer(imageIndex);
+			} else {
+				currentFramebuffer = offscreenTarget.getFramebuffer(static_cast<std::uint32_t>(currentFrame));
+			}
 
-			vulkanDevice.resetCommandPool(vulkanCommandPools[currentFrame]);
-			vulkanDevice.resetFences({ vulkanInFlightFences[currentFrame] });
+			// Reset the command pools of every recording thread for this frame
+			for (std::size_t thread = 0; thread < threadCount; ++thread)
+				vulkanDevice.resetCommandPool(vulkanCommandPools[thread + currentFrame * threadCount]);
 
 			// Collect commands
-			vk::CommandBuffer currentCommandBuffer = vulkanCommandBuffers[currentFrame][0];
+			vk::CommandBuffer currentCommandBuffer = vulkanCommandBuffers[currentFrame * threadCount][0];
 
 			vk::CommandBufferBeginInfo beginInfo = {};
 			currentCommandBuffer.begin(beginInfo);
+			framePacer.beginTimestamps(currentCommandBuffer);
+			gpuProfiler.beginFrame(currentCommandBuffer, static_cast<std::uint32_t>(currentFrame));
+
+			// Take ownership of finished uploads, the submission waits on their transfer semaphores
+			std::vector<vk::Semaphore> uploadWaitSemaphores;
+			std::vector<vk::PipelineStageFlags> uploadWaitStages;
+			uploadManager.collect(framePacer.getCompletedFrameSerial());
+			textureStreamer.update();
+			{
+				Graphics::GPUProfileScope scope = { gpuProfiler, currentCommandBuffer, "Uploads" };
+				uploadManager.acquire(currentCommandBuffer, framePacer.getFrameSerial(), uploadWaitSemaphores, uploadWaitStages);
+			}
+
+			// Compact the geometry arenas once the last report found them fragmented, the copies finish before any draw of this frame reads the new ranges
+			if (defragmentGeometry) {
+				PROFILE_ZONE("Defragment geometry");
+
+				defragmentGeometry = false;
+				vertexArena.defragment(currentCommandBuffer);
+				indexArena.defragment(currentCommandBuffer);
+				updateMeshRanges();
+			}
+
+			// Pick up the graphics pipeline once the compiler has finished it
+			if (!currentPipeline) {
+				currentPipeline = pipelineCompiler.getPipeline(graphicsPipeline);
+				if (currentPipeline) {
+					auto timeToPipeline = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+					std::cout << "Graphics pipeline ready after " << timeToPipeline << " ms (compiled in " << pipelineCompiler.getCompileTime(graphicsPipeline) << " ms)\n";
+				}
+			}
+
+			// Add textures to the bindless table as they become resident, or swap the first one into the descriptor set of this frame.
+			// The placeholder is shown until then
+			if (bindless && registeredTextureCount != textureStreamer.getResidentCount()) {
+				for (std::size_t i = 0; i < textureIndices.size(); ++i) {
+					vk::ImageView textureView = textureStreamer.getImageView(static_cast<std::uint32_t>(i));
+					if (textureView && textureIndices[i] == placeholderTextureIndex) {
+						textureIndices[i] = bindlessTable.addImage(textureView);
+						++registeredTextureCount;
+					}
+				}
+			}
+			if (textureStreamer.getTextureCount() > 0) {
+				vk::ImageView textureView = textureStreamer.getImageView(0);
+				if (!bindless && textureView && descriptorImageViews[currentFrame] != textureView) {
+					vk::DescriptorImageInfo imageInfo = { imageSampler, textureView, vk::ImageLayout::eShaderReadOnlyOptimal };
+					vulkanDevice.updateDescriptorSets({ { descriptorSets[currentFrame], 1, 0, 1, vk::DescriptorType::eCombinedImageSampler, &imageInfo, nullptr, nullptr } }, {});
+					descriptorImageViews[currentFrame] = textureView;
+				}
+
+				if (!texturesStreamed && textureStreamer.getPendingCount() == 0) {
+					texturesStreamed = true;
+
+					auto streamTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - textureStreamStart).count();
+					std::cout << "Streamed " << textureStreamer.getResidentCount() << " of " << textureStreamer.getTextureCount() << " textures in " << streamTime << " ms\n";
+				}
+			}
+
+			auto recordStart = std::chrono::steady_clock::now();
+
+			// Move the camera, the projection follows the aspect ratio of the current extent
+			float cameraTime = std::chrono::duration<float>(recordStart - renderStart).count();
+			projView         = getCameraProjView(cameraTime, static_cast<float>(renderExtent.width) / static_cast<float>(std::max(renderExtent.height, 1U)), gridSpacing, gridSize);
+
+			// Submit every draw to the render queue, sorting brings draws with the same state together so they merge into instanced draws
+			renderQueue.clear();
+			if (currentPipeline && !options.m_GPUDriven) {
+				PROFILE_ZONE("Build render queue");
+
+				vk::Buffer vertexBuffer = vertexArena.getBuffer(vertexArena.getRange(meshVertices).m_Page);
+				vk::Buffer indexBuffer  = indexArena.getBuffer(indexArena.getRange(meshIndices).m_Page);
+				for (auto& draw : drawList) {
+					// Distant draws use a coarser level of detail, draws at the same level still merge into one instanced draw
+					std::size_t lodIndex = selectLOD(meshLODs, projView, draw.m_Model, meshBoundingRadius, static_cast<float>(renderExtent.height), options.m_LODThreshold);
+					auto& lod            = meshLODs[lodIndex];
+
+					Graphics::RenderPacket packet;
+					packet.m_Pipeline          = currentPipeline;
+					packet.m_Layout            = graphicsPipelineLayout;
+					packet.m_DescriptorSet     = descriptorSets[currentFrame];
+					packet.m_VertexBuffer      = vertexBuffer;
+					packet.m_IndexBuffer       = indexBuffer;
+					packet.m_IndexBufferOffset = 0;
+					packet.m_IndexCount        = lod.m_IndexCount;
+					packet.m_FirstIndex        = draw.m_FirstIndex + lod.m_FirstIndex;
+					packet.m_VertexOffset      = draw.m_VertexOffset;
+					packet.m_Model             = draw.m_Model * meshDequantize;
+
+					// Switching textures is a push constant, not another descriptor set
+					std::uint32_t material = 0;
+					if (bindless) {
+						material                  = textureIndices.empty() ? placeholderTextureIndex : textureIndices[draw.m_Texture];
+						packet.m_HasDrawConstants = true;
+						packet.m_DrawConstants    = { material, samplerIndex };
+					}
+
+					// Every draw shares the mesh, so the level of detail is the mesh field and draws at the same level sort next to each other
+					packet.m_SortKey = Graphics::RenderQueue::MakeSortKey(graphicsPipeline, material, static_cast<std::uint32_t>(lodIndex), getClipDepth(projView, draw.m_Model));
+					renderQueue.push(packet);
+				}
+				renderQueue.build();
+			}
+
+			// Cull before the render pass starts, the indirect draws read what the dispatch wrote
+			if (options.m_GPUDriven) {
+				Graphics::GPUProfileScope scope = { gpuProfiler, currentCommandBuffer, "Culling" };
+				gpuCuller.cull(currentCommandBuffer, static_cast<std::uint32_t>(currentFrame), projView, static_cast<float>(renderExtent.height), options.m_LODThreshold);
+			}
+
+			// Step the particles before the render pass starts. On a dedicated compute queue the step overlaps with the graphics queue still rendering the previous frame,
+			// and this frame's submission only waits for it at vertex input
+			std::vector<vk::Semaphore> computeWaitSemaphores;
+			std::vector<vk::PipelineStageFlags> computeWaitStages;
+			std::vector<vk::Semaphore> computeSignalSemaphores;
+			if (particleSystem.isCreated()) {
+				PROFILE_ZONE("Simulate particles");
+
+				auto now           = std::chrono::steady_clock::now();
+				float deltaTime    = std::min(std::chrono::duration<float>(now - lastSimulationTime).count(), 0.1f);
+				lastSimulationTime = now;
+
+				vk::CommandBuffer computeCommandBuffer = asyncCompute.begin(static_cast<std::uint32_t>(currentFrame), currentCommandBuffer);
+				particleSystem.simulate(computeCommandBuffer, deltaTime);
+				asyncCompute.submit(vk::PipelineStageFlagBits::eVertexInput, computeWaitSemaphores, computeWaitStages, computeSignalSemaphores);
+			}
+
+			// Build the overlay before recording, the draw data stays valid until the next 'ImGui::NewFrame'
+			const ImDrawData* overlayDrawData = nullptr;
+			if (options.m_Overlay) {
+				PROFILE_ZONE("Build overlay");
+
+				auto now        = std::chrono::steady_clock::now();
+				ImGuiIO& io     = ImGui::GetIO();
+				io.DeltaTime    = std::max(std::chrono::duration<float>(now - lastOverlayTime).count(), 1e-4f);
+				io.DisplaySize  = { static_cast<float>(renderExtent.width), static_cast<float>(renderExtent.height) };
+				lastOverlayTime = now;
+				if (!options.m_Headless) {
+					// Cursor positions are in window coordinates, which differ from framebuffer pixels on high DPI displays
+					int windowWidth, windowHeight;
+					double cursorX, cursorY;
+					glfwGetWindowSize(windowPtr, &windowWidth, &windowHeight);
+					glfwGetCursorPos(windowPtr, &cursorX, &cursorY);
+					if (windowWidth > 0 && windowHeight > 0) {
+						io.DisplaySize             = { static_cast<float>(windowWidth), static_cast<float>(windowHeight) };
+						io.DisplayFramebufferScale = { static_cast<float>(renderExtent.width) / windowWidth, static_cast<float>(renderExtent.height) / windowHeight };
+					}
+					io.AddMousePosEvent(static_cast<float>(cursorX), static_cast<float>(cursorY));
+					io.AddMouseButtonEvent(0, glfwGetMouseButton(windowPtr, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS);
+				}
+
+				ImGui::NewFrame();
+				gpuProfiler.drawOverlay();
+				ImGui::Render();
+				overlayDrawData = ImGui::GetDrawData();
+			}
+
+			// The scene scope covers the whole render pass, including the overlay
+			auto sceneScope = gpuProfiler.beginScope(currentCommandBuffer, "Scene");
 
 			std::vector<vk::ClearValue> renderPassClearValues = { { std::array<float, 4> { 0.1f, 0.1f, 0.1f, 1.0f } }, { { 1.0f, 0 } } };
-			currentCommandBuffer.beginRenderPass({ vulkanRenderPass, vulkanSwapchainFramebuffers[currentImage], { { 0, 0 }, vulkanSwapchainExtent }, renderPassClearValues }, vk::SubpassContents::eInline);
+			if (threadCount > 1 && !options.m_GPUDriven) {
+				PROFILE_ZONE("Record");
+
+				currentCommandBuffer.beginRenderPass({ vulkanRenderPass, currentFramebuffer, { { 0, 0 }, renderExtent }, renderPassClearValues }, vk::SubpassContents::eSecondaryCommandBuffers);
+
+				// ------------------
+				// -- Dynamic data --
+
+				// Every thread records an equally sized slice of the render queue into its own secondary command buffer, the last one draws the particles and the overlay on top.
+				// The secondary buffers run inside the frame's pipeline statistics query, so they have to inherit it
+				auto& secondaryCommandBuffers                    = vulkanSecondaryCommandBuffers[currentFrame];
+				vk::CommandBufferInheritanceInfo inheritanceInfo = { vulkanRenderPass, 0, currentFramebuffer, false, {}, gpuProfiler.getPipelineStatisticFlags() };
+				recordThreadPool.parallelFor(threadCount, [&](std::size_t thread) {
+					PROFILE_ZONE("Record draws");
+
+					vk::CommandBuffer secondaryCommandBuffer = secondaryCommandBuffers[thread];
+					secondaryCommandBuffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue, &inheritanceInfo });
+					recordDraws(secondaryCommandBuffer, renderQueue.getDrawCount() * thread / threadCount, renderQueue.getDrawCount() * (thread + 1) / threadCount);
+					if (thread == threadCount - 1) {
+						particleSystem.draw(secondaryCommandBuffer, renderExtent, projView);
+						imguiRenderer.record(secondaryCommandBuffer, static_cast<std::uint32_t>(currentFrame), overlayDrawData);
+					}
+					secondaryCommandBuffer.end();
+				});
+
+				currentCommandBuffer.executeCommands(secondaryCommandBuffers);
+
+				// -- Dynamic Data --
+				// ------------------
+			} else {
+				PROFILE_ZONE("Record");
 
-			// ------------------
-			// -- Dynamic data --
+				currentCommandBuffer.beginRenderPass({ vulkanRenderPass, currentFramebuffer, { { 0, 0 }, renderExtent }, renderPassClearValues }, vk::SubpassContents::eInline);
 
-			currentCommandBuffer.setViewport(0, { { 0.0f, 0.0f, static_cast<float>(vulkanSwapchainExtent.width), static_cast<float>(vulkanSwapchainExtent.height), 0.0f, 1.0f } });
-			currentCommandBuffer.setScissor(0, { { { 0, 0 }, vulkanSwapchainExtent } });
-			currentCommandBuffer.setLineWidth(1.0f);
-			currentCommandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, graphicsPipeline);
-			currentCommandBuffer.bindVertexBuffers(0, meshBuffer, 0ULL);
-			currentCommandBuffer.bindIndexBuffer(meshBuffer, 192, vk::IndexType::eUint32);
-			currentCommandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, graphicsPipelineLayout, 0, descriptorSets[currentFrame], {});
-			currentCommandBuffer.drawIndexed(12, 1, 0, 0, 0);
+				// ------------------
+				// -- Dynamic data --
 
-			// -- Dynamic Data --
-			// ------------------
+				recordDraws(currentCommandBuffer, 0, renderQueue.getDrawCount());
+				particleSystem.draw(currentCommandBuffer, renderExtent, projView);
+				imguiRenderer.record(currentCommandBuffer, static_cast<std::uint32_t>(currentFrame), overlayDrawData);
+
+				// -- Dynamic Data --
+				// ------------------
+			}
+
+			double recordTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
 
 			currentCommandBuffer.endRenderPass();
+			gpuProfiler.endScope(currentCommandBuffer, sceneScope);
+			gpuProfiler.endFrame(currentCommandBuffer);
+			framePacer.endTimestamps(currentCommandBuffer);
 			currentCommandBuffer.end();
+			uniformRing.flush();
+
+			// End frame, headless frames have no swapchain image to wait for or present
+			std::vector<vk::Semaphore> waitSemaphores;
+			std::vector<vk::Semaphore> signalSemaphores;
+			std::vector<vk::PipelineStageFlags> waitDstStageMask;
+			if (!options.m_Headless) {
+				waitSemaphores   = { framePacer.getImageAvailableSemaphore() };
+				signalSemaphores = { framePacer.getRenderFinishedSemaphore() };
+				waitDstStageMask = { vk::PipelineStageFlagBits::eColorAttachmentOutput };
+			}
+			waitSemaphores.insert(waitSemaphores.end(), uploadWaitSemaphores.begin(), uploadWaitSemaphores.end());
+			waitDstStageMask.insert(waitDstStageMask.end(), uploadWaitStages.begin(), uploadWaitStages.end());
+			waitSemaphores.insert(waitSemaphores.end(), computeWaitSemaphores.begin(), computeWaitSemaphores.end());
+			waitDstStageMask.insert(waitDstStageMask.end(), computeWaitStages.begin(), computeWaitStages.end());
+			signalSemaphores.insert(signalSemaphores.end(), computeSignalSemaphores.begin(), computeSignalSemaphores.end());
+			std::vector<vk::CommandBuffer>& submitCommandBuffers = vulkanCommandBuffers[currentFrame * threadCount];
+			{
+				PROFILE_ZONE("Submit");
+				vulkanGraphicsQueue.submit({ { waitSemaphores, waitDstStageMask, submitCommandBuffers, signalSemaphores } }, framePacer.prepareSubmit());
+			}
+
+			vk::Result result = vk::Result::eSuccess;
+			if (!options.m_Headless) {
+				PROFILE_ZONE("Present");
+
+				result = swapchain.present(vulkanGraphicsQueue, signalSemaphores[0], static_cast<std::uint32_t>(currentImage));
+			}
+			lastRenderedFrame = static_cast<std::uint32_t>(currentFrame);
+			++renderedFrames;
+			framePacer.endFrame();
 
-			// End frame
-			std::vector<vk::Semaphore> waitSemaphores            = { vulkanImageAvailableSemaphores[currentFrame] };
-			std::vector<vk::Semaphore> signalSemaphores          = { vulkanRenderFinishedSemaphores[currentFrame] };
-			std::vector<vk::PipelineStageFlags> waitDstStageMask = { vk::PipelineStageFlagBits::eColorAttachmentOutput };
-			std::vector<vk::CommandBuffer>& submitCommandBuffers = vulkanCommandBuffers[currentFrame];
-			vulkanGraphicsQueue.submit({ { waitSemaphores, waitDstStageMask, submitCommandBuffers, signalSemaphores } }, vulkanInFlightFences[currentFrame]);
+			if (options.m_ResizeStorm > 0) {
+				double frameTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+				(recreatedSwapchain ? recreateFrameTimes : steadyFrameTimes).add(frameTime);
+			}
 
-			std::vector<vk::SwapchainKHR> presentSwapchains = { vulkanSwapchain };
-			std::vector<std::uint32_t> presentImageIndices  = { static_cast<std::uint32_t>(currentImage) };
+			// Report average frame timings once every second
+			{
+				auto& timings = framePacer.getLastTimings();
+				totalTimings.m_CPUTime += timings.m_CPUTime;
+				totalTimings.m_GPUTime += timings.m_GPUTime;
+				totalTimings.m_WaitTime += timings.m_WaitTime;
+
+				accumulatedTimings.m_CPUTime += timings.m_CPUTime;
+				accumulatedTimings.m_GPUTime += timings.m_GPUTime;
+				accumulatedTimings.m_WaitTime += timings.m_WaitTime;
+
+				totalRecordTime += recordTime;
+				accumulatedRecordTime += recordTime;
+				++accumulatedFrames;
+
+				auto now = std::chrono::steady_clock::now();
+				if (now - lastTimingsReport >= std::chrono::seconds(1)) {
+					std::cout << "Frame timings (" << accumulatedFrames << " frames, " << framePacer.getFramesInFlight() << " in flight): CPU " << accumulatedTimings.m_CPUTime / accumulatedFrames << " ms, GPU ";
+					if (framePacer.hasGPUTimings())
+						std::cout << accumulatedTimings.m_GPUTime / accumulatedFrames << " ms";
+					else
+						std::cout << "n/a";
+					std::cout << ", wait " << accumulatedTimings.m_WaitTime / accumulatedFrames << " ms, record " << accumulatedRecordTime / accumulatedFrames << " ms (" << drawList.size() << " draws in " << renderQueue.getDrawCount() << " instanced draws, " << threadCount << " threads)\n";
+
+					auto vertexStatistics = vertexArena.getStatistics();
+					auto indexStatistics  = indexArena.getStatistics();
+					for (auto [name, statistics] : { std::pair { "vertex", vertexStatistics }, std::pair { "index", indexStatistics } })
+						std::cout << "Geometry " << name << " arena: " << statistics.m_AllocationCount << " allocations in " << statistics.m_PageCount << " pages, " << statistics.m_UsedBytes / 1024 << " of " << statistics.m_CapacityBytes / 1024 << " KiB used, " << statistics.m_FreeRangeCount << " free ranges, " << statistics.m_Fragmentation * 100.0f << "% fragmented\n";
+
+					// The GPU culler holds copies of the mesh offsets, so only CPU driven draws follow the mesh when it moves
+					bool fragmented    = vertexStatistics.m_Fragmentation > VULKAN_GEOMETRY_DEFRAGMENT_THRESHOLD || indexStatistics.m_Fragmentation > VULKAN_GEOMETRY_DEFRAGMENT_THRESHOLD;
+					defragmentGeometry = fragmented && !options.m_GPUDriven && uploadManager.isAvailable(meshUploadBatch);
+
+					accumulatedTimings    = {};
+					accumulatedRecordTime = 0.0;
+					accumulatedFrames     = 0;
+					lastTimingsReport     = now;
+				}
+			}
 
-			result = vulkanGraphicsQueue.presentKHR({ signalSemaphores, presentSwapchains, presentImageIndices });
+			// The frame was still submitted, the swapchain is recreated before the next one
 			if (result == vk::Result::eErrorOutOfDateKHR || result == vk::Result::eSuboptimalKHR) {
-				// Recreate swapchain.
-				continue;
+				swapchainOutOfDate = true;
 			} else if (result != vk::Result::eSuccess) {
 				vk::throwResultException(result, "vk::Queue::presentKHR");
 			}
 
-			vulkanGraphicsQueue.waitIdle();
+			if (!firstFramePresented) {
+				firstFramePresented = true;
+
+				auto timeToFirstFrame = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+				std::cout << "Time to first frame: " << timeToFirstFrame << " ms (pipeline cache " << (pipelineCache.isWarm() ? "warm" : "cold") << ")\n";
+				std::cout << "Uploaded " << uploadManager.getUploadedBytes() << " bytes through the " << (uploadManager.isDedicatedTransferQueue() ? "dedicated transfer" : "graphics") << " queue\n";
+			}
+		}
+
+		// Wait for every frame in flight to finish before destroying anything they might still use
+		vulkanDevice.waitIdle();
+
+		// Write the GPU profile, including the frames that were still in flight
+		if (!options.m_ProfileOutputPath.empty()) {
+			gpuProfiler.resolve();
+
+			std::filesystem::path profilePath = options.m_ProfileOutputPath;
+			bool written                      = profilePath.extension() == ".json" ? gpuProfiler.writeJSON(profilePath) : gpuProfiler.writeCSV(profilePath);
+			if (!written)
+				std::cerr << "Failed to write GPU profile to '" << options.m_ProfileOutputPath << "'\n";
+		}
+
+		// Write the CPU zones of startup and the most recent frames, the recording threads are idle by now
+		if (!options.m_TraceOutputPath.empty()) {
+	#ifdef _DIST
+			std::cerr << "CPU zones are compiled out of Dist builds, no trace is written\n";
+	#else
+			auto& cpuProfiler = Utils::CPUProfiler::Get();
+			if (!cpuProfiler.writeTrace(options.m_TraceOutputPath))
+				std::cerr << "Failed to write CPU trace to '" << options.m_TraceOutputPath << "'\n";
+			else if (std::uint64_t dropped = cpuProfiler.getDroppedCount(); dropped > 0)
+				std::cout << "CPU trace holds startup and the most recent zones, " << dropped << " zones in between were overwritten\n";
+	#endif
+		}
+
+		// Report how recreating the swapchain during the resize storm affected frame times
+		if (options.m_ResizeStorm > 0 && !options.m_Headless) {
+			std::cout << "Resize storm: " << swapchainRecreations << " swapchain recreations, " << skippedFrames << " skipped frames, frame time " << recreateFrameTimes.getAverage() << " ms avg / " << recreateFrameTimes.m_Max << " ms max when recreating, ";
+			std::cout << steadyFrameTimes.getAverage() << " ms avg / " << steadyFrameTimes.m_Max << " ms max otherwise\n";
+		}
 
-			currentFrame = (currentFrame + 1) % VULKAN_MAX_FRAMES_IN_FLIGHT;
+		// Report throughput of the headless run and write the last frame to disk
+		if (options.m_Headless && renderedFrames > 0) {
+			double totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count();
+			std::cout << "Rendered " << renderedFrames << " frames at " << renderExtent.width << "x" << renderExtent.height << " in " << totalTime << " s: " << renderedFrames / totalTime << " FPS, CPU " << totalTimings.m_CPUTime / renderedFrames << " ms/frame, GPU ";
+			if (framePacer.hasGPUTimings())
+				std::cout << totalTimings.m_GPUTime / renderedFrames << " ms/frame";
+			else
+				std::cout << "n/a";
+			std::cout << ", wait " << totalTimings.m_WaitTime / renderedFrames << " ms/frame, record " << totalRecordTime / renderedFrames << " ms/frame (" << drawList.size() << " draws, " << threadCount << " threads)\n";
+
+			if (!options.m_OutputPath.empty()) {
+				vulkanDevice.resetCommandPool(vulkanCommandPools[0]);
+				auto pixels = offscreenTarget.readColor(lastRenderedFrame, vulkanGraphicsQueue, vulkanCommandPools[0]);
+				if (!stbi_write_png(options.m_OutputPath.c_str(), static_cast<int>(renderExtent.width), static_cast<int>(renderExtent.height), 4, pixels.data(), static_cast<int>(renderExtent.width * 4)))
+					std::cerr << "Failed to write last frame to '" << options.m_OutputPath << "'\n";
+			}
 		}
 
 		// ------------------
 		// -- Dynamic data --
 
-		// Destroy Uniform Buffer
-		vmaDestroyBuffer(vmaAllocator, uniformBuffer, uniformBufferAllocation);
+		// Destroy Uniform Ring
+		uniformRing.destroy();
 
-		// Destroy Mesh Buffer
-		vmaDestroyBuffer(vmaAllocator, meshBuffer, meshBufferAllocation);
+		// Destroy the geometry arenas, pages replaced by defragmenting are in the deletion queue
+		indexArena.destroy();
+		vertexArena.destroy();
 
 		// Destroy Image
 		vmaDestroyImage(vmaAllocator, image, imageAllocation);
@@ -794,8 +1551,26 @@ int main(int argc, char** argv) {
 		// Destroy Descriptor Pool
 		vulkanDevice.destroyDescriptorPool(descriptorPool);
 
-		// Destroy Graphics Pipeline
-		vulkanDevice.destroyPipeline(graphicsPipeline);
+		// Destroy Bindless Table
+		bindlessTable.destroy();
+
+		// Destroy GPU Culler
+		gpuCuller.destroy();
+
+		// Destroy Particle System
+		particleSystem.destroy();
+
+		// Destroy ImGui overlay
+		if (options.m_Overlay) {
+			imguiRenderer.destroy();
+			ImGui::DestroyContext();
+		}
+
+		// Destroy Graphics Pipelines
+		pipelineCompiler.destroy();
+
+		// Destroy Shader Modules
+		shaderLibrary.destroy();
 
 		// Destroy Graphics Pipeline Layout
 		vulkanDevice.destroyPipelineLayout(graphicsPipelineLayout);
@@ -808,41 +1583,41 @@ int main(int argc, char** argv) {
 
 		// Destroy Vulkan Swapchain
 		{
-			// INFO: Most of this should be able to be moved into a separate function to support recreating the swapchain when the window resizes
-
-			// Destroy framebuffers
-			for (auto& framebuffer : vulkanSwapchainFramebuffers)
-				vulkanDevice.destroyFramebuffer(framebuffer);
-
-			// Destroy depth image views
-			for (auto& imageView : vulkanSwapchainDepthImageViews)
-				vulkanDevice.destroyImageView(imageView);
-
-			// Destroy depth images
-			for (std::size_t i = 0; i < vulkanSwapchainDepthImages.size(); ++i)
-				vmaDestroyImage(vmaAllocator, vulkanSwapchainDepthImages[i], vulkanSwapchainDepthImageAllocations[i]);
+			// Destroy everything that was released at runtime, such as swapchains replaced on resize
+			deletionQueue.flush();
 
-			// Destroy Vulkan Image Views
-			for (auto& imageView : vulkanSwapchainImageViews)
-				vulkanDevice.destroyImageView(imageView);
+			swapchain.destroy();
 
 			// Destroy Vulkan Render Pass
 			vulkanDevice.destroyRenderPass(vulkanRenderPass);
 
-			// Destroy Vulkan Swapchain
-			vulkanDevice.destroySwapchainKHR(vulkanSwapchain);
+			// Destroy offscreen images
+			offscreenTarget.destroy();
 		}
 
-		// Destroy all Vulkan Semaphores
-		for (auto& semaphore : vulkanImageAvailableSemaphores) vulkanDevice.destroySemaphore(semaphore);
-		for (auto& semaphore : vulkanRenderFinishedSemaphores) vulkanDevice.destroySemaphore(semaphore);
+		// Destroy all Vulkan Semaphores and Fences
+		framePacer.destroy();
 
-		// Destroy all Vulkan Fences
-		for (auto& fence : vulkanInFlightFences) vulkanDevice.destroyFence(fence);
+		// Destroy the async compute command pools and semaphores
+		asyncCompute.destroy();
+
+		// Destroy GPU profiler queries
+		gpuProfiler.destroy();
 
 		// Destroy all Vulkan Command Pools
 		for (auto& commandPool : vulkanCommandPools) vulkanDevice.destroyCommandPool(commandPool);
 
+		// Save and destroy Vulkan Pipeline Cache
+		if (!pipelineCache.save())
+			std::cerr << "Failed to save pipeline cache to '" << pipelineCache.getPath().string() << "'\n";
+		pipelineCache.destroy();
+
+		// Destroy streamed textures
+		textureStreamer.destroy();
+
+		// Destroy the upload manager and its staging ring
+		uploadManager.destroy();
+
 		// Destroy Vulkan Memory Allocator
 		vmaDestroyAllocator(vmaAllocator);
 
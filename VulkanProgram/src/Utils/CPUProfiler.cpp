@@ -0,0 +1,73 @@
+#include "Utils/CPUProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+namespace Utils {
+	CPUProfiler& CPUProfiler::Get() {
+		static CPUProfiler s_Profiler;
+		return s_Profiler;
+	}
+
+	std::uint64_t CPUProfiler::Now() {
+		static const auto s_Epoch = std::chrono::steady_clock::now();
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Epoch).count());
+	}
+
+	bool CPUProfiler::writeTrace(const std::filesystem::path& path) {
+		std::ofstream file(path, std::ios::trunc);
+		if (!file)
+			return false;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		// Zone and thread names come from string literals in this code base, so they're written without escaping. Times are in microseconds
+		file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}}";
+		for (auto& buffer : m_Buffers) {
+			file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->m_ThreadId << ",\"args\":{\"name\":\"";
+			if (buffer->m_Name.empty())
+				file << "Thread " << buffer->m_ThreadId;
+			else
+				file << buffer->m_Name;
+			file << "\"}}";
+
+			auto writeEvent = [&file, &buffer](const ProfileEvent& event) {
+				file << ",\n{\"name\":\"" << event.m_Name << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->m_ThreadId << ",\"ts\":" << event.m_Start / 1000.0 << ",\"dur\":" << (event.m_End - event.m_Start) / 1000.0 << "}";
+			};
+
+			// The first zones are all kept, of the rest only the newest 's_Capacity' are still in the ring
+			std::uint64_t head       = buffer->m_Head.load(std::memory_order_acquire);
+			std::uint64_t firstCount = std::min<std::uint64_t>(head, ProfileThreadBuffer::s_FirstCapacity);
+			for (std::uint64_t i = 0; i < firstCount; ++i)
+				writeEvent(buffer->m_FirstEvents[i]);
+
+			std::uint64_t ringHead  = head - firstCount;
+			std::uint64_t ringCount = std::min<std::uint64_t>(ringHead, ProfileThreadBuffer::s_Capacity);
+			for (std::uint64_t i = ringHead - ringCount; i < ringHead; ++i)
+				writeEvent(buffer->m_Events[i % ProfileThreadBuffer::s_Capacity]);
+		}
+		file << "\n]}\n";
+		return static_cast<bool>(file);
+	}
+
+	std::uint64_t CPUProfiler::getDroppedCount() {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		std::uint64_t dropped = 0;
+		for (auto& buffer : m_Buffers)
+			dropped += buffer->getDroppedCount();
+		return dropped;
+	}
+
+	ProfileThreadBuffer& CPUProfiler::getThreadBuffer() {
+		thread_local ProfileThreadBuffer* t_Buffer = nullptr;
+		if (!t_Buffer) {
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			t_Buffer = m_Buffers.emplace_back(std::make_unique<ProfileThreadBuffer>(static_cast<std::uint32_t>(m_Buffers.size()))).get();
+		}
+		return *t_Buffer;
+	}
+} // namespace Utils
@@ -0,0 +1,110 @@
+#include "Utils/MappedFile.h"
+
+#include <utility>
+
+#if _WIN32
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace Utils {
+	MappedFile::MappedFile(const std::filesystem::path& path) {
+		open(path);
+	}
+
+	MappedFile::MappedFile(MappedFile&& move) noexcept {
+		*this = std::move(move);
+	}
+
+	MappedFile::~MappedFile() {
+		close();
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& move) noexcept {
+		if (this != &move) {
+			close();
+			m_Data = std::exchange(move.m_Data, nullptr);
+			m_Size = std::exchange(move.m_Size, 0);
+#if _WIN32
+			m_FileHandle    = std::exchange(move.m_FileHandle, nullptr);
+			m_MappingHandle = std::exchange(move.m_MappingHandle, nullptr);
+#endif
+		}
+		return *this;
+	}
+
+	bool MappedFile::open(const std::filesystem::path& path) {
+		close();
+
+#if _WIN32
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping) {
+			CloseHandle(file);
+			return false;
+		}
+
+		void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!data) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		m_FileHandle    = file;
+		m_MappingHandle = mapping;
+		m_Data          = static_cast<const std::uint8_t*>(data);
+		m_Size          = static_cast<std::size_t>(size.QuadPart);
+#else
+		int file = ::open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			return false;
+
+		struct stat status;
+		if (fstat(file, &status) != 0 || status.st_size == 0) {
+			::close(file);
+			return false;
+		}
+
+		// The mapping keeps the file alive, so the descriptor can be closed right away
+		void* data = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		::close(file);
+		if (data == MAP_FAILED)
+			return false;
+
+		m_Data = static_cast<const std::uint8_t*>(data);
+		m_Size = static_cast<std::size_t>(status.st_size);
+#endif
+		return true;
+	}
+
+	void MappedFile::close() {
+		if (!m_Data)
+			return;
+
+#if _WIN32
+		UnmapViewOfFile(m_Data);
+		CloseHandle(m_MappingHandle);
+		CloseHandle(m_FileHandle);
+		m_FileHandle    = nullptr;
+		m_MappingHandle = nullptr;
+#else
+		munmap(const_cast<std::uint8_t*>(m_Data), m_Size);
+#endif
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+} // namespace Utils
@@ -0,0 +1,130 @@
+#include "Utils/MeshFile.h"
+
+#include <cstring>
+
+#include <algorithm>
+#include <fstream>
+#include <system_error>
+
+namespace Utils {
+	namespace {
+		std::uint64_t AlignSection(std::uint64_t offset) {
+			return (offset + MeshFile::s_SectionAlignment - 1) & ~(MeshFile::s_SectionAlignment - 1);
+		}
+
+		void WritePadding(std::ofstream& file, std::uint64_t offset) {
+			static constexpr char padding[MeshFile::s_SectionAlignment] = {};
+			file.write(padding, static_cast<std::streamsize>(offset - static_cast<std::uint64_t>(file.tellp())));
+		}
+	} // namespace
+
+	bool MeshFile::Write(const std::filesystem::path& path, const VertexLayout& layout, const VertexQuantization& quantization, const void* vertices, std::uint32_t vertexCount, const std::vector<std::uint32_t>& indices, const std::vector<MeshFileSubmesh>& submeshes, std::uint32_t lodCount, const float boundingSphere[4]) {
+		if (!layout.isValid() || lodCount == 0 || submeshes.size() % lodCount != 0)
+			return false;
+		std::uint32_t stride = layout.getStride();
+
+		MeshFileHeader header  = {};
+		header.m_Magic         = s_Magic;
+		header.m_Version       = s_Version;
+		header.m_VertexLayout  = layout.pack();
+		header.m_VertexStride  = stride;
+		header.m_VertexCount   = vertexCount;
+		header.m_IndexCount    = static_cast<std::uint32_t>(indices.size());
+		header.m_SubmeshCount  = static_cast<std::uint32_t>(submeshes.size() / lodCount);
+		header.m_LODCount      = lodCount;
+		header.m_SubmeshOffset = AlignSection(sizeof(header));
+		header.m_VertexOffset  = AlignSection(header.m_SubmeshOffset + sizeof(MeshFileSubmesh) * submeshes.size());
+		header.m_IndexOffset   = AlignSection(header.m_VertexOffset + static_cast<std::uint64_t>(stride) * vertexCount);
+		header.m_Quantization  = quantization;
+		std::memcpy(header.m_BoundingSphere, boundingSphere, sizeof(header.m_BoundingSphere));
+
+		// Write to a temporary file first so a running program never maps a half written mesh
+		std::filesystem::path tempPath = path;
+		tempPath += ".tmp";
+		{
+			std::ofstream file = std::ofstream(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+				return false;
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			WritePadding(file, header.m_SubmeshOffset);
+			file.write(reinterpret_cast<const char*>(submeshes.data()), static_cast<std::streamsize>(sizeof(MeshFileSubmesh) * submeshes.size()));
+			WritePadding(file, header.m_VertexOffset);
+			file.write(static_cast<const char*>(vertices), static_cast<std::streamsize>(static_cast<std::uint64_t>(stride) * vertexCount));
+			WritePadding(file, header.m_IndexOffset);
+			file.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(sizeof(std::uint32_t) * indices.size()));
+			file.flush();
+			if (!file) {
+				file.close();
+				std::error_code error;
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(tempPath, path, error);
+		if (error) {
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+		return true;
+	}
+
+	MeshFile::MeshFile(const std::filesystem::path& path) {
+		open(path);
+	}
+
+	bool MeshFile::open(const std::filesystem::path& path) {
+		close();
+		if (!m_File.open(path))
+			return false;
+
+		const std::uint8_t* data = m_File.getData();
+		std::uint64_t size       = m_File.getSize();
+		auto header              = reinterpret_cast<const MeshFileHeader*>(data);
+		if (size < sizeof(MeshFileHeader) || header->m_Magic != s_Magic || header->m_Version != s_Version || header->m_VertexStride == 0 || header->m_VertexStride != VertexLayout::Unpack(header->m_VertexLayout).getStride()) {
+			m_File.close();
+			return false;
+		}
+
+		// Every section has to be aligned and inside of the file, a truncated mesh must not be half uploaded
+		auto isInside = [size](std::uint64_t offset, std::uint64_t sectionSize) { return (offset & (s_SectionAlignment - 1)) == 0 && offset <= size && sectionSize <= size - offset; };
+		if (header->m_LODCount == 0 || !isInside(header->m_SubmeshOffset, sizeof(MeshFileSubmesh) * static_cast<std::uint64_t>(header->m_SubmeshCount) * header->m_LODCount) ||
+		    !isInside(header->m_VertexOffset, static_cast<std::uint64_t>(header->m_VertexStride) * header->m_VertexCount) ||
+		    !isInside(header->m_IndexOffset, sizeof(std::uint32_t) * static_cast<std::uint64_t>(header->m_IndexCount))) {
+			m_File.close();
+			return false;
+		}
+
+		// The submeshes of a level have to follow each other, so the whole level can be drawn as one range
+		auto submeshes = reinterpret_cast<const MeshFileSubmesh*>(data + header->m_SubmeshOffset);
+		for (std::uint64_t i = 0; i < static_cast<std::uint64_t>(header->m_SubmeshCount) * header->m_LODCount; ++i) {
+			bool consecutive = i % header->m_SubmeshCount == 0 || submeshes[i].m_FirstIndex == submeshes[i - 1].m_FirstIndex + submeshes[i - 1].m_IndexCount;
+			if (!consecutive || submeshes[i].m_FirstIndex > header->m_IndexCount || submeshes[i].m_IndexCount > header->m_IndexCount - submeshes[i].m_FirstIndex) {
+				m_File.close();
+				return false;
+			}
+		}
+
+		m_Header    = header;
+		m_Submeshes = submeshes;
+		return true;
+	}
+
+	MeshFileSubmesh MeshFile::getLOD(std::uint32_t lod) const {
+		auto submeshes        = getSubmeshes(lod);
+		MeshFileSubmesh range = { getSubmeshCount() > 0 ? submeshes[0].m_FirstIndex : 0, 0, 0.0f };
+		for (std::uint32_t i = 0; i < getSubmeshCount(); ++i) {
+			range.m_IndexCount += submeshes[i].m_IndexCount;
+			range.m_Error = std::max(range.m_Error, submeshes[i].m_Error);
+		}
+		return range;
+	}
+
+	void MeshFile::close() {
+		m_File.close();
+		m_Header    = nullptr;
+		m_Submeshes = nullptr;
+	}
+} // namespace Utils
@@ -0,0 +1,290 @@
+#include "Utils/MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace Utils {
+	namespace {
+		// FIFO cache where a vertex is resident while fewer than 'm_Size' misses happened since it was loaded
+		struct FIFOCache {
+		public:
+			FIFOCache(std::uint32_t vertexCount, std::uint32_t size)
+			    : m_Timestamps(vertexCount, 0), m_Size(size), m_Time(size + 1) { }
+
+			void reset() { m_Time += m_Size + 1; }
+
+			// Returns 1 and loads 'vertex' if it isn't resident
+			std::uint32_t access(std::uint32_t vertex) {
+				if (m_Time - m_Timestamps[vertex] < m_Size)
+					return 0;
+				m_Timestamps[vertex] = ++m_Time;
+				return 1;
+			}
+
+		private:
+			std::vector<std::uint32_t> m_Timestamps;
+			std::uint32_t m_Size;
+			std::uint32_t m_Time;
+		};
+
+		// Forsyth's scoring: the vertices of the last triangle score a fixed amount so the strip doesn't turn back on itself, older ones decay with their age in the cache.
+		// Vertices with few triangles left get a boost so lone triangles are picked up before they are evicted
+		float ForsythVertexScore(std::int32_t cachePosition, std::uint32_t remainingTriangles) {
+			if (remainingTriangles == 0)
+				return -1.0f;
+
+			float score = 0.0f;
+			if (cachePosition >= 0) {
+				if (cachePosition < 3)
+					score = 0.75f;
+				else
+					score = std::pow(1.0f - static_cast<float>(cachePosition - 3) / static_cast<float>(MeshOptimizer::s_LRUCacheSize - 3), 1.5f);
+			}
+			return score + 2.0f / std::sqrt(static_cast<float>(remainingTriangles));
+		}
+
+		void Subtract(const float* lhs, const float* rhs, float* result) {
+			for (std::size_t i = 0; i < 3; ++i)
+				result[i] = lhs[i] - rhs[i];
+		}
+	} // namespace
+
+	VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const std::uint32_t* indices, std::size_t indexCount, std::uint32_t vertexCount, std::uint32_t cacheSize) {
+		VertexCacheStatistics statistics;
+		if (indexCount < 3)
+			return statistics;
+
+		FIFOCache cache = { vertexCount, cacheSize };
+		std::vector<bool> referenced(vertexCount, false);
+		std::uint32_t referencedCount = 0;
+		for (std::size_t i = 0; i < indexCount; ++i) {
+			statistics.m_Misses += cache.access(indices[i]);
+			if (!referenced[indices[i]]) {
+				referenced[indices[i]] = true;
+				++referencedCount;
+			}
+		}
+
+		statistics.m_ACMR = static_cast<float>(statistics.m_Misses) / static_cast<float>(indexCount / 3);
+		statistics.m_ATVR = static_cast<float>(statistics.m_Misses) / static_cast<float>(referencedCount);
+		return statistics;
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(std::uint32_t* indices, std::size_t indexCount, std::uint32_t vertexCount) {
+		std::size_t triangleCount = indexCount / 3;
+		if (triangleCount < 2)
+			return;
+
+		// Triangles of every vertex, emitted triangles are swapped out of the live part of each list
+		std::vector<std::uint32_t> remaining(vertexCount, 0);
+		for (std::size_t i = 0; i < triangleCount * 3; ++i)
+			++remaining[indices[i]];
+
+		std::vector<std::uint32_t> offsets(vertexCount + 1, 0);
+		std::inclusive_scan(remaining.begin(), remaining.end(), offsets.begin() + 1);
+
+		std::vector<std::uint32_t> adjacency(triangleCount * 3);
+		{
+			std::vector<std::uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+			for (std::size_t i = 0; i < triangleCount * 3; ++i)
+				adjacency[cursors[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+		}
+
+		std::vector<std::int32_t> cachePositions(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (std::uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+			vertexScores[vertex] = ForsythVertexScore(-1, remaining[vertex]);
+
+		std::vector<std::uint32_t> source(indices, indices + triangleCount * 3);
+		std::vector<float> triangleScores(triangleCount);
+		for (std::size_t triangle = 0; triangle < triangleCount; ++triangle)
+			triangleScores[triangle] = vertexScores[source[triangle * 3]] + vertexScores[source[triangle * 3 + 1]] + vertexScores[source[triangle * 3 + 2]];
+		std::vector<bool> emitted(triangleCount, false);
+
+		// Holds three entries more than the cache, the vertices pushed out by the last triangle still need their scores updated
+		std::vector<std::uint32_t> cache;
+		std::vector<std::uint32_t> nextCache;
+		cache.reserve(s_LRUCacheSize + 3);
+		nextCache.reserve(s_LRUCacheSize + 3);
+
+		std::uint32_t best = static_cast<std::uint32_t>(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+		std::size_t cursor = 0;
+		for (std::size_t output = 0; output < triangleCount; ++output) {
+			// Nothing in the cache has triangles left, continue with the next triangle in input order, which is usually close by
+			if (best == ~0U) {
+				while (emitted[cursor])
+					++cursor;
+				best = static_cast<std::uint32_t>(cursor);
+			}
+
+			const std::uint32_t* triangle = &source[best * 3];
+			std::memcpy(indices + output * 3, triangle, sizeof(std::uint32_t) * 3);
+			emitted[best] = true;
+
+			for (std::size_t i = 0; i < 3; ++i) {
+				std::uint32_t vertex = triangle[i];
+				std::uint32_t begin  = offsets[vertex];
+				std::uint32_t end    = begin + remaining[vertex];
+				std::swap(*std::find(adjacency.begin() + begin, adjacency.begin() + end, best), adjacency[end - 1]);
+				--remaining[vertex];
+			}
+
+			// Degenerate triangles name a vertex twice, the cache holds it once
+			nextCache.clear();
+			for (std::size_t i = 0; i < 3; ++i)
+				if (std::find(nextCache.begin(), nextCache.end(), triangle[i]) == nextCache.end())
+					nextCache.push_back(triangle[i]);
+			for (auto vertex : cache)
+				if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+					nextCache.push_back(vertex);
+
+			for (std::size_t i = 0; i < nextCache.size(); ++i) {
+				std::uint32_t vertex   = nextCache[i];
+				cachePositions[vertex] = i < s_LRUCacheSize ? static_cast<std::int32_t>(i) : -1;
+				vertexScores[vertex]   = ForsythVertexScore(cachePositions[vertex], remaining[vertex]);
+			}
+
+			// Only triangles of cached vertices changed score, the next one is the best of those
+			best            = ~0U;
+			float bestScore = -1.0f;
+			for (auto vertex : nextCache) {
+				for (std::uint32_t i = offsets[vertex]; i < offsets[vertex] + remaining[vertex]; ++i) {
+					std::uint32_t candidate   = adjacency[i];
+					const std::uint32_t* c    = &source[candidate * 3];
+					triangleScores[candidate] = vertexScores[c[0]] + vertexScores[c[1]] + vertexScores[c[2]];
+					if (triangleScores[candidate] > bestScore) {
+						best      = candidate;
+						bestScore = triangleScores[candidate];
+					}
+				}
+			}
+
+			nextCache.resize(std::min<std::size_t>(nextCache.size(), s_LRUCacheSize));
+			std::swap(cache, nextCache);
+		}
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(std::uint32_t* indices, std::size_t indexCount, const float* positions, std::size_t positionStride, std::uint32_t vertexCount, float threshold) {
+		std::size_t triangleCount = indexCount / 3;
+		if (triangleCount < 2)
+			return;
+
+		auto position = [positions, positionStride](std::uint32_t vertex) { return reinterpret_cast<const float*>(reinterpret_cast<const std::uint8_t*>(positions) + vertex * positionStride); };
+
+		// Hard boundaries are triangles missing all three vertices, the cache starts over there whatever comes before
+		std::vector<std::size_t> hardBoundaries;
+		{
+			FIFOCache cache = { vertexCount, s_FIFOCacheSize };
+			for (std::size_t triangle = 0; triangle < triangleCount; ++triangle) {
+				std::uint32_t misses = cache.access(indices[triangle * 3]) + cache.access(indices[triangle * 3 + 1]) + cache.access(indices[triangle * 3 + 2]);
+				if (triangle == 0 || misses == 3)
+					hardBoundaries.push_back(triangle);
+			}
+			hardBoundaries.push_back(triangleCount);
+		}
+
+		// Soft boundaries split a cluster once the part before them, starting with a cold cache, is already within the threshold of the whole cluster
+		std::vector<std::size_t> boundaries;
+		for (std::size_t i = 0; i + 1 < hardBoundaries.size(); ++i) {
+			std::size_t begin = hardBoundaries[i];
+			std::size_t end   = hardBoundaries[i + 1];
+
+			FIFOCache cache             = { vertexCount, s_FIFOCacheSize };
+			std::uint32_t clusterMisses = 0;
+			for (std::size_t index = begin * 3; index < end * 3; ++index)
+				clusterMisses += cache.access(indices[index]);
+			float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+			cache.reset();
+			boundaries.push_back(begin);
+			std::size_t start    = begin;
+			std::uint32_t misses = 0;
+			for (std::size_t triangle = begin; triangle < end; ++triangle) {
+				misses += cache.access(indices[triangle * 3]) + cache.access(indices[triangle * 3 + 1]) + cache.access(indices[triangle * 3 + 2]);
+				if (triangle + 1 < end && static_cast<float>(misses) / static_cast<float>(triangle + 1 - start) <= clusterThreshold) {
+					boundaries.push_back(triangle + 1);
+					start  = triangle + 1;
+					misses = 0;
+					cache.reset();
+				}
+			}
+		}
+		boundaries.push_back(triangleCount);
+
+		// Area weighted centroid and normal of every cluster, and the centroid of the whole mesh
+		struct Cluster {
+		public:
+			std::size_t m_Begin;
+			std::size_t m_End;
+			float m_Centroid[3];
+			float m_Normal[3];
+			float m_Area;
+			float m_SortKey;
+		};
+
+		std::vector<Cluster> clusters;
+		clusters.reserve(boundaries.size() - 1);
+		float meshCentroid[3] = {};
+		float meshArea        = 0.0f;
+		for (std::size_t i = 0; i + 1 < boundaries.size(); ++i) {
+			Cluster cluster = { boundaries[i], boundaries[i + 1], {}, {}, 0.0f, 0.0f };
+			for (std::size_t triangle = cluster.m_Begin; triangle < cluster.m_End; ++triangle) {
+				const float* a = position(indices[triangle * 3]);
+				const float* b = position(indices[triangle * 3 + 1]);
+				const float* c = position(indices[triangle * 3 + 2]);
+
+				float ab[3], ac[3];
+				Subtract(b, a, ab);
+				Subtract(c, a, ac);
+				float normal[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+				float area      = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+				for (std::size_t j = 0; j < 3; ++j) {
+					cluster.m_Centroid[j] += (a[j] + b[j] + c[j]) * area;
+					cluster.m_Normal[j] += normal[j];
+				}
+				cluster.m_Area += area;
+			}
+
+			for (std::size_t j = 0; j < 3; ++j)
+				meshCentroid[j] += cluster.m_Centroid[j];
+			meshArea += cluster.m_Area;
+			if (cluster.m_Area > 0.0f)
+				for (std::size_t j = 0; j < 3; ++j)
+					cluster.m_Centroid[j] /= cluster.m_Area * 3.0f;
+			clusters.push_back(cluster);
+		}
+		if (meshArea > 0.0f)
+			for (std::size_t j = 0; j < 3; ++j)
+				meshCentroid[j] /= meshArea * 3.0f;
+
+		// Clusters facing away from the center are on the outside of the mesh and the most likely to occlude others, so they draw first
+		for (auto& cluster : clusters) {
+			float length = std::sqrt(cluster.m_Normal[0] * cluster.m_Normal[0] + cluster.m_Normal[1] * cluster.m_Normal[1] + cluster.m_Normal[2] * cluster.m_Normal[2]);
+			float offset[3];
+			Subtract(cluster.m_Centroid, meshCentroid, offset);
+			cluster.m_SortKey = length > 0.0f ? (offset[0] * cluster.m_Normal[0] + offset[1] * cluster.m_Normal[1] + offset[2] * cluster.m_Normal[2]) / length : 0.0f;
+		}
+		std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& lhs, const Cluster& rhs) { return lhs.m_SortKey > rhs.m_SortKey; });
+
+		std::vector<std::uint32_t> source(indices, indices + triangleCount * 3);
+		std::uint32_t* output = indices;
+		for (auto& cluster : clusters)
+			output = std::copy(source.begin() + cluster.m_Begin * 3, source.begin() + cluster.m_End * 3, output);
+	}
+
+	std::uint32_t MeshOptimizer::OptimizeVertexFetch(std::uint32_t* indices, std::size_t indexCount, std::uint32_t vertexCount, std::vector<std::uint32_t>& remap) {
+		remap.assign(vertexCount, ~0U);
+
+		std::uint32_t next = 0;
+		for (std::size_t i = 0; i < indexCount; ++i) {
+			std::uint32_t& vertex = remap[indices[i]];
+			if (vertex == ~0U)
+				vertex = next++;
+			indices[i] = vertex;
+		}
+		return next;
+	}
+} // namespace Utils
@@ -0,0 +1,294 @@
+#include "Utils/MeshSimplifier.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace Utils {
+	namespace {
+		// Sum of squared distances to a set of weighted planes, 'x A x + 2 b x + c'
+		struct Quadric {
+		public:
+			double m_A00    = 0.0, m_A11 = 0.0, m_A22 = 0.0, m_A01 = 0.0, m_A02 = 0.0, m_A12 = 0.0;
+			double m_B0     = 0.0, m_B1 = 0.0, m_B2 = 0.0;
+			double m_C      = 0.0;
+			double m_Weight = 0.0;
+		};
+
+		enum class VertexKind : std::uint8_t {
+			Manifold,
+			Border,
+			Locked
+		};
+
+		using Vec3 = std::array<double, 3>;
+
+		Vec3 Subtract(const Vec3& lhs, const Vec3& rhs) {
+			return { lhs[0] - rhs[0], lhs[1] - rhs[1], lhs[2] - rhs[2] };
+		}
+
+		Vec3 Cross(const Vec3& lhs, const Vec3& rhs) {
+			return { lhs[1] * rhs[2] - lhs[2] * rhs[1], lhs[2] * rhs[0] - lhs[0] * rhs[2], lhs[0] * rhs[1] - lhs[1] * rhs[0] };
+		}
+
+		double Dot(const Vec3& lhs, const Vec3& rhs) {
+			return lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2];
+		}
+
+		// The plane through 'point' with unit 'normal', weighted by 'weight'
+		Quadric PlaneQuadric(const Vec3& normal, const Vec3& point, double weight) {
+			double d = -Dot(normal, point);
+
+			Quadric quadric;
+			quadric.m_A00    = weight * normal[0] * normal[0];
+			quadric.m_A11    = weight * normal[1] * normal[1];
+			quadric.m_A22    = weight * normal[2] * normal[2];
+			quadric.m_A01    = weight * normal[0] * normal[1];
+			quadric.m_A02    = weight * normal[0] * normal[2];
+			quadric.m_A12    = weight * normal[1] * normal[2];
+			quadric.m_B0     = weight * normal[0] * d;
+			quadric.m_B1     = weight * normal[1] * d;
+			quadric.m_B2     = weight * normal[2] * d;
+			quadric.m_C      = weight * d * d;
+			quadric.m_Weight = weight;
+			return quadric;
+		}
+
+		void Add(Quadric& quadric, const Quadric& other) {
+			quadric.m_A00 += other.m_A00;
+			quadric.m_A11 += other.m_A11;
+			quadric.m_A22 += other.m_A22;
+			quadric.m_A01 += other.m_A01;
+			quadric.m_A02 += other.m_A02;
+			quadric.m_A12 += other.m_A12;
+			quadric.m_B0 += other.m_B0;
+			quadric.m_B1 += other.m_B1;
+			quadric.m_B2 += other.m_B2;
+			quadric.m_C += other.m_C;
+			quadric.m_Weight += other.m_Weight;
+		}
+
+		// Weighted mean of the squared distances from 'point' to the planes of both quadrics
+		double Evaluate(const Quadric& lhs, const Quadric& rhs, const Vec3& point) {
+			Quadric quadric = lhs;
+			Add(quadric, rhs);
+
+			double x      = point[0], y = point[1], z = point[2];
+			double result = quadric.m_A00 * x * x + quadric.m_A11 * y * y + quadric.m_A22 * z * z + 2.0 * (quadric.m_A01 * x * y + quadric.m_A02 * x * z + quadric.m_A12 * y * z) + 2.0 * (quadric.m_B0 * x + quadric.m_B1 * y + quadric.m_B2 * z) + quadric.m_C;
+			return quadric.m_Weight > 0.0 ? std::max(result, 0.0) / quadric.m_Weight : 0.0;
+		}
+
+		std::uint64_t EdgeKey(std::uint32_t a, std::uint32_t b) {
+			return a < b ? (static_cast<std::uint64_t>(a) << 32) | b : (static_cast<std::uint64_t>(b) << 32) | a;
+		}
+
+		struct Collapse {
+		public:
+			std::uint32_t m_From;
+			std::uint32_t m_To;
+			double m_Cost;
+		};
+	} // namespace
+
+	std::size_t MeshSimplifier::Simplify(std::uint32_t* destination, const std::uint32_t* indices, std::size_t indexCount, const float* positions, std::size_t positionStride, std::uint32_t vertexCount, std::size_t targetIndexCount, float& error) {
+		error = 0.0f;
+
+		std::vector<Vec3> points(vertexCount);
+		for (std::uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+			auto position  = reinterpret_cast<const float*>(reinterpret_cast<const std::uint8_t*>(positions) + vertex * positionStride);
+			points[vertex] = { position[0], position[1], position[2] };
+		}
+
+		// Drop triangles that are degenerate from the start, they would only get in the way of the edge counts
+		std::vector<std::uint32_t> result;
+		result.reserve(indexCount);
+		for (std::size_t i = 0; i + 2 < indexCount; i += 3)
+			if (indices[i] != indices[i + 1] && indices[i] != indices[i + 2] && indices[i + 1] != indices[i + 2])
+				result.insert(result.end(), indices + i, indices + i + 3);
+
+		// Vertices sharing a position belong to a seam, and vertices on edges used by more than two triangles aren't on a surface, neither may move
+		std::vector<VertexKind> kinds(vertexCount, VertexKind::Manifold);
+		{
+			std::unordered_map<std::uint64_t, std::uint32_t> firstAtPosition;
+			for (std::uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+				auto position     = reinterpret_cast<const std::uint8_t*>(positions) + vertex * positionStride;
+				std::uint64_t key = 14695981039346656037ULL;
+				for (std::size_t i = 0; i < sizeof(float) * 3; ++i) {
+					key ^= position[i];
+					key *= 1099511628211ULL;
+				}
+
+				auto [itr, inserted] = firstAtPosition.try_emplace(key, vertex);
+				if (!inserted && points[itr->second] == points[vertex]) {
+					kinds[vertex]      = VertexKind::Locked;
+					kinds[itr->second] = VertexKind::Locked;
+				}
+			}
+		}
+
+		std::unordered_map<std::uint64_t, std::uint32_t> edgeCounts;
+		auto countEdges = [&]() {
+			edgeCounts.clear();
+			for (std::size_t i = 0; i < result.size(); i += 3)
+				for (std::size_t j = 0; j < 3; ++j)
+					++edgeCounts[EdgeKey(result[i + j], result[i + (j + 1) % 3])];
+		};
+		countEdges();
+		for (auto [key, count] : edgeCounts) {
+			auto a = static_cast<std::uint32_t>(key >> 32);
+			auto b = static_cast<std::uint32_t>(key);
+			for (auto vertex : { a, b }) {
+				if (count > 2)
+					kinds[vertex] = VertexKind::Locked;
+				else if (count == 1 && kinds[vertex] == VertexKind::Manifold)
+					kinds[vertex] = VertexKind::Border;
+			}
+		}
+
+		// Every vertex starts with the planes of its triangles weighted by area, border edges add a plane perpendicular to their triangle
+		std::vector<Quadric> quadrics(vertexCount);
+		for (std::size_t i = 0; i < result.size(); i += 3) {
+			const Vec3& a = points[result[i]];
+			Vec3 normal   = Cross(Subtract(points[result[i + 1]], a), Subtract(points[result[i + 2]], a));
+			double area   = std::sqrt(Dot(normal, normal));
+			if (area == 0.0)
+				continue;
+
+			Vec3 unit       = { normal[0] / area, normal[1] / area, normal[2] / area };
+			Quadric quadric = PlaneQuadric(unit, a, area * 0.5);
+			for (std::size_t j = 0; j < 3; ++j)
+				Add(quadrics[result[i + j]], quadric);
+
+			for (std::size_t j = 0; j < 3; ++j) {
+				std::uint32_t from = result[i + j];
+				std::uint32_t to   = result[i + (j + 1) % 3];
+				if (edgeCounts[EdgeKey(from, to)] != 1)
+					continue;
+
+				Vec3 edge         = Subtract(points[to], points[from]);
+				Vec3 borderNormal = Cross(edge, unit);
+				double length     = std::sqrt(Dot(borderNormal, borderNormal));
+				if (length == 0.0)
+					continue;
+				borderNormal          = { borderNormal[0] / length, borderNormal[1] / length, borderNormal[2] / length };
+				Quadric borderQuadric = PlaneQuadric(borderNormal, points[from], Dot(edge, edge) * s_BorderWeight);
+				Add(quadrics[from], borderQuadric);
+				Add(quadrics[to], borderQuadric);
+			}
+		}
+
+		// Every pass collapses the cheapest edges whose neighbourhoods don't overlap, then rebuilds the triangles
+		std::vector<std::uint32_t> offsets(vertexCount + 1);
+		std::vector<std::uint32_t> adjacency;
+		std::vector<Collapse> collapses;
+		std::vector<std::uint32_t> remap(vertexCount);
+		std::vector<bool> touched(vertexCount);
+		double maxCost = 0.0;
+		while (result.size() > targetIndexCount) {
+			std::fill(offsets.begin(), offsets.end(), 0);
+			for (auto vertex : result)
+				++offsets[vertex + 1];
+			std::inclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+			adjacency.resize(result.size());
+			{
+				std::vector<std::uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+				for (std::size_t i = 0; i < result.size(); ++i)
+					adjacency[cursors[result[i]]++] = static_cast<std::uint32_t>(i / 3);
+			}
+
+			// The cheapest allowed collapse of every vertex
+			collapses.clear();
+			for (std::uint32_t from = 0; from < vertexCount; ++from) {
+				if (kinds[from] == VertexKind::Locked || offsets[from] == offsets[from + 1])
+					continue;
+
+				Collapse best = { from, ~0U, 0.0 };
+				for (std::uint32_t i = offsets[from]; i < offsets[from + 1]; ++i) {
+					const std::uint32_t* triangle = &result[adjacency[i] * 3];
+					for (std::size_t j = 0; j < 3; ++j) {
+						std::uint32_t to = triangle[j];
+						if (to == from || (kinds[from] == VertexKind::Border && edgeCounts[EdgeKey(from, to)] != 1))
+							continue;
+
+						double cost = Evaluate(quadrics[from], quadrics[to], points[to]);
+						if (best.m_To == ~0U || cost < best.m_Cost) {
+							best.m_To   = to;
+							best.m_Cost = cost;
+						}
+					}
+				}
+				if (best.m_To != ~0U)
+					collapses.push_back(best);
+			}
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) { return lhs.m_Cost < rhs.m_Cost; });
+
+			std::iota(remap.begin(), remap.end(), 0U);
+			std::fill(touched.begin(), touched.end(), false);
+			std::size_t triangleCount = result.size() / 3;
+			std::size_t applied       = 0;
+			for (auto& collapse : collapses) {
+				if (triangleCount * 3 <= targetIndexCount)
+					break;
+				if (touched[collapse.m_From] || touched[collapse.m_To])
+					continue;
+
+				// Reject collapses that would flip one of the remaining triangles around the vertex
+				bool flips            = false;
+				std::size_t collapsed = 0;
+				for (std::uint32_t i = offsets[collapse.m_From]; i < offsets[collapse.m_From + 1] && !flips; ++i) {
+					const std::uint32_t* triangle = &result[adjacency[i] * 3];
+					if (triangle[0] == collapse.m_To || triangle[1] == collapse.m_To || triangle[2] == collapse.m_To) {
+						++collapsed;
+						continue;
+					}
+
+					Vec3 corners[3];
+					for (std::size_t j = 0; j < 3; ++j)
+						corners[j] = points[triangle[j]];
+					Vec3 before = Cross(Subtract(corners[1], corners[0]), Subtract(corners[2], corners[0]));
+					for (std::size_t j = 0; j < 3; ++j)
+						if (triangle[j] == collapse.m_From)
+							corners[j] = points[collapse.m_To];
+					Vec3 after = Cross(Subtract(corners[1], corners[0]), Subtract(corners[2], corners[0]));
+					flips      = Dot(before, after) <= 0.0;
+				}
+				if (flips)
+					continue;
+
+				remap[collapse.m_From] = collapse.m_To;
+				Add(quadrics[collapse.m_To], quadrics[collapse.m_From]);
+				for (std::uint32_t i = offsets[collapse.m_From]; i < offsets[collapse.m_From + 1]; ++i)
+					for (std::size_t j = 0; j < 3; ++j)
+						touched[result[adjacency[i] * 3 + j]] = true;
+
+				triangleCount -= collapsed;
+				maxCost = std::max(maxCost, collapse.m_Cost);
+				++applied;
+			}
+			if (applied == 0)
+				break;
+
+			std::size_t write = 0;
+			for (std::size_t i = 0; i < result.size(); i += 3) {
+				std::uint32_t a = remap[result[i]];
+				std::uint32_t b = remap[result[i + 1]];
+				std::uint32_t c = remap[result[i + 2]];
+				if (a == b || a == c || b == c)
+					continue;
+				result[write++] = a;
+				result[write++] = b;
+				result[write++] = c;
+			}
+			result.resize(write);
+			countEdges();
+		}
+
+		std::memcpy(destination, result.data(), sizeof(std::uint32_t) * result.size());
+		error = static_cast<float>(std::sqrt(maxCost));
+		return result.size();
+	}
+} // namespace Utils
@@ -0,0 +1,27 @@
+#include "Utils/StringInterner.h"
+
+namespace Utils {
+	StringInterner& StringInterner::Get() {
+		static StringInterner s_Interner;
+		return s_Interner;
+	}
+
+	const char* StringInterner::intern(std::string_view string) {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		auto itr = m_Lookup.find(string);
+		if (itr != m_Lookup.end())
+			return itr->second;
+
+		auto& stored = m_Strings.emplace_back(string);
+		m_Lookup.emplace(stored, stored.c_str());
+		return stored.c_str();
+	}
+
+	const char* StringInterner::find(std::string_view string) const {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		auto itr = m_Lookup.find(string);
+		return itr != m_Lookup.end() ? itr->second : nullptr;
+	}
+} // namespace Utils
@@ -0,0 +1,108 @@
+#include "Utils/ThreadPool.h"
+#include "Utils/CPUProfiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace Utils {
+	std::size_t ThreadPool::GetHardwareThreadCount() {
+		return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+	}
+
+	ThreadPool::ThreadPool(std::size_t workerCount, std::string name)
+	    : m_Name(std::move(name)) {
+		m_Workers.reserve(workerCount);
+		for (std::size_t i = 0; i < workerCount; ++i)
+			m_Workers.emplace_back(&ThreadPool::workerMain, this, i);
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stop = true;
+		}
+		m_Condition.notify_all();
+		for (auto& worker : m_Workers)
+			worker.join();
+	}
+
+	void ThreadPool::submit(std::function<void()> job) {
+		if (m_Workers.empty()) {
+			job();
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Jobs.push_back(std::move(job));
+		}
+		m_Condition.notify_one();
+	}
+
+	void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& job) {
+		if (count == 0)
+			return;
+
+		// Helper jobs can start after this function returned, so everything they touch is kept alive through a shared pointer.
+		// A late helper only ever sees 'm_Next >= m_Count' and leaves without touching 'm_Job'.
+		struct State {
+		public:
+			std::atomic<std::size_t> m_Next     = 0;
+			std::atomic<std::size_t> m_Finished = 0;
+			std::size_t m_Count                 = 0;
+			const std::function<void(std::size_t)>* m_Job;
+			std::mutex m_Mutex;
+			std::condition_variable m_Condition;
+		};
+
+		auto state     = std::make_shared<State>();
+		state->m_Count = count;
+		state->m_Job   = &job;
+
+		auto run = [state]() {
+			std::size_t index;
+			while ((index = state->m_Next.fetch_add(1)) < state->m_Count) {
+				(*state->m_Job)(index);
+				if (state->m_Finished.fetch_add(1) + 1 == state->m_Count) {
+					std::lock_guard<std::mutex> lock(state->m_Mutex);
+					state->m_Condition.notify_all();
+				}
+			}
+		};
+
+		std::size_t helperCount = std::min(m_Workers.size(), count - 1);
+		if (helperCount > 0) {
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				for (std::size_t i = 0; i < helperCount; ++i)
+					m_Jobs.push_back(run);
+			}
+			m_Condition.notify_all();
+		}
+
+		run();
+
+		std::unique_lock<std::mutex> lock(state->m_Mutex);
+		state->m_Condition.wait(lock, [&state]() { return state->m_Finished.load() == state->m_Count; });
+	}
+
+	void ThreadPool::workerMain(std::size_t index) {
+		PROFILE_THREAD(m_Name + " " + std::to_string(index));
+
+		while (true) {
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Condition.wait(lock, [this]() { return m_Stop || !m_Jobs.empty(); });
+				if (m_Stop && m_Jobs.empty())
+					return;
+
+				job = std::move(m_Jobs.front());
+				m_Jobs.pop_front();
+			}
+			job();
+		}
+	}
+} // namespace Utils
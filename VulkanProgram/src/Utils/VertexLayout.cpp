@@ -0,0 +1,163 @@
+#include "Utils/VertexLayout.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace Utils {
+	namespace {
+		// Encodings each semantic may use, anything else is rejected when unpacking
+		bool IsAllowed(VertexSemantic semantic, VertexEncoding encoding) {
+			switch (semantic) {
+			case VertexSemantic::Position: return encoding == VertexEncoding::Float32x4 || encoding == VertexEncoding::Unorm16x4;
+			case VertexSemantic::UV: return encoding == VertexEncoding::None || encoding == VertexEncoding::Float32x2 || encoding == VertexEncoding::Float16x2;
+			default: return false;
+			}
+		}
+
+		// Round to nearest even, out of range values become infinity and denormals are kept
+		std::uint16_t FloatToHalf(float value) {
+			std::uint32_t bits     = std::bit_cast<std::uint32_t>(value);
+			std::uint32_t sign     = (bits >> 16) & 0x8000;
+			std::uint32_t exponent = (bits >> 23) & 0xFF;
+			std::uint32_t mantissa = bits & 0x7FFFFF;
+
+			if (exponent == 0xFF)
+				return static_cast<std::uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+
+			std::int32_t halfExponent = static_cast<std::int32_t>(exponent) - 127 + 15;
+			if (halfExponent >= 31)
+				return static_cast<std::uint16_t>(sign | 0x7C00);
+			if (halfExponent <= 0) {
+				if (halfExponent < -10)
+					return static_cast<std::uint16_t>(sign);
+				mantissa |= 0x800000;
+				std::uint32_t shift   = static_cast<std::uint32_t>(14 - halfExponent);
+				std::uint32_t half    = mantissa >> shift;
+				std::uint32_t rest    = mantissa & ((1U << shift) - 1);
+				std::uint32_t halfway = 1U << (shift - 1);
+				if (rest > halfway || (rest == halfway && (half & 1)))
+					++half;
+				return static_cast<std::uint16_t>(sign | half);
+			}
+
+			std::uint32_t half = (static_cast<std::uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+			std::uint32_t rest = mantissa & 0x1FFF;
+			if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+				++half; // Carries into the exponent, up to infinity, which is what rounding asks for
+			return static_cast<std::uint16_t>(sign | half);
+		}
+
+		std::uint16_t ToUnorm16(float value) {
+			return static_cast<std::uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+		}
+	} // namespace
+
+	VertexQuantization VertexQuantization::FromBounds(const float min[3], const float max[3]) {
+		VertexQuantization quantization;
+		for (std::size_t i = 0; i < 3; ++i) {
+			quantization.m_Offset[i] = min[i];
+			quantization.m_Scale[i]  = max[i] > min[i] ? max[i] - min[i] : 1.0f; // A flat axis keeps an invertible matrix, every position on it encodes to 0
+		}
+		return quantization;
+	}
+
+	VertexLayout VertexLayout::Standard() {
+		VertexLayout layout;
+		layout.m_Encodings[static_cast<std::uint32_t>(VertexSemantic::Position)] = VertexEncoding::Float32x4;
+		layout.m_Encodings[static_cast<std::uint32_t>(VertexSemantic::UV)]       = VertexEncoding::Float32x2;
+		return layout;
+	}
+
+	VertexLayout VertexLayout::Quantized() {
+		VertexLayout layout;
+		layout.m_Encodings[static_cast<std::uint32_t>(VertexSemantic::Position)] = VertexEncoding::Unorm16x4;
+		layout.m_Encodings[static_cast<std::uint32_t>(VertexSemantic::UV)]       = VertexEncoding::Float16x2;
+		return layout;
+	}
+
+	VertexLayout VertexLayout::Unpack(std::uint32_t packed) {
+		VertexLayout layout;
+		for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(VertexSemantic::Count); ++i)
+			layout.m_Encodings[i] = static_cast<VertexEncoding>((packed >> (i * 8)) & 0xFF);
+		return layout.isValid() && layout.pack() == packed ? layout : VertexLayout {};
+	}
+
+	std::uint32_t VertexLayout::GetEncodingSize(VertexEncoding encoding) {
+		switch (encoding) {
+		case VertexEncoding::Float32x2: return 8;
+		case VertexEncoding::Float32x3: return 12;
+		case VertexEncoding::Float32x4: return 16;
+		case VertexEncoding::Float16x2: return 4;
+		case VertexEncoding::Unorm16x4: return 8;
+		default: return 0;
+		}
+	}
+
+	std::uint32_t VertexLayout::pack() const {
+		std::uint32_t packed = 0;
+		for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(VertexSemantic::Count); ++i)
+			packed |= static_cast<std::uint32_t>(m_Encodings[i]) << (i * 8);
+		return packed;
+	}
+
+	void VertexLayout::encode(const VertexAttributes& attributes, const VertexQuantization& quantization, void* destination) const {
+		auto bytes = static_cast<std::uint8_t*>(destination);
+		for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(VertexSemantic::Count); ++i) {
+			auto semantic = static_cast<VertexSemantic>(i);
+			auto output   = bytes + getOffset(semantic);
+
+			const float* input = nullptr;
+			float normalized[4];
+			switch (semantic) {
+			case VertexSemantic::Position:
+				input = attributes.m_Position;
+				for (std::size_t j = 0; j < 3; ++j)
+					normalized[j] = quantization.m_Scale[j] != 0.0f ? (attributes.m_Position[j] - quantization.m_Offset[j]) / quantization.m_Scale[j] : 0.0f;
+				break;
+			case VertexSemantic::UV: input = attributes.m_UV; break;
+			default: break;
+			}
+
+			switch (m_Encodings[i]) {
+			case VertexEncoding::Float32x2:
+			case VertexEncoding::Float32x3: std::memcpy(output, input, GetEncodingSize(m_Encodings[i])); break;
+			case VertexEncoding::Float32x4: {
+				float value[4] = { input[0], input[1], input[2], 1.0f };
+				std::memcpy(output, value, sizeof(value));
+				break;
+			}
+			case VertexEncoding::Float16x2: {
+				std::uint16_t value[2] = { FloatToHalf(input[0]), FloatToHalf(input[1]) };
+				std::memcpy(output, value, sizeof(value));
+				break;
+			}
+			case VertexEncoding::Unorm16x4: {
+				std::uint16_t value[4] = { ToUnorm16(normalized[0]), ToUnorm16(normalized[1]), ToUnorm16(normalized[2]), 0xFFFF };
+				std::memcpy(output, value, sizeof(value));
+				break;
+			}
+			default: break;
+			}
+		}
+	}
+
+	std::uint32_t VertexLayout::getOffset(VertexSemantic semantic) const {
+		std::uint32_t offset = 0;
+		for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(semantic); ++i)
+			offset += GetEncodingSize(m_Encodings[i]);
+		return offset;
+	}
+
+	std::uint32_t VertexLayout::getStride() const {
+		return getOffset(VertexSemantic::Count);
+	}
+
+	bool VertexLayout::isValid() const {
+		for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(VertexSemantic::Count); ++i)
+			if (!IsAllowed(static_cast<VertexSemantic>(i), m_Encodings[i]))
+				return false;
+		return true;
+	}
+} // namespace Utils
@@ -22,6 +22,13 @@ if not vulkanSDKPath then
 	end
 end
 
+local glslcPath = vulkanSDKPath .. "/bin/glslc"
+if os.host() == "windows" then
+	glslcPath = vulkanSDKPath .. "/Bin/glslc.exe"
+elseif os.host() == "macosx" then
+	glslcPath = vulkanSDKPath .. "/macos/bin/glslc"
+end
+
 workspace(workspaceName)
 	configurations({ "Debug", "Release", "Dist" })
 	platforms({ "x64" })
@@ -42,7 +49,7 @@ workspace(workspaceName)
 		symbols("On")
 
 	filter("configurations:Dist")
-		defines({ "_RELEASE" })
+		defines({ "_RELEASE", "_DIST" })
 		optimize("Full")
 		symbols("Off")
 
@@ -184,7 +191,8 @@ end
 		includedirs({ "%{prj.location}/include/" })
 
 		files({
-			"%{prj.location}/stb_image.h"
+			"%{prj.location}/stb_image.h",
+			"%{prj.location}/stb_image_write.h"
 		})
 
 	group("Program")
@@ -238,4 +246,38 @@ end
 		})
 
 		files({ "%{prj.location}/**" })
-		removefiles({ "*.vcxproj", "*.vcxproj.*", "*.Make", "*.mak", "*.xcodeproj/", "*.DS_Store" })
\ No newline at end of file
+		removefiles({ "*.vcxproj", "*.vcxproj.*", "*.Make", "*.mak", "*.xcodeproj/", "*.DS_Store" })
+
+		-- Compile GLSL shaders to SPIR-V, 'shaders/shader.vert' becomes 'shaders/shader.vert.spv'
+		filter("files:**.vert or files:**.frag or files:**.comp")
+			buildmessage("Compiling shader %{file.relpath}")
+			buildcommands({ '"' .. glslcPath .. '" -o "%{file.abspath}.spv" "%{file.abspath}"' })
+			buildoutputs({ "%{file.abspath}.spv" })
+
+		filter({})
+
+	group("Tools")
+	project("MeshCooker")
+		location("MeshCooker")
+		kind("ConsoleApp")
+		targetdir("%{wks.location}/Bin/%{cfg.system}-%{cfg.platform}-%{cfg.buildcfg}/")
+		objdir("%{wks.location}/Int/%{cfg.system}-%{cfg.platform}-%{cfg.buildcfg}/%{prj.name}/")
+		debugdir("%{wks.location}/" .. programName .. "/")
+
+		-- Shares the mesh file format and vertex layouts with the program, none of these files need Vulkan
+		includedirs({ "%{wks.location}/" .. programName .. "/inc" })
+
+		files({
+			"%{prj.location}/src/**",
+			"%{wks.location}/" .. programName .. "/inc/Utils/MappedFile.h",
+			"%{wks.location}/" .. programName .. "/inc/Utils/Math.h",
+			"%{wks.location}/" .. programName .. "/inc/Utils/MeshFile.h",
+			"%{wks.location}/" .. programName .. "/inc/Utils/MeshOptimizer.h",
+			"%{wks.location}/" .. programName .. "/inc/Utils/MeshSimplifier.h",
+			"%{wks.location}/" .. programName .. "/inc/Utils/VertexLayout.h",
+			"%{wks.location}/" .. programName .. "/src/Utils/MappedFile.cpp",
+			"%{wks.location}/" .. programName .. "/src/Utils/MeshFile.cpp",
+			"%{wks.location}/" .. programName .. "/src/Utils/MeshOptimizer.cpp",
+			"%{wks.location}/" .. programName .. "/src/Utils/MeshSimplifier.cpp",
+			"%{wks.location}/" .. programName .. "/src/Utils/VertexLayout.cpp"
+		})
\ No newline at end of file